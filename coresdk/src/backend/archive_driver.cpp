@@ -0,0 +1,271 @@
+//
+//  archive_driver.cpp
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#include "archive_driver.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+#ifdef WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//
+// The archive is laid out as:
+//
+//   header:    magic, version, number of entries, size of the names
+//   index:     one entry for each file, sorted by the hash of its name
+//   names:     the names of the files, one after another
+//   data:      the contents of each file, starting on a 16 byte boundary
+//
+// All values are little endian, as written by the machine packing the archive.
+//
+
+#define ARCHIVE_MAGIC 0x4b504b53  // 'SKPK' when read in the order it was written
+#define ARCHIVE_VERSION 1
+#define ARCHIVE_ALIGNMENT 16
+
+namespace splashkit_lib
+{
+    struct _archive_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entry_count;
+        uint32_t names_size;
+    };
+
+    struct _archive_index_entry
+    {
+        uint64_t hash;
+        uint64_t offset;        // from the start of the archive
+        uint64_t size;
+        uint32_t name_offset;   // from the start of the names
+        uint32_t name_length;
+    };
+
+    struct sk_archive_data
+    {
+        const char *                data;
+        size_t                      size;
+        const _archive_index_entry *index;
+        const char *                names;
+        uint32_t                    names_size;
+        uint32_t                    entry_count;
+
+#ifdef WINDOWS
+        HANDLE                      file;
+        HANDLE                      mapping;
+#endif
+    };
+
+    // FNV-1a hash of the entry name
+    static uint64_t _archive_hash(const char *name, size_t length)
+    {
+        uint64_t result = 14695981039346656037ULL;
+
+        for (size_t i = 0; i < length; i++)
+        {
+            result ^= static_cast<unsigned char>(name[i]);
+            result *= 1099511628211ULL;
+        }
+
+        return result;
+    }
+
+    bool sk_is_archive(const string &path)
+    {
+        uint32_t magic = 0;
+        ifstream input(path, ios::binary);
+
+        return input.read(reinterpret_cast<char *>(&magic), sizeof(magic)) and magic == ARCHIVE_MAGIC;
+    }
+
+    static void _unmap_archive(sk_archive archive)
+    {
+#ifdef WINDOWS
+        if ( archive->data ) UnmapViewOfFile(archive->data);
+        if ( archive->mapping ) CloseHandle(archive->mapping);
+        if ( archive->file != INVALID_HANDLE_VALUE ) CloseHandle(archive->file);
+#else
+        if ( archive->data ) munmap(const_cast<char *>(archive->data), archive->size);
+#endif
+        archive->data = nullptr;
+    }
+
+    static bool _map_archive(sk_archive archive, const string &path)
+    {
+#ifdef WINDOWS
+        LARGE_INTEGER file_size;
+
+        archive->file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        archive->mapping = nullptr;
+        if ( archive->file == INVALID_HANDLE_VALUE or not GetFileSizeEx(archive->file, &file_size) or file_size.QuadPart == 0 ) return false;
+
+        archive->mapping = CreateFileMappingA(archive->file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if ( not archive->mapping ) return false;
+
+        archive->data = static_cast<const char *>(MapViewOfFile(archive->mapping, FILE_MAP_READ, 0, 0, 0));
+        archive->size = static_cast<size_t>(file_size.QuadPart);
+        return archive->data != nullptr;
+#else
+        struct stat buffer;
+
+        int fd = open(path.c_str(), O_RDONLY);
+        if ( fd < 0 ) return false;
+
+        if ( fstat(fd, &buffer) != 0 or buffer.st_size == 0 )
+        {
+            close(fd);
+            return false;
+        }
+
+        void *mapped = mmap(nullptr, static_cast<size_t>(buffer.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        // The mapping keeps the file open, so the descriptor is not needed
+        close(fd);
+
+        if ( mapped == MAP_FAILED ) return false;
+
+        archive->data = static_cast<const char *>(mapped);
+        archive->size = static_cast<size_t>(buffer.st_size);
+        return true;
+#endif
+    }
+
+    sk_archive sk_open_archive(const string &path)
+    {
+        sk_archive result = new sk_archive_data();
+        result->data = nullptr;
+        result->size = 0;
+
+        if ( not _map_archive(result, path) or result->size < sizeof(_archive_header) )
+        {
+            sk_close_archive(result);
+            return nullptr;
+        }
+
+        _archive_header header;
+        memcpy(&header, result->data, sizeof(header));
+
+        size_t index_size = static_cast<size_t>(header.entry_count) * sizeof(_archive_index_entry);
+
+        if ( header.magic != ARCHIVE_MAGIC or header.version != ARCHIVE_VERSION or
+             result->size - sizeof(header) < index_size or
+             result->size - sizeof(header) - index_size < header.names_size )
+        {
+            sk_close_archive(result);
+            return nullptr;
+        }
+
+        result->entry_count = header.entry_count;
+        result->index = reinterpret_cast<const _archive_index_entry *>(result->data + sizeof(header));
+        result->names = result->data + sizeof(header) + index_size;
+        result->names_size = header.names_size;
+
+        return result;
+    }
+
+    void sk_close_archive(sk_archive archive)
+    {
+        if ( not archive ) return;
+
+        _unmap_archive(archive);
+        delete archive;
+    }
+
+    bool sk_archive_entry(sk_archive archive, const string &name, const char *&data, size_t &size)
+    {
+        if ( not archive ) return false;
+
+        uint64_t hash = _archive_hash(name.data(), name.length());
+        const _archive_index_entry *end = archive->index + archive->entry_count;
+        const _archive_index_entry *entry = lower_bound(archive->index, end, hash, [] (const _archive_index_entry &e, uint64_t h) { return e.hash < h; });
+
+        // Names that share a hash sit next to each other in the index
+        for ( ; entry != end and entry->hash == hash; entry++ )
+        {
+            if ( entry->name_length != name.length() or static_cast<uint64_t>(entry->name_offset) + entry->name_length > archive->names_size ) continue;
+            if ( memcmp(archive->names + entry->name_offset, name.data(), name.length()) != 0 ) continue;
+
+            // Reject entries that run past the end of a damaged archive
+            if ( entry->offset > archive->size or entry->size > archive->size - entry->offset ) return false;
+
+            data = archive->data + entry->offset;
+            size = static_cast<size_t>(entry->size);
+            return true;
+        }
+
+        return false;
+    }
+
+    bool sk_write_archive(const string &path, const vector<string> &names, const vector<string> &files)
+    {
+        if ( names.size() != files.size() ) return false;
+
+        _archive_header header;
+        vector<_archive_index_entry> index(names.size());
+        string all_names;
+
+        header.magic = ARCHIVE_MAGIC;
+        header.version = ARCHIVE_VERSION;
+        header.entry_count = static_cast<uint32_t>(names.size());
+
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            ifstream input(files[i], ios::binary | ios::ate);
+            if ( not input ) return false;
+
+            index[i].hash = _archive_hash(names[i].data(), names[i].length());
+            index[i].size = static_cast<uint64_t>(input.tellg());
+            index[i].name_offset = static_cast<uint32_t>(all_names.length());
+            index[i].name_length = static_cast<uint32_t>(names[i].length());
+            all_names += names[i];
+        }
+
+        header.names_size = static_cast<uint32_t>(all_names.length());
+
+        // Place the data after the index and names, in the order the files were given
+        uint64_t offset = sizeof(header) + index.size() * sizeof(_archive_index_entry) + all_names.length();
+        for (_archive_index_entry &entry : index)
+        {
+            offset = (offset + ARCHIVE_ALIGNMENT - 1) / ARCHIVE_ALIGNMENT * ARCHIVE_ALIGNMENT;
+            entry.offset = offset;
+            offset += entry.size;
+        }
+
+        vector<_archive_index_entry> sorted_index = index;
+        stable_sort(sorted_index.begin(), sorted_index.end(), [] (const _archive_index_entry &a, const _archive_index_entry &b) { return a.hash < b.hash; });
+
+        ofstream out(path, ios::binary | ios::trunc);
+        if ( not out ) return false;
+
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(sorted_index.data()), static_cast<streamsize>(sorted_index.size() * sizeof(_archive_index_entry)));
+        out.write(all_names.data(), static_cast<streamsize>(all_names.length()));
+
+        uint64_t written = sizeof(header) + sorted_index.size() * sizeof(_archive_index_entry) + all_names.length();
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            // Pad up to the entry's offset
+            for ( ; written < index[i].offset; written++ ) out.put(0);
+
+            ifstream input(files[i], ios::binary);
+            if ( index[i].size > 0 ) out << input.rdbuf();
+            written += index[i].size;
+        }
+
+        return static_cast<bool>(out);
+    }
+}
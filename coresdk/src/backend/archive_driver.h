@@ -0,0 +1,41 @@
+//
+//  archive_driver.h
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#ifndef archive_driver_h
+#define archive_driver_h
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+namespace splashkit_lib
+{
+    // A packed resource archive holds many files one after another in a single
+    // file, with an index of their names sorted by hash. The archive is memory
+    // mapped, so opening it is one open call and entries are read in place.
+    typedef struct sk_archive_data *sk_archive;
+
+    // Returns true if the file at path starts with the archive magic number.
+    bool sk_is_archive(const string &path);
+
+    // Map the archive into memory, returning nullptr if it cannot be opened
+    // or is not a valid archive.
+    sk_archive sk_open_archive(const string &path);
+
+    void sk_close_archive(sk_archive archive);
+
+    // Find the named entry in the archive. On success data points into the
+    // mapped file, and remains valid until the archive is closed.
+    bool sk_archive_entry(sk_archive archive, const string &name, const char *&data, size_t &size);
+
+    // Write an archive containing each of the files, stored under the
+    // matching name. Returns false if a file cannot be read or the archive
+    // cannot be written.
+    bool sk_write_archive(const string &path, const vector<string> &names, const vector<string> &files);
+}
+#endif /* archive_driver_h */
@@ -120,6 +120,40 @@ namespace splashkit_lib
         return result;
     }
 
+    sk_sound_data sk_load_sound_data_from_memory(const char *data, size_t size, sk_sound_kind kind)
+    {
+        internal_sk_init();
+        sk_sound_data result = { SGSD_UNKNOWN, NULL } ;
+
+        result.kind = kind;
+
+        switch (kind)
+        {
+            case SGSD_SOUND_EFFECT:
+            {
+                result._data = Mix_LoadWAV_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1);
+                break;
+            }
+            case SGSD_MUSIC:
+            {
+                // Music is streamed as it plays, so data must outlive the music
+                result._data = Mix_LoadMUS_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1);
+                break;
+            }
+
+            case SGSD_UNKNOWN:
+            default:
+                return result;
+        }
+
+        if(result._data == nullptr)
+        {
+            cerr << Mix_GetError() << endl;
+        }
+
+        return result;
+    }
+
     void sk_close_sound_data(sk_sound_data * sound )
     {
         if ( (!sound) || (!sound->_data) ) return;
@@ -201,6 +235,22 @@ namespace splashkit_lib
         return 0.0f;
     }
 
+    // The number of channels playing the sound effect
+    int sk_sound_instances_playing(sk_sound_data * sound)
+    {
+        if ( (!sound) || (!sound->_data) || sound->kind != SGSD_SOUND_EFFECT ) return 0;
+
+        int result = 0;
+        for (int i = 0; i < SG_MAX_CHANNELS; i++)
+        {
+            if ( _sk_sound_channels[i] == sound->_data && Mix_Playing(i) )
+            {
+                result++;
+            }
+        }
+        return result;
+    }
+
     void sk_fade_in(sk_sound_data *sound, int loops, int ms)
     {
         if ( !sound ) return;
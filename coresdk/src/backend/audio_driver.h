@@ -10,6 +10,7 @@
 #define sk_AudioDriver_h
 
 #include <string>
+#include <cstddef>
 using namespace std;
 namespace splashkit_lib
 {
@@ -41,12 +42,17 @@ namespace splashkit_lib
 
     sk_sound_data sk_load_sound_data(string filename, sk_sound_kind kind);
 
+    // Load a sound held in memory, such as a file within an archive.
+    sk_sound_data sk_load_sound_data_from_memory(const char *data, size_t size, sk_sound_kind kind);
+
     void sk_close_sound_data(sk_sound_data * sound );
 
     void sk_play_sound(sk_sound_data * sound, int loops, float volume);
 
     float sk_sound_playing(sk_sound_data * sound);
 
+    int sk_sound_instances_playing(sk_sound_data * sound);
+
     void sk_fade_in(sk_sound_data *sound, int loops, int ms);
 
     void sk_fade_out(sk_sound_data *sound, int ms);
@@ -17,6 +17,7 @@
 #include "concurrency_utils.h"
 #include "civetweb.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <map>
@@ -60,6 +61,9 @@ namespace splashkit_lib
         DISPLAY_PTR =               0x44495350, //'DISP';
         QUERY_PTR =                 0x51555259, //'QURY';
         JSON_PTR =                  0x4a534f4e, //'JSON';
+        PHYSICS_WORLD_PTR =         0x50485957, //'PHYW';
+        PHYSICS_BODY_PTR =          0x50485942, //'PHYB';
+        PARTICLE_EMITTER_PTR =      0x50415254, //'PART';
         NONE_PTR =                  0x4e4f4e45  //'NONE';
     };
 
@@ -140,6 +144,36 @@ namespace splashkit_lib
         bool        cancelled_text_reading;
     };
 
+    // Coarse occupancy of a collision mask, with one bit for each block of
+    // pixels that has any pixel set. Rows are packed as in the pixel mask.
+    struct _collision_mask_level
+    {
+        int block_size;     // The width and height of each block in pixels
+        int words_per_row;  // The number of 64-bit words in each row of blocks
+        uint64_t *blocks;
+    };
+
+#define COLLISION_MASK_LEVELS 2
+
+    // Convex polygons that together outline the set pixels of a bitmap cell,
+    // used for polygon collisions. Points are in the cell's local space.
+    struct _cell_collision_shape
+    {
+        bool built;
+        vector<vector<point_2d>> parts;
+    };
+
+    // The collision mask of one bitmap cell rotated by a fixed angle. Rows are
+    // packed as in the pixel mask. The offset is the location of the mask's
+    // top left corner relative to the cell's origin once rotated.
+    struct _rotated_collision_mask
+    {
+        int width, height;
+        int offset_x, offset_y;
+        int words_per_row;
+        uint64_t *pixel_mask;
+    };
+
     struct _bitmap_data
     {
         pointer_identifier  id;
@@ -152,8 +186,28 @@ namespace splashkit_lib
         int cell_cols;   // The columns of cells in the bitmap
         int cell_rows;   // The rows of cells in the bitmap
         int cell_count;  // The total number of cells in the bitmap
+        unsigned int cell_version;  // Changed each time the cell details are set, for cached cell rectangles
         
-        bool *pixel_mask;   // Pixel mask used for pixel level collisions
+        // Pixel mask used for pixel level collisions. This has one bit per pixel,
+        // with each row packed into 64-bit words (bit 0 is the left most pixel).
+        // Unused bits at the end of each row are 0.
+        uint64_t *pixel_mask;
+        int mask_words_per_row;     // The number of 64-bit words in each row of the mask
+
+        // Loaded bitmaps build their mask when it is first used in a collision
+        bool collision_mask_pending;
+
+        // Coarse levels of the pixel mask, from 8x8 blocks to 32x32 blocks,
+        // used to skip empty areas in pixel level collisions
+        _collision_mask_level mask_levels[COLLISION_MASK_LEVELS];
+
+        // Optional collision masks for each cell at fixed rotations, indexed
+        // by cell * rotated_mask_steps + step
+        int rotated_mask_steps;
+        vector<_rotated_collision_mask> rotated_masks;
+
+        // Collision polygons for each cell, built when first needed
+        vector<_cell_collision_shape> collision_shapes;
     };
 
     struct sk_font_data
@@ -281,17 +335,16 @@ namespace splashkit_lib
         sound_effect sound;       // Which sound should be played on entry
         float duration;           // How long should this animation frame play for
         vector_2d movement;          // Movement data associated with the frame
-        animation_frame *next;    // What is the next frame in this animation
+        int next;                 // The index of the next frame in this animation, or -1 at the end
+        float cycle_duration;     // The duration of the loop this frame is part of, or 0 if it is not in a loop
+        int cycle_frames;         // The number of frames in that loop
     };
 
     struct _animation_data
     {
         pointer_identifier id;
-        animation_frame *first_frame;       // Where did it start?
-        animation_frame *current_frame;     // Where is the animation up to
-        animation_frame *last_frame;        // The last frame used, so last image can be drawn
-        float frame_time;                   // How long have we spent in this frame?
-        bool entered_frame;                 // Did we just enter this frame? (can be used for sound playing)
+        int first_frame;                    // Where did it start?
+        int slot;                           // Where the state of this animation is kept in its script
         animation_script script;            // Which script was it created from?
         string animation_name;              // The name of the animation - when it was started
     };
@@ -308,6 +361,14 @@ namespace splashkit_lib
         vector<animation_frame> frames;  // The frames of the animations within this template.
         
         vector<animation>   anim_objs;         // The animations created from this script
+
+        // The state of each animation in anim_objs, stored in the same order
+        // so all of the script's animations can be updated in one pass
+        vector<int>     anim_current;       // Where is the animation up to, or -1 once it has ended
+        vector<int>     anim_last;          // The last frame used, so last image can be drawn
+        vector<float>   anim_time;          // How long have we spent in this frame?
+        vector<char>    anim_entered;       // Did we just enter this frame? (can be used for sound playing)
+        vector<int>     anim_skipped;       // How many frames were passed over in the last update
     };
 }
 #endif /* BackendTypes_h */
@@ -13,6 +13,9 @@
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
+#include <algorithm>
+#include <functional>
 
 using namespace std;
 namespace splashkit_lib
@@ -110,5 +113,144 @@ namespace splashkit_lib
         }
         
     };
+
+    // A fixed set of worker threads that run tasks from a shared queue. This
+    // lets parallel_for split work every frame without starting and joining
+    // threads each time.
+    class worker_pool
+    {
+    private:
+        struct task
+        {
+            const function<void(int)> *fn;
+            int part;
+            int *remaining;
+        };
+
+        mutex _mutex;
+        condition_variable _work_ready;
+        condition_variable _work_done;
+        queue<task> _tasks;
+        vector<thread> _workers;
+        bool _stopping;
+
+        // Run a task taken from the queue, with the lock held on entry and exit
+        void _run(unique_lock<mutex> &lock)
+        {
+            task t = _tasks.front();
+            _tasks.pop();
+
+            lock.unlock();
+            (*t.fn)(t.part);
+            lock.lock();
+
+            if ( --(*t.remaining) == 0 )
+            {
+                _work_done.notify_all();
+            }
+        }
+
+        void _worker_loop()
+        {
+            unique_lock<mutex> lock(_mutex);
+
+            while ( true )
+            {
+                while ( _tasks.empty() and not _stopping )
+                {
+                    _work_ready.wait(lock);
+                }
+
+                if ( _tasks.empty() ) return;
+
+                _run(lock);
+            }
+        }
+
+    public:
+        explicit worker_pool(int workers)
+        {
+            _stopping = false;
+
+            for (int i = 0; i < workers; i++)
+            {
+                _workers.emplace_back(&worker_pool::_worker_loop, this);
+            }
+        }
+
+        ~worker_pool()
+        {
+            unique_lock<mutex> lock(_mutex);
+            _stopping = true;
+            _work_ready.notify_all();
+            lock.unlock();
+
+            for (thread &worker : _workers)
+            {
+                worker.join();
+            }
+        }
+
+        // Call fn(part) for each part in [0, parts) and return once all are
+        // done. The calling thread runs the first part, then helps with
+        // queued tasks while it waits, so this can be used from within a task.
+        void run(int parts, const function<void(int)> &fn)
+        {
+            int remaining = parts - 1;
+
+            unique_lock<mutex> lock(_mutex);
+            for (int part = 1; part < parts; part++)
+            {
+                _tasks.push({ &fn, part, &remaining });
+            }
+            _work_ready.notify_all();
+            lock.unlock();
+
+            fn(0);
+
+            lock.lock();
+            while ( remaining > 0 )
+            {
+                if ( not _tasks.empty() )
+                    _run(lock);
+                else
+                    _work_done.wait(lock);
+            }
+        }
+
+        // The pool shared by parallel_for, with a worker for each core
+        // other than the calling thread's. It is started when first used.
+        static worker_pool &shared()
+        {
+            static worker_pool pool(max(1, static_cast<int>(thread::hardware_concurrency()) - 1));
+            return pool;
+        }
+    };
+
+    // The number of parts to split count items into, so that each part has
+    // at least min_per_part items and there is at most one part per core.
+    inline int parallel_part_count(int count, int min_per_part)
+    {
+        int cores = max(1, static_cast<int>(thread::hardware_concurrency()));
+        return max(1, min(cores, count / max(1, min_per_part)));
+    }
+
+    // Split the items [0, count) into parts and call fn(part, start, end) for
+    // each part using the shared worker pool. The calling thread runs the
+    // first part, and this returns once all parts are done.
+    template <typename fn_type>
+    void parallel_for(int count, int parts, fn_type fn)
+    {
+        if ( parts <= 1 )
+        {
+            fn(0, 0, count);
+            return;
+        }
+
+        worker_pool::shared().run(parts, [&] (int part)
+        {
+            fn(part, count * part / parts, count * (part + 1) / parts);
+        });
+    }
 }
 #endif // sgsdl2_SGSDL2ConcurrencyUtils_h
@@ -23,6 +23,7 @@ using namespace std;
 
 #include "png.h"
 #include <string.h>
+#include <vector>
 
 #include "core_driver.h"
 #include "graphics_driver.h"
@@ -1831,12 +1832,19 @@ namespace splashkit_lib
     sk_drawing_surface sk_load_bitmap(const char * filename)
     {
         internal_sk_init();
+        sk_drawing_surface result = sk_decode_bitmap(filename);
+
+        if ( result._data )
+            sk_upload_bitmap(&result);
+
+        return result;
+    }
+    
+    // Wrap the decoded surface as a bitmap, without creating its textures
+    sk_drawing_surface _sk_bitmap_from_decoded_surface(SDL_Surface *surface)
+    {
         sk_drawing_surface result = { SGDS_Unknown, 0, 0, nullptr };
         
-        SDL_Surface *surface;
-        
-        surface = IMG_Load(filename);
-        
         if ( ! surface ) {
             std::cout << "error loading image " << IMG_GetError() << std::endl;
             return result;
@@ -1845,6 +1853,89 @@ namespace splashkit_lib
         
         result._data = data;
         
+        data->texture = nullptr;
+        data->surface = surface;
+        data->drawable = false;
+        data->clipped = false;
+        data->clip = {0,0,0,0};
+        
+        result.kind = SGDS_Bitmap;
+        result.width = surface->w;
+        result.height = surface->h;
+        
+        return result;
+    }
+    
+    sk_drawing_surface sk_decode_bitmap(const char * filename)
+    {
+        return _sk_bitmap_from_decoded_surface(IMG_Load(filename));
+    }
+    
+    sk_drawing_surface sk_decode_bitmap_from_memory(const char * data, size_t size)
+    {
+        return _sk_bitmap_from_decoded_surface(IMG_Load_RW(SDL_RWFromConstMem(data, static_cast<int>(size)), 1));
+    }
+    
+    sk_drawing_surface sk_decode_bitmap_from_pixels(int width, int height, const uint32_t *pixels)
+    {
+        SDL_Surface *surface = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        
+        if ( surface )
+        {
+            for (int y = 0; y < height; y++)
+            {
+                memcpy(static_cast<Uint8 *>(surface->pixels) + y * surface->pitch, pixels + y * width, sizeof(uint32_t) * width);
+            }
+        }
+        
+        return _sk_bitmap_from_decoded_surface(surface);
+    }
+    
+    bool sk_bitmap_argb_pixels(sk_drawing_surface *surface, uint32_t *pixels)
+    {
+        if ( ! surface || ! surface->_data || surface->kind != SGDS_Bitmap ) return false;
+        
+        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(surface->_data);
+        if ( ! data->surface ) return false;
+        
+        // Converting the whole surface handles every format, including palettes
+        SDL_Surface *argb = SDL_ConvertSurfaceFormat(data->surface, SDL_PIXELFORMAT_ARGB8888, 0);
+        if ( ! argb ) return false;
+        
+        for (int y = 0; y < argb->h; y++)
+        {
+            memcpy(pixels + y * argb->w, static_cast<Uint8 *>(argb->pixels) + y * argb->pitch, sizeof(uint32_t) * argb->w);
+        }
+        
+        SDL_FreeSurface(argb);
+        return true;
+    }
+    
+    bool sk_bitmap_surface_pixels(sk_drawing_surface *surface, const uint32_t *&pixels, int &pitch, int &alpha_shift)
+    {
+        if ( ! surface || ! surface->_data || surface->kind != SGDS_Bitmap ) return false;
+        
+        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(surface->_data);
+        
+        // The surface is released when the bitmap is drawn onto
+        SDL_Surface *surf = data->surface;
+        if ( ! surf || SDL_MUSTLOCK(surf) ) return false;
+        
+        SDL_PixelFormat *format = surf->format;
+        if ( format->BytesPerPixel != 4 || format->Amask != (0xFFu << format->Ashift) ) return false;
+        
+        pixels = static_cast<const uint32_t *>(surf->pixels);
+        pitch = surf->pitch;
+        alpha_shift = format->Ashift;
+        return true;
+    }
+    
+    void sk_upload_bitmap(sk_drawing_surface *surface)
+    {
+        if ( ! surface || ! surface->_data || surface->kind != SGDS_Bitmap ) return;
+        
+        sk_bitmap_be *data = static_cast<sk_bitmap_be *>(surface->_data);
+        
         // Allocate space for one texture per window
         if (_sk_num_open_windows > 0)
             data->texture = static_cast<SDL_Texture **>(malloc(sizeof(SDL_Texture*) * _sk_num_open_windows));
@@ -1854,21 +1945,10 @@ namespace splashkit_lib
         for (unsigned int i = 0; i < _sk_num_open_windows; i++)
         {
             // Create a texture for each window
-            data->texture[i] = SDL_CreateTextureFromSurface(_sk_open_windows[i]->renderer, surface);
+            data->texture[i] = SDL_CreateTextureFromSurface(_sk_open_windows[i]->renderer, data->surface);
         }
         
-        data->surface = surface;
-        data->drawable = false;
-        data->clipped = false;
-        data->clip = {0,0,0,0};
-        
-        result.kind = SGDS_Bitmap;
-        result.width = surface->w;
-        result.height = surface->h;
-        
         _sk_add_bitmap(data);
-        
-        return result;
     }
     
     //x, y is the position to draw the bitmap to. As bitmaps scale around their centre, (x, y) is the top-left of the bitmap IF and ONLY IF scale = 1.
@@ -1955,6 +2035,100 @@ namespace splashkit_lib
         }
     }
     
+    // Reused between batches, so drawing the same number of items each frame
+    // does not allocate
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    static vector<SDL_Vertex> _sk_batch_vertices;
+    static vector<int> _sk_batch_indices;
+#endif
+
+    void sk_draw_bitmap_batch( sk_drawing_surface * src, sk_drawing_surface * dst, const float * src_data, const float * dst_data, const unsigned int * clr_data, int count )
+    {
+        if ( ! src || ! dst || src->kind != SGDS_Bitmap || count <= 0 )
+            return;
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+        // Build two triangles for each item, so the whole batch is sent to
+        // the renderer in one call
+        float tex_w = 1.0f / src->width;
+        float tex_h = 1.0f / src->height;
+
+        _sk_batch_vertices.resize(count * 4);
+        for (int i = 0; i < count; i++)
+        {
+            const float *s = src_data + i * 4;
+            const float *d = dst_data + i * 4;
+            unsigned int clr = clr_data[i];
+            SDL_Color sdl_clr = {
+                static_cast<Uint8>(clr),
+                static_cast<Uint8>(clr >> 8),
+                static_cast<Uint8>(clr >> 16),
+                static_cast<Uint8>(clr >> 24)
+            };
+
+            float u1 = s[0] * tex_w, v1 = s[1] * tex_h;
+            float u2 = (s[0] + s[2]) * tex_w, v2 = (s[1] + s[3]) * tex_h;
+
+            SDL_Vertex *v = &_sk_batch_vertices[i * 4];
+            v[0] = { { d[0],        d[1] },        sdl_clr, { u1, v1 } };
+            v[1] = { { d[0] + d[2], d[1] },        sdl_clr, { u2, v1 } };
+            v[2] = { { d[0] + d[2], d[1] + d[3] }, sdl_clr, { u2, v2 } };
+            v[3] = { { d[0],        d[1] + d[3] }, sdl_clr, { u1, v2 } };
+        }
+
+        // The indices only depend on the count, so only new ones are added
+        int indexed = static_cast<int>(_sk_batch_indices.size()) / 6;
+        if ( indexed < count )
+        {
+            _sk_batch_indices.resize(count * 6);
+            for (int i = indexed; i < count; i++)
+            {
+                int *idx = &_sk_batch_indices[i * 6];
+                idx[0] = i * 4;     idx[1] = i * 4 + 1; idx[2] = i * 4 + 2;
+                idx[3] = i * 4;     idx[4] = i * 4 + 2; idx[5] = i * 4 + 3;
+            }
+        }
+#endif
+
+        unsigned int renderer_count = _sk_renderer_count(dst);
+
+        for (unsigned int r = 0; r < renderer_count; r++)
+        {
+            SDL_Renderer *renderer = _sk_prepared_renderer(dst, r);
+            SDL_Texture *srcT;
+
+            // if its a window, dont use the renderer index to get the texture
+            if (dst->kind == SGDS_Window)
+                srcT = static_cast<sk_bitmap_be *>(src->_data)->texture[ static_cast<sk_window_be *>(dst->_data)->idx ];
+            else
+                srcT = static_cast<sk_bitmap_be *>(src->_data)->texture[ r ];
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+            SDL_RenderGeometry(renderer, srcT, _sk_batch_vertices.data(), count * 4, _sk_batch_indices.data(), count * 6);
+#else
+            // Older renderers cannot draw geometry, so tint and copy each item
+            for (int i = 0; i < count; i++)
+            {
+                const float *s = src_data + i * 4;
+                const float *d = dst_data + i * 4;
+                unsigned int clr = clr_data[i];
+
+                SDL_Rect src_rect = { static_cast<int>(s[0]), static_cast<int>(s[1]), static_cast<int>(s[2]), static_cast<int>(s[3]) };
+                SDL_Rect dst_rect = { static_cast<int>(d[0]), static_cast<int>(d[1]), static_cast<int>(d[2]), static_cast<int>(d[3]) };
+
+                SDL_SetTextureColorMod(srcT, clr & 0xff, (clr >> 8) & 0xff, (clr >> 16) & 0xff);
+                SDL_SetTextureAlphaMod(srcT, clr >> 24);
+                SDL_RenderCopy(renderer, srcT, &src_rect, &dst_rect);
+            }
+
+            SDL_SetTextureColorMod(srcT, 255, 255, 255);
+            SDL_SetTextureAlphaMod(srcT, 255);
+#endif
+
+            _sk_complete_render(dst, r);
+        }
+    }
+
     void sk_finalise_graphics()
     {
         // Close all bitmaps
@@ -51,9 +51,41 @@ namespace splashkit_lib
 
     sk_drawing_surface sk_load_bitmap(const char * filename);
 
+    // Read and decode the image file without creating its textures. This does
+    // not use the renderer, so it can be called from a worker thread. The
+    // bitmap cannot be drawn until it is passed to sk_upload_bitmap on the
+    // main thread.
+    sk_drawing_surface sk_decode_bitmap(const char * filename);
+
+    // Decode an image held in memory, such as a file within an archive.
+    sk_drawing_surface sk_decode_bitmap_from_memory(const char * data, size_t size);
+
+    // Create a bitmap from ARGB8888 pixels, with alpha in the high byte,
+    // without creating its textures.
+    sk_drawing_surface sk_decode_bitmap_from_pixels(int width, int height, const uint32_t *pixels);
+
+    // Copy the pixels of a bitmap from sk_decode_bitmap into pixels as
+    // ARGB8888, the format textures are created in.
+    bool sk_bitmap_argb_pixels(sk_drawing_surface *surface, uint32_t *pixels);
+
+    // Get the pixels of a loaded bitmap in place, when they are 32 bits with
+    // an 8 bit alpha channel. Rows are pitch bytes apart, and alpha_shift is
+    // the position of the alpha byte in each pixel. Returns false if the
+    // bitmap no longer has its surface, or stores its pixels another way.
+    bool sk_bitmap_surface_pixels(sk_drawing_surface *surface, const uint32_t *&pixels, int &pitch, int &alpha_shift);
+
+    // Create the textures for a bitmap from sk_decode_bitmap, one for each
+    // open window.
+    void sk_upload_bitmap(sk_drawing_surface *surface);
+
 
     void sk_draw_bitmap( sk_drawing_surface * src, sk_drawing_surface * dst, float * src_data, int src_data_sz, float * dst_data, int dst_data_sz, sk_renderer_flip flip );
 
+    // Draw count parts of src onto dst. src_data and dst_data hold an x, y,
+    // width and height for each item, and clr_data holds the tint of each
+    // item with red in the low byte and alpha in the high byte.
+    void sk_draw_bitmap_batch( sk_drawing_surface * src, sk_drawing_surface * dst, const float * src_data, const float * dst_data, const unsigned int * clr_data, int count );
+
     void sk_set_icon(sk_drawing_surface *surface, sk_drawing_surface *icon);
 
 
@@ -0,0 +1,52 @@
+//
+//  simd_utils.h
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#ifndef splashkit_simd_utils_h
+#define splashkit_simd_utils_h
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Select the widest vector instructions the compiler is targeting. Building
+// with -mavx (or -mavx2) enables the AVX kernels, x86-64 always has SSE2,
+// and 64-bit ARM always has NEON. Anything else uses the scalar code.
+#if defined(__AVX__)
+#   define SK_SIMD_AVX
+#   include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define SK_SIMD_SSE2
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#   define SK_SIMD_NEON
+#   include <arm_neon.h>
+#endif
+
+using namespace std;
+namespace splashkit_lib
+{
+    /**
+     * Size the bitmask to hold one bit for each of count elements, with all
+     * bits clear. Bit i is bit (i & 63) of word (i >> 6).
+     */
+    inline void clear_bitmask(vector<uint64_t> &mask, size_t count)
+    {
+        mask.assign((count + 63) / 64, 0);
+    }
+
+    /**
+     * Set the bits for a run of elements starting at idx. The run must not
+     * cross a word, which holds for runs of 1, 2, 4 or 8 starting at a
+     * multiple of their length.
+     */
+    inline void set_bitmask_bits(vector<uint64_t> &mask, size_t idx, uint64_t bits)
+    {
+        mask[idx >> 6] |= bits << (idx & 63);
+    }
+}
+
+#endif /* splashkit_simd_utils_h */
@@ -15,8 +15,11 @@
 #include <string>
 #include <locale>
 #include <algorithm>
+#include <thread>
+#include <functional>
 
 #include <cstdlib>
+#include <cstdio>
 
 #include <unistd.h>
 #include <sys/types.h>
@@ -51,6 +54,57 @@ namespace splashkit_lib
         return (stat (path.c_str(), &buffer) == 0) and ( (buffer.st_mode & S_IFDIR) != 0);
     }
 
+    bool file_details(const string &path, int64_t &modified, int64_t &size)
+    {
+        struct stat buffer;
+        if ( stat(path.c_str(), &buffer) != 0 ) return false;
+
+        modified = static_cast<int64_t>(buffer.st_mtime);
+        size = static_cast<int64_t>(buffer.st_size);
+        return true;
+    }
+
+    bool replace_file(const string &temp_path, const string &path)
+    {
+        if ( rename(temp_path.c_str(), path.c_str()) == 0 ) return true;
+
+        // Windows will not rename over an existing file
+        remove(path.c_str());
+        if ( rename(temp_path.c_str(), path.c_str()) == 0 ) return true;
+
+        remove(temp_path.c_str());
+        return false;
+    }
+
+    string temp_path_for(const string &path)
+    {
+        size_t thread = hash<thread::id>()(this_thread::get_id());
+        return cat({ path, ".", to_string(getpid()), "-", to_string(thread), ".tmp" });
+    }
+
+    uint64_t fnv1a_hash(const string &data)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : data)
+        {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    string cache_file_for(const string &folder, const string &source_path, const string &extension)
+    {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(fnv1a_hash(source_path)));
+
+        size_t name_start = source_path.find_last_of("/\\");
+        string name = name_start == string::npos ? source_path : source_path.substr(name_start + 1);
+
+        return path_from({ folder }, cat({ name, "-", hex, extension }));
+    }
+
     string directory_of(const string filename)
     {
         size_t found;
@@ -12,6 +12,7 @@
 #include "backend_types.h"
 
 #include <string>
+#include <cstdint>
 #include <initializer_list>
 #include <algorithm>
 
@@ -29,6 +30,29 @@ namespace splashkit_lib
 
     bool directory_exists(string path);
 
+    // Get the time the file was last changed, in seconds, and its size in
+    // bytes. Returns false if the file does not exist.
+    bool file_details(const string &path, int64_t &modified, int64_t &size);
+
+    // Move the file at temp_path to path, replacing any file already there.
+    // Returns false, and removes temp_path, if the file cannot be moved.
+    bool replace_file(const string &temp_path, const string &path);
+
+    // A name for a temporary file to write before replacing path with it.
+    // The name includes the process and thread, so writers of the same path
+    // on different threads or in different programs do not share it.
+    string temp_path_for(const string &path);
+
+    // A 64 bit FNV-1a hash of the data, used to tell when cached files are
+    // out of date and to name them.
+    uint64_t fnv1a_hash(const string &data);
+
+    // The file in the cache folder that holds a processed copy of the file at
+    // source_path. The name starts with the source's file name to make the
+    // folder easy to read, and ends with a hash of the full path so files with
+    // the same name in different folders do not share a cache file.
+    string cache_file_for(const string &folder, const string &source_path, const string &extension);
+
 #define VALID_PTR(p,pkind) ( (p) and p->id == pkind )
 #define INVALID_PTR(p,pkind) ( not VALID_PTR(p,pkind) )
 
@@ -190,7 +214,70 @@ collection.erase(collection.begin());\
     
     double deg_to_rad(double degrees);
 
+    // Do the two convex polygons overlap? The points of each are listed in
+    // order around the polygon. Polygons that only touch along an edge or at
+    // a corner do intersect, and flat polygons (lines and points) are handled.
+    // Used by the shape tests in geometry and by polygon sprite collisions.
+    // Implemented in triangle_geometry.
+    bool convex_polygons_intersect(const point_2d *a, int a_count, const point_2d *b, int b_count);
+
+    // The details draw_sprite passes to the graphics driver for each visible
+    // layer of the sprite, drawn with no offset: the 4 source values, then the
+    // 7 destination values. The cached draw data is used when it is current,
+    // unless rebuild is true. Lets tests check the cache against a fresh
+    // rebuild. Implemented in sprites.
+    vector<float> sprite_draw_details(sprite s, bool rebuild);
+
+    // Is there an up to date compiled copy of the animation script file in
+    // the animation cache folder? Loading the script reads this copy rather
+    // than the text. Lets tests check the cache. Implemented in animations.
+    bool animation_script_cached(const string &filename);
+
     // Notify the listeners that a resource has been freed. Implemented in resources.
     void notify_of_free(void *resource);
+
+    // Build the bitmap's collision mask if it has not been built yet. Returns
+    // false if the bitmap has no collision mask. This must only be called on
+    // the main thread, as it changes the bitmap and may read back from the
+    // renderer; code that tests collisions on worker threads must call it
+    // for each bitmap first. Implemented in images.
+    bool ensure_collision_mask(_bitmap_data *bmp);
+
+    // Loading in two parts, used by asynchronous resource bundles. The prepare
+    // functions read and decode the file, and can be called from a worker
+    // thread. When data is provided it holds the file's contents, such as an
+    // entry in a resource archive, and the file is not opened. The finish
+    // functions must be called on the main thread, and create any textures
+    // and register the resource by name. Each returns nullptr on failure.
+    // Implemented in images, sound, music and animations.
+    struct _sound_data;
+    struct _music_data;
+    struct _animation_script_source;
+
+    _bitmap_data *prepare_bitmap(const string &name, const string &filename, const char *data = nullptr, size_t size = 0);
+    _bitmap_data *finish_bitmap(_bitmap_data *bmp);
+
+    _sound_data *prepare_sound_effect(const string &name, const string &filename, const char *data = nullptr, size_t size = 0);
+    _sound_data *finish_sound_effect(_sound_data *prepared);
+
+    _music_data *prepare_music(const string &name, const string &filename, const char *data = nullptr, size_t size = 0);
+    _music_data *finish_music(_music_data *prepared);
+
+    _animation_script_source *prepare_animation_script(const string &name, const string &filename, const char *data = nullptr, size_t size = 0);
+    _animation_script_data *finish_animation_script(_animation_script_source *source);
+
+    // A sound effect waiting to be played when queued sounds are flushed,
+    // with the volume to play it at
+    struct queued_sound
+    {
+        _sound_data *effect;
+        float volume;
+    };
+
+    // Add the effect to the queue. An effect already in the queue is not
+    // added again, but keeps the louder of the two volumes, or their sum (at
+    // most 1) when summing. The effect is only compared, so tests can check
+    // these rules without audio. Implemented in sound.
+    void add_queued_sound(vector<queued_sound> &queue, _sound_data *effect, float volume, bool summing);
 }
 #endif /* utility_functions_h */
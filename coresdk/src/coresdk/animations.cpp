@@ -16,8 +16,14 @@
 
 #include <algorithm>
 #include <cctype>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <vector>
 #include <map>
 
@@ -27,10 +33,14 @@ namespace splashkit_lib
 {
     static map<string, animation_script> _animation_scripts;
 
+    // Frame durations count updates, and the time based updates treat this
+    // many updates as one second
+    #define ANIMATION_UPDATES_PER_SECOND 60.0f
+
     struct row_data
     {
         int id,cell,dur,next;
-        sound_effect snd;
+        int snd;            // index into the script's sounds, or -1 for none
         vector_2d mvmt;
     };
 
@@ -40,26 +50,222 @@ namespace splashkit_lib
         int start_id;
     };
 
+    struct sound_ref
+    {
+        string name, filename;
+    };
+
     int animation_index(animation_script temp, const string &name);
 
-    animation_script load_animation_script(const string &name, const string &filename)
+    //
+    // Compiled animation scripts
+    //
+    // While a cache folder is set, a compiled copy of each script is saved
+    // there. It records the size and a hash of the text it was made from, so
+    // it is remade when the text changes, even if the size and modified time
+    // stay the same. The file is a header, then the frames, ids and sounds:
+    //
+    //   header:  magic, version, text hash, text size, and the number of
+    //            frames, ids and sounds
+    //   frame:   id, cell, duration, next, sound index, movement x and y
+    //   id:      name, start frame
+    //   sound:   name, filename
+    //
+    // Strings are stored as their length followed by their characters.
+    //
+
+    #define ANIMATION_CACHE_EXTENSION ".skanim"
+    #define ANIMATION_CACHE_MAGIC 0x4d494e41  // 'ANIM' when read in the order it was written
+    #define ANIMATION_CACHE_VERSION 2
+
+    // The fewest bytes each id and sound can take in a compiled script
+    #define ANIMATION_CACHE_MIN_ID_SIZE (sizeof(uint32_t) + sizeof(int32_t))
+    #define ANIMATION_CACHE_MIN_SOUND_SIZE (2 * sizeof(uint32_t))
+
+    // Empty when animation scripts are not cached
+    static string _animation_cache_path;
+
+    void set_animation_cache_path(const string &path)
     {
-        animation_script result;
-        vector<row_data> rows;
-        vector<id_data> ids;
+        if ( path.length() > 0 and not directory_exists(path) )
+        {
+            LOG(WARNING) << "Unable to cache animation scripts in " << path << ". The folder does not exist.";
+            _animation_cache_path = "";
+            return;
+        }
 
-        string line, line_id, data;
-        int line_no, max_id;
+        _animation_cache_path = path;
+    }
 
-        string path = path_to_resource(filename, ANIMATION_RESOURCE);
+    struct _animation_cache_header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t source_hash;
+        int64_t source_size;
+        int32_t frame_count;
+        int32_t id_count;
+        int32_t sound_count;
+    };
 
-        if ( ! file_exists(path) )
+    struct _animation_cache_frame
+    {
+        int32_t id, cell, dur, next, snd;
+        double mvmt_x, mvmt_y;
+    };
+
+    // Reads values from a compiled script, failing once it runs past the end
+    struct _animation_cache_reader
+    {
+        const char *pos, *end;
+
+        bool read(void *dest, size_t sz)
         {
-            LOG(WARNING) << cat({ "Unable to locate animation file for ", name, " (", path, ")"});
-            return nullptr;
+            if ( static_cast<size_t>(end - pos) < sz ) return false;
+            memcpy(dest, pos, sz);
+            pos += sz;
+            return true;
+        }
+
+        bool read(string &dest)
+        {
+            uint32_t len;
+            if ( not read(&len, sizeof(len)) or static_cast<size_t>(end - pos) < len ) return false;
+            dest.assign(pos, len);
+            pos += len;
+            return true;
         }
+    };
+
+    static void _write_cache_string(ofstream &out, const string &value)
+    {
+        uint32_t len = static_cast<uint32_t>(value.length());
+        out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+        out.write(value.data(), len);
+    }
+
+    static bool _read_animation_cache(const string &cache_path, const string &text, vector<row_data> &rows, vector<id_data> &ids, vector<sound_ref> &sounds)
+    {
+        // Read the whole file at once, then pick it apart
+        ifstream input(cache_path, ios::binary | ios::ate);
+        if ( not input ) return false;
 
-        ifstream input(path);
+        streamsize length = input.tellg();
+        if ( length < static_cast<streamsize>(sizeof(_animation_cache_header)) ) return false;
+
+        vector<char> buffer(static_cast<size_t>(length));
+        input.seekg(0);
+        if ( not input.read(buffer.data(), length) ) return false;
+
+        _animation_cache_reader reader = { buffer.data(), buffer.data() + buffer.size() };
+        _animation_cache_header header;
+
+        reader.read(&header, sizeof(header));
+
+        if ( header.magic != ANIMATION_CACHE_MAGIC or header.version != ANIMATION_CACHE_VERSION or
+             header.source_size != static_cast<int64_t>(text.size()) or header.source_hash != fnv1a_hash(text) or
+             header.frame_count < 0 or header.id_count < 0 or header.sound_count < 0 )
+            return false;
+
+        // Check the counts fit in the file before making room for them
+        uint64_t remaining = static_cast<uint64_t>(reader.end - reader.pos);
+        uint64_t needed = header.frame_count * static_cast<uint64_t>(sizeof(_animation_cache_frame)) +
+                          header.id_count * static_cast<uint64_t>(ANIMATION_CACHE_MIN_ID_SIZE) +
+                          header.sound_count * static_cast<uint64_t>(ANIMATION_CACHE_MIN_SOUND_SIZE);
+        if ( needed > remaining ) return false;
+
+        rows.resize(header.frame_count);
+        for (row_data &row : rows)
+        {
+            _animation_cache_frame frame;
+            if ( not reader.read(&frame, sizeof(frame)) ) return false;
+
+            row.id = frame.id;
+            row.cell = frame.cell;
+            row.dur = frame.dur;
+            row.next = frame.next;
+            row.snd = frame.snd;
+            row.mvmt = vector_to(frame.mvmt_x, frame.mvmt_y);
+
+            if ( row.snd < -1 or row.snd >= header.sound_count ) return false;
+        }
+
+        ids.resize(header.id_count);
+        for (id_data &id : ids)
+        {
+            int32_t start_id;
+            if ( not reader.read(id.name) or not reader.read(&start_id, sizeof(start_id)) ) return false;
+            id.start_id = start_id;
+        }
+
+        sounds.resize(header.sound_count);
+        for (sound_ref &snd : sounds)
+        {
+            if ( not reader.read(snd.name) or not reader.read(snd.filename) ) return false;
+        }
+
+        return true;
+    }
+
+    static void _write_animation_cache(const string &cache_path, const string &text, const vector<row_data> &rows, const vector<id_data> &ids, const vector<sound_ref> &sounds)
+    {
+        _animation_cache_header header;
+
+        header.source_hash = fnv1a_hash(text);
+        header.source_size = static_cast<int64_t>(text.size());
+        header.magic = ANIMATION_CACHE_MAGIC;
+        header.version = ANIMATION_CACHE_VERSION;
+        header.frame_count = static_cast<int32_t>(rows.size());
+        header.id_count = static_cast<int32_t>(ids.size());
+        header.sound_count = static_cast<int32_t>(sounds.size());
+
+        // Write to a temporary file first, so a partly written cache is
+        // never read
+        string temp_path = temp_path_for(cache_path);
+        {
+            ofstream out(temp_path, ios::binary | ios::trunc);
+
+            // Resources may be read only, in which case the text is read each time
+            if ( not out ) return;
+
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+            for (const row_data &row : rows)
+            {
+                _animation_cache_frame frame = { row.id, row.cell, row.dur, row.next, row.snd, row.mvmt.x, row.mvmt.y };
+                out.write(reinterpret_cast<const char *>(&frame), sizeof(frame));
+            }
+
+            for (const id_data &id : ids)
+            {
+                int32_t start_id = id.start_id;
+                _write_cache_string(out, id.name);
+                out.write(reinterpret_cast<const char *>(&start_id), sizeof(start_id));
+            }
+
+            for (const sound_ref &snd : sounds)
+            {
+                _write_cache_string(out, snd.name);
+                _write_cache_string(out, snd.filename);
+            }
+
+            if ( not out )
+            {
+                out.close();
+                remove(temp_path.c_str());
+                return;
+            }
+        }
+
+        replace_file(temp_path, cache_path);
+    }
+
+    // Read the text version of an animation script. Clean is set to false if
+    // any line had an error, and so was skipped.
+    static bool _parse_animation_script(istream &input, const string &filename, vector<row_data> &rows, vector<id_data> &ids, vector<sound_ref> &sounds, bool &clean)
+    {
+        string line, line_id, data;
+        int line_no, max_id;
 
         //
         // Declare lambdas that access above data
@@ -78,7 +284,7 @@ namespace splashkit_lib
                 for (j = max_id + 1; j < rows.size(); j++)
                 {
                     rows[j].id   = -1;
-                    rows[j].snd  = nullptr;
+                    rows[j].snd  = -1;
                     rows[j].cell = -1;
                     rows[j].next = -1;
                     rows[j].mvmt = vector_to(0,0);
@@ -167,7 +373,7 @@ namespace splashkit_lib
                 my_row.id        = id_range[j];
                 my_row.cell      = cell_range[j];
                 my_row.dur       = dur;
-                my_row.snd       = nullptr;
+                my_row.snd       = -1;
                 my_row.mvmt      = vector_to(0,0);
 
                 if ( j < id_range.size() - 1 )
@@ -199,32 +405,37 @@ namespace splashkit_lib
 
         auto process_sound = [&]()
         {
-            int id;
+            int id, j;
             string snd_id, snd_file;
 
             if (count_delimiter(data, ',') != 2)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". A sound must have three parts frame #,sound name,sound file.";
-                return;
+                return false;
             }
 
             id = str_to_int(extract_delimited(1, data, ','), true);
             snd_id = extract_delimited(2,data,',');
             snd_file = extract_delimited(3,data,',');
 
-            if (not has_sound_effect(snd_id))
+            if (id < 0 || id >= rows.size())
             {
-                if(load_sound_effect(snd_id, snd_file) == nullptr)
-                {
-                    LOG(WARNING) << "At line " + to_string(line_no) + " in animation " + filename + ": Cannot find " + snd_id + " sound file " + snd_file;
-                    return;
-                }
+                LOG(WARNING) << "At line " + to_string(line_no) + " in animation " + filename + ": No frame with id " + to_string(id) + " for sound file " + snd_file;
+                return false;
             }
 
-            if (id >= 0 && id < rows.size())
-                rows[id].snd = sound_effect_named(snd_id);
-            else
-                LOG(WARNING) << "At line " + to_string(line_no) + " in animation " + filename + ": No frame with id " + to_string(id) + " for sound file " + snd_file;
+            // Sounds are loaded once the whole script is read, so only
+            // record which sound the frame uses
+            for (j = 0; j < sounds.size(); j++)
+            {
+                if (sounds[j].name == snd_id) break;
+            }
+
+            if (j == sounds.size())
+                sounds.push_back({snd_id, snd_file});
+
+            rows[id].snd = j;
+            return true;
         };
 
         auto process_vector = [&]()
@@ -237,7 +448,7 @@ namespace splashkit_lib
             if (count_delimiter(data, ',') != 2)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". A vector must have three parts frame #s, x value, y value.";
-                return;
+                return false;
             }
 
             process_range(extract_delimited_with_ranges(1, data), id_range);
@@ -247,13 +458,13 @@ namespace splashkit_lib
             if (not try_str_to_float(x_val, x))
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". X value must be a number.";
-                return;
+                return false;
             }
 
             if (not try_str_to_float(y_val, y))
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". Y value must be a number.";
-                return;
+                return false;
             }
 
             v = vector_to(x, y);
@@ -267,6 +478,8 @@ namespace splashkit_lib
                     rows[id].mvmt = v;
                 }
             }
+
+            return true;
         };
 
         auto process_line = [&]()
@@ -279,30 +492,207 @@ namespace splashkit_lib
             if (line_id.length() != 1)
             {
                 LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". Error with frame #: " + line_id + ". This should be a single character.";
-                return;
+                return false;
             }
 
             // Process based on id
             switch (tolower(line_id[0])) // in all cases the data variable is read
             {
                 case 'f':
-                    process_multi_frame(); //test... or ProcessFrame();
-                    break;
+                    return process_multi_frame(); //test... or ProcessFrame();
                 case 'm':
-                    process_multi_frame();
-                    break;
+                    return process_multi_frame();
                 case 'i':
-                    process_id();
-                    break;
+                    return process_id();
                 case 's':
-                    process_sound();
-                    break;
+                    return process_sound();
                 case 'v':
-                    process_vector();
-                    break;
+                    return process_vector();
                 default:
                     LOG(WARNING) << "Error at line " + to_string(line_no) + " in animation " + filename + ". Error with id: " + line_id + ". This should be one of f,m,i, s, or v.";
-                    return;
+                    return false;
+            }
+        };
+
+        auto verify_version = [&]()
+        {
+            if (input.eof()) return false;
+            line = "";
+
+            while ((line.length() == 0) or (line.substr(0,2) == "//"))
+            {
+                getline(input, line);
+                line = trim(line);
+            }
+
+            //Verify that the line has the right version
+            if ((line != "SwinGame Animation #v1") and (line != "SplashKit Animation"))
+            {
+                LOG(WARNING) << "Error in animation " + filename + ". Animation files must start with 'SplashKit Animation'";
+                return false;
+            }
+
+            return true;
+        };
+
+        line_no = 0;
+        max_id = -1;
+        rows.resize(0);
+        clean = true;
+
+        if (not verify_version())
+        {
+            LOG(WARNING) << "Error loading animation script: " + filename;
+            return false;
+        }
+
+
+        while (getline(input, line))
+        {
+            line_no = line_no + 1;
+
+            line = trim(line);
+            if (line.length() == 0) continue;  //skip empty lines
+            if (line.substr(0,2) == "//") continue; //skip lines starting with //
+
+            if (not process_line()) clean = false;
+        }
+
+        return true;
+    }
+
+    // The frames, ids and sounds read from a script, before the sounds are
+    // loaded and the script is registered
+    struct _animation_script_source
+    {
+        string name, filename;
+        vector<row_data> rows;
+        vector<id_data> ids;
+        vector<sound_ref> sounds;
+    };
+
+    static bool _read_script_text(const string &path, string &text)
+    {
+        ifstream input(path, ios::binary);
+        if ( not input ) return false;
+
+        ostringstream contents;
+        contents << input.rdbuf();
+        text = contents.str();
+        return true;
+    }
+
+    // See utility_functions.h
+    bool animation_script_cached(const string &filename)
+    {
+        string path = path_to_resource(filename, ANIMATION_RESOURCE);
+        string text;
+
+        if ( _animation_cache_path.length() == 0 or not _read_script_text(path, text) ) return false;
+
+        vector<row_data> rows;
+        vector<id_data> ids;
+        vector<sound_ref> sounds;
+        return _read_animation_cache(cache_file_for(_animation_cache_path, path, ANIMATION_CACHE_EXTENSION), text, rows, ids, sounds);
+    }
+
+    _animation_script_source *prepare_animation_script(const string &name, const string &filename, const char *data, size_t size)
+    {
+        bool clean;
+
+        // Scripts from an archive are parsed in place, without a compiled copy
+        if ( data )
+        {
+            _animation_script_source *source = new _animation_script_source();
+            source->name = name;
+            source->filename = filename;
+
+            istringstream input(string(data, size));
+            if ( not _parse_animation_script(input, filename, source->rows, source->ids, source->sounds, clean) )
+            {
+                delete source;
+                return nullptr;
+            }
+
+            return source;
+        }
+
+        string path = path_to_resource(filename, ANIMATION_RESOURCE);
+
+        if ( ! file_exists(path) )
+        {
+            LOG(WARNING) << cat({ "Unable to locate animation file for ", name, " (", path, ")"});
+            return nullptr;
+        }
+
+        // The text is always read, so the cache can tell if it has changed
+        string text;
+        if ( not _read_script_text(path, text) )
+        {
+            LOG(WARNING) << "Error loading animation script: " + filename;
+            return nullptr;
+        }
+
+        _animation_script_source *source = new _animation_script_source();
+        source->name = name;
+        source->filename = filename;
+
+        // Use the compiled script if it is cached and up to date, otherwise
+        // parse the text and compile it for next time
+        string cache_path;
+        if ( _animation_cache_path.length() > 0 )
+            cache_path = cache_file_for(_animation_cache_path, path, ANIMATION_CACHE_EXTENSION);
+
+        if ( cache_path.length() == 0 or not _read_animation_cache(cache_path, text, source->rows, source->ids, source->sounds) )
+        {
+            source->rows.clear();
+            source->ids.clear();
+            source->sounds.clear();
+
+            istringstream input(text);
+
+            if ( not _parse_animation_script(input, filename, source->rows, source->ids, source->sounds, clean) )
+            {
+                delete source;
+                return nullptr;
+            }
+
+            // Scripts with errors are not cached, so the errors are reported
+            // each time they are loaded
+            if ( clean and cache_path.length() > 0 )
+                _write_animation_cache(cache_path, text, source->rows, source->ids, source->sounds);
+        }
+
+        return source;
+    }
+
+    animation_script finish_animation_script(_animation_script_source *source)
+    {
+        if ( not source ) return nullptr;
+
+        animation_script result = nullptr;
+        const string name = source->name;
+        const string filename = source->filename;
+        const vector<row_data> &rows = source->rows;
+        const vector<id_data> &ids = source->ids;
+        const vector<sound_ref> &sounds = source->sounds;
+
+        //
+        // Declare lambdas that access above data
+        //
+
+        vector<sound_effect> loaded_sounds;
+
+        auto load_sounds = [&]()
+        {
+            for (const sound_ref &snd : sounds)
+            {
+                if (not has_sound_effect(snd.name) and load_sound_effect(snd.name, snd.filename) == nullptr)
+                {
+                    LOG(WARNING) << "In animation " + filename + ": Cannot find " + snd.name + " sound file " + snd.filename;
+                }
+
+                loaded_sounds.push_back(sound_effect_named(snd.name));
             }
         };
 
@@ -324,7 +714,7 @@ namespace splashkit_lib
             {
                 result->frames[j].index        = j;
                 result->frames[j].cell_index   = rows[j].cell;
-                result->frames[j].sound        = rows[j].snd;
+                result->frames[j].sound        = rows[j].snd == -1 ? nullptr : loaded_sounds[rows[j].snd];
                 result->frames[j].duration     = rows[j].dur;
                 result->frames[j].movement     = rows[j].mvmt;
 
@@ -334,7 +724,7 @@ namespace splashkit_lib
                 if (next_idx == -1)
                 {
                     //The end of a list of frames = no next
-                    result->frames[j].next = nullptr;
+                    result->frames[j].next = -1;
                 }
                 else if ((next_idx < 0) or (next_idx >= result->frames.size()))
                 {
@@ -344,7 +734,7 @@ namespace splashkit_lib
                     return;
                 }
                 else
-                    result->frames[j].next = &result->frames[next_idx];
+                    result->frames[j].next = next_idx;
             }
 
             result->animations.resize(ids.size());
@@ -358,17 +748,17 @@ namespace splashkit_lib
             }
         };
 
-        auto sum_loop = [&](animation_frame *start)
+        auto sum_loop = [&](int start)
         {
-            animation_frame *current;
+            int current;
 
-            float sum = start->duration;
-            current = start->next;
+            float sum = result->frames[start].duration;
+            current = result->frames[start].next;
 
-            while ((current != start) and (current))
+            while ((current != start) and (current != -1))
             {
-                sum += current->duration;
-                current = current->next;
+                sum += result->frames[current].duration;
+                current = result->frames[current].next;
             }
 
             return sum;
@@ -379,7 +769,7 @@ namespace splashkit_lib
         {
             int i;
             bool done;
-            animation_frame *current;
+            int current;
 
             done = true;
 
@@ -400,69 +790,61 @@ namespace splashkit_lib
             // Check through each animation looking for a loop
             for (i = 0; i < result->animations.size(); i++)
             {
-                current = &result->frames[result->animations[i]];
+                current = result->animations[i];
 
                 if (sum_loop(current) == 0)
                 {
                     free_animation_script(result);
-                    LOG(WARNING) << "Error in animation " + filename + ". Animation contains a loop with duration 0 starting at cell " + to_string(current->index);
+                    result = nullptr;
+                    LOG(WARNING) << "Error in animation " + filename + ". Animation contains a loop with duration 0 starting at cell " + to_string(current);
                     return;
                 }
             }
         };
 
-        auto verify_version = [&]()
+        // Record the length of the loop each frame is part of, so time based
+        // updates can skip whole loops at once
+        auto find_cycles = [&]()
         {
-            if (input.eof()) return false;
-            line = "";
+            if (!result) return;
 
-            while ((line.length() == 0) or (line.substr(0,2) == "//"))
-            {
-                getline(input, line);
-                line = trim(line);
-            }
+            int frame_count = static_cast<int>(result->frames.size());
 
-            //Verify that the line has the right version
-            if ((line != "SwinGame Animation #v1") and (line != "SplashKit Animation"))
+            for (int i = 0; i < frame_count; i++)
             {
-                LOG(WARNING) << "Error in animation " + filename + ". Animation files must start with 'SplashKit Animation'";
-                return false;
-            }
-
-            return true;
-        };
+                animation_frame &start = result->frames[i];
+                float sum = start.duration;
+                int count = 1;
+                int current = start.next;
 
-        line_no = 0;
-        max_id = -1;
-        rows.resize(0);
-        result = nullptr;
-
-        if (not verify_version())
-        {
-            LOG(WARNING) << "Error loading animation script: " + path;
-            return nullptr;
-        }
-
-
-        while (getline(input, line))
-        {
-            line_no = line_no + 1;
-
-            line = trim(line);
-            if (line.length() == 0) continue;  //skip empty lines
-            if (line.substr(0,2) == "//") continue; //skip lines starting with //
+                while (current != i and current != -1 and count <= frame_count)
+                {
+                    sum += result->frames[current].duration;
+                    count++;
+                    current = result->frames[current].next;
+                }
 
-            process_line();
-        }
+                start.cycle_duration = current == i ? sum : 0;
+                start.cycle_frames = current == i ? count : 0;
+            }
+        };
 
+        load_sounds();
         build_frame_lists();
         check_animation_loops();
+        find_cycles();
 
-        _animation_scripts[name] = result;
+        if (result) _animation_scripts[name] = result;
 
+        delete source;
         return result;
     }
 
+    animation_script load_animation_script(const string &name, const string &filename)
+    {
+        return finish_animation_script(prepare_animation_script(name, filename));
+    }
+
     animation_script animation_script_named(const string &name)
     {
         if (has_animation_script(name))
@@ -520,16 +902,45 @@ namespace splashkit_lib
         }
     }
 
+    void _add_animation(animation_script script, animation ani)
+    {
+        ani->script = script;
+        ani->slot = static_cast<int>(script->anim_objs.size());
+
+        script->anim_objs.push_back(ani);
+        script->anim_current.push_back(-1);
+        script->anim_last.push_back(-1);
+        script->anim_time.push_back(0);
+        script->anim_entered.push_back(false);
+        script->anim_skipped.push_back(0);
+    }
+
     void _remove_animation(animation_script script, animation ani)
     {
-        auto it = std::find(script->anim_objs.begin(), script->anim_objs.end(), ani);
+        int slot = ani->slot;
 
-        if (it != script->anim_objs.end())
+        if (slot >= 0 and slot < script->anim_objs.size() and script->anim_objs[slot] == ani)
         {
-            using std::swap;
+            // Move the last animation into the gap, so the state stays packed
+            int last = static_cast<int>(script->anim_objs.size()) - 1;
+
+            script->anim_objs[slot] = script->anim_objs[last];
+            script->anim_current[slot] = script->anim_current[last];
+            script->anim_last[slot] = script->anim_last[last];
+            script->anim_time[slot] = script->anim_time[last];
+            script->anim_entered[slot] = script->anim_entered[last];
+            script->anim_skipped[slot] = script->anim_skipped[last];
+            script->anim_objs[slot]->slot = slot;
 
-            swap(*it, script->anim_objs.back());
             script->anim_objs.pop_back();
+            script->anim_current.pop_back();
+            script->anim_last.pop_back();
+            script->anim_time.pop_back();
+            script->anim_entered.pop_back();
+            script->anim_skipped.pop_back();
+
+            ani->script = nullptr;
+            ani->slot = -1;
         }
         else
             LOG(WARNING) << "Could not remove animation! " + animation_script_name(script);
@@ -541,7 +952,8 @@ namespace splashkit_lib
         {
             notify_of_free(ani);
 
-            _remove_animation(ani->script, ani);
+            if (ani->script)
+                _remove_animation(ani->script, ani);
             ani->id = NONE_PTR;
 
             delete(ani); //ani may have been overridden by last call...
@@ -570,9 +982,9 @@ namespace splashkit_lib
         if (not VALID_PTR(anim, ANIMATION_PTR))
             return 0; //no animation - return the first frame
         else if (not animation_ended(anim))
-            return anim->current_frame->cell_index;
-        else if (anim->last_frame)
-            return anim->last_frame->cell_index; //Use the last frame drawn.
+            return anim->script->frames[anim->script->anim_current[anim->slot]].cell_index;
+        else if (anim->script and anim->script->anim_last[anim->slot] != -1)
+            return anim->script->frames[anim->script->anim_last[anim->slot]].cell_index; //Use the last frame drawn.
         else
             return -1;
     }
@@ -585,14 +997,14 @@ namespace splashkit_lib
         }
 
         if ( ! animation_ended(anim) )
-            return anim->current_frame->movement;
+            return anim->script->frames[anim->script->anim_current[anim->slot]].movement;
         else
             return vector_to(0,0);
     }
 
     bool animation_ended(animation anim)
     {
-        return (not VALID_PTR(anim, ANIMATION_PTR)) || (anim->current_frame == nullptr);
+        return (not VALID_PTR(anim, ANIMATION_PTR)) || (not anim->script) || (anim->script->anim_current[anim->slot] == -1);
     }
 
     bool animation_entered_frame(animation anim)
@@ -603,7 +1015,9 @@ namespace splashkit_lib
             return false;
         }
 
-        return anim->entered_frame;
+        if ( not anim->script ) return false;
+
+        return anim->script->anim_entered[anim->slot];
     }
 
     float animation_frame_time(animation anim)
@@ -614,7 +1028,9 @@ namespace splashkit_lib
             return 0;
         }
 
-        return anim->frame_time;
+        if ( not anim->script ) return 0;
+
+        return anim->script->anim_time[anim->slot];
     }
 
     bool has_animation_named(animation_script script, const string &name)
@@ -704,10 +1120,10 @@ namespace splashkit_lib
         {
             if (anim->script)
                 _remove_animation(anim->script, anim);   // remove from old script
-            script->anim_objs.push_back(anim);       // add to new script
+            _add_animation(script, anim);            // add to new script
         }
 
-        anim->first_frame        = &script->frames[script->animations[idx]];
+        anim->first_frame        = script->animations[idx];
         anim->animation_name     = animation_name(script, idx);
         restart_animation(anim, with_sound);
     }
@@ -759,15 +1175,10 @@ namespace splashkit_lib
         result = new(_animation_data);
 
         result->id = ANIMATION_PTR;
-        result->current_frame = nullptr;
-        result->last_frame = nullptr;
-        result->first_frame = nullptr;
-        result->entered_frame = false;
+        result->first_frame = -1;
         result->animation_name = animation_name(script, idx);
-        result->script = script;
-        result->frame_time = 0;
 
-        script->anim_objs.push_back(result);
+        _add_animation(script, result);
 
         assign_animation(result, script, idx, with_sound);
 
@@ -812,13 +1223,17 @@ namespace splashkit_lib
             return;
         }
 
-        anim->current_frame  = anim->first_frame;
-        anim->last_frame     = anim->first_frame;
-        anim->frame_time     = 0;
-        anim->entered_frame  = true;
+        animation_script script = anim->script;
+        if ( not script ) return;
 
-        if (with_sound and ASSIGNED(anim->current_frame) and ASSIGNED(anim->current_frame->sound))
-            play_sound_effect(anim->current_frame->sound);
+        script->anim_current[anim->slot]    = anim->first_frame;
+        script->anim_last[anim->slot]       = anim->first_frame;
+        script->anim_time[anim->slot]       = 0;
+        script->anim_entered[anim->slot]    = true;
+        script->anim_skipped[anim->slot]    = 0;
+
+        if (with_sound and anim->first_frame != -1 and ASSIGNED(script->frames[anim->first_frame].sound))
+            queue_sound_effect(script->frames[anim->first_frame].sound, 1.0f);
     }
 
     void update_animation(animation anim)
@@ -831,31 +1246,172 @@ namespace splashkit_lib
         update_animation(anim, pct, true);
     }
 
+    // Advance the animation in the indicated slot of the script, returning
+    // true if it moved into a new frame
+    static inline bool _advance_animation(animation_script script, int slot, float pct, bool with_sound)
+    {
+        int current = script->anim_current[slot];
+        const animation_frame &frame = script->frames[current];
+
+        float frame_time = script->anim_time[slot] + pct;
+
+        if (frame_time >= frame.duration)
+        {
+            script->anim_time[slot] = frame_time - frame.duration;  //reduce the time
+            script->anim_last[slot] = current;                      //store last frame
+            script->anim_current[slot] = frame.next;                //get the next frame
+            script->anim_entered[slot] = true;
+            script->anim_skipped[slot] = 0;
+
+            if (frame.next != -1 and ASSIGNED(script->frames[frame.next].sound) and with_sound)
+            {
+                queue_sound_effect(script->frames[frame.next].sound, 1.0f);
+            }
+
+            return true;
+        }
+        else
+        {
+            script->anim_time[slot] = frame_time;
+            script->anim_entered[slot] = false;
+            script->anim_skipped[slot] = 0;
+            return false;
+        }
+    }
+
     void update_animation(animation anim, float pct, bool with_sound)
     {
         if (animation_ended(anim)) return;
 
-        anim->frame_time     = anim->frame_time + pct;
+        _advance_animation(anim->script, anim->slot, pct, with_sound);
+    }
+
+    // Advance the animation in the indicated slot of the script by a number
+    // of updates, moving through as many frames as that covers. Returns the
+    // number of frames entered.
+    static int _advance_animation_by_time(animation_script script, int slot, float updates, bool with_sound)
+    {
+        int current = script->anim_current[slot];
+        int last = script->anim_last[slot];
+        float frame_time = script->anim_time[slot] + updates;
+        int entered = 0;
+
+        // Each frame is visited at most once before a loop is skipped, so
+        // this cannot take more steps than there are frames
+        int steps = static_cast<int>(script->frames.size());
 
-        if (anim->frame_time >= anim->current_frame->duration)
+        while (current != -1 and frame_time >= script->frames[current].duration and steps-- >= 0)
         {
-            anim->frame_time = anim->frame_time - anim->current_frame->duration;    //reduce the time
-            anim->last_frame = anim->current_frame;                                 //store last frame
-            anim->current_frame = anim->current_frame->next;                        //get the next frame
+            const animation_frame &frame = script->frames[current];
 
-            //if assigned(anim^.currentFrame) then
-            //WriteLn('Frame ', HexStr(anim^.currentFrame), ' Vector ', PointToString(anim^.currentFrame^.movement));
+            // Skip all of the whole trips around a loop at once. A long pause
+            // can cover more frames than an int holds, so the count stops at
+            // INT_MAX.
+            if (frame.cycle_duration > 0 and frame_time >= frame.cycle_duration)
+            {
+                double loop_frames = floor(frame_time / frame.cycle_duration) * static_cast<double>(frame.cycle_frames);
+                frame_time = fmod(frame_time, frame.cycle_duration);
+                entered = static_cast<int>(MIN(static_cast<double>(INT_MAX), entered + loop_frames));
+                continue;
+            }
+
+            frame_time -= frame.duration;
+            last = current;
+            current = frame.next;
+            if (entered < INT_MAX) entered++;
+        }
 
-            if (ASSIGNED(anim->current_frame) and ASSIGNED(anim->current_frame->sound) and with_sound)
+        script->anim_current[slot] = current;
+        script->anim_last[slot] = last;
+        script->anim_time[slot] = frame_time;
+        script->anim_entered[slot] = entered > 0;
+        script->anim_skipped[slot] = MAX(0, entered - 1);
+
+        // Only the frame the animation ended up in plays its sound
+        if (entered > 0 and current != -1 and with_sound and ASSIGNED(script->frames[current].sound))
+        {
+            queue_sound_effect(script->frames[current].sound, 1.0f);
+        }
+
+        return entered;
+    }
+
+    void update_animation_by_time(animation anim, float seconds)
+    {
+        update_animation_by_time(anim, seconds, true);
+    }
+
+    void update_animation_by_time(animation anim, float seconds, bool with_sound)
+    {
+        if (animation_ended(anim)) return;
+
+        _advance_animation_by_time(anim->script, anim->slot, seconds * ANIMATION_UPDATES_PER_SECOND, with_sound);
+    }
+
+    void update_all_animations_by_time(float seconds)
+    {
+        float updates = seconds * ANIMATION_UPDATES_PER_SECOND;
+
+        for (auto &kv : _animation_scripts)
+        {
+            animation_script script = kv.second;
+
+            for (int slot = 0; slot < script->anim_current.size(); slot++)
             {
-                play_sound_effect(anim->current_frame->sound);
+                if (script->anim_current[slot] != -1)
+                    _advance_animation_by_time(script, slot, updates, true);
             }
+        }
+    }
 
-            anim->entered_frame  = true;
+    int animation_skipped_frames(animation anim)
+    {
+        if ( INVALID_PTR(anim, ANIMATION_PTR))
+        {
+            LOG(WARNING) << "Attempting to get skipped frames with invalid animation data.";
+            return 0;
         }
-        else
+
+        if ( not anim->script ) return 0;
+
+        return anim->script->anim_skipped[anim->slot];
+    }
+
+    void update_all_animations(float pct)
+    {
+        for (auto &kv : _animation_scripts)
         {
-            anim->entered_frame  = false;
+            animation_script script = kv.second;
+
+            for (int slot = 0; slot < script->anim_current.size(); slot++)
+            {
+                if (script->anim_current[slot] != -1)
+                    _advance_animation(script, slot, pct, true);
+            }
+        }
+    }
+
+    void update_all_animations(float pct, vector<animation> &entered, vector<animation> &ended)
+    {
+        entered.clear();
+        ended.clear();
+
+        for (auto &kv : _animation_scripts)
+        {
+            animation_script script = kv.second;
+
+            for (int slot = 0; slot < script->anim_current.size(); slot++)
+            {
+                if (script->anim_current[slot] == -1) continue;
+
+                if (_advance_animation(script, slot, pct, true))
+                {
+                    if (script->anim_current[slot] == -1)
+                        ended.push_back(script->anim_objs[slot]);
+                    else
+                        entered.push_back(script->anim_objs[slot]);
+                }
+            }
         }
     }
 }
@@ -15,12 +15,15 @@
 #include "drawing_options.h"
 
 #include <string>
+#include <vector>
 using namespace std;
 
 namespace splashkit_lib
 {
     /**
-     * Load animation details from an animation frames file.
+     * Load animation details from an animation frames file. When a cache
+     * folder has been set with `set_animation_cache_path`, loading a script
+     * may also write a compiled copy of it into that folder.
      *
      * @param name          The name of the `animation_script`.
      * @param filename      The file to load the `animation_script` from.
@@ -32,6 +35,19 @@ namespace splashkit_lib
      */
     animation_script load_animation_script(const string &name, const string &filename);
 
+    /**
+     * Sets the folder used to cache compiled animation scripts. While a
+     * folder is set, loading a script from a file writes a compiled copy of
+     * it there, and later loads of the unchanged script read this copy
+     * rather than the text. Scripts are not cached until a folder is set,
+     * and setting an empty path turns the cache off. The folder must
+     * already exist.
+     *
+     * @param path  The folder to store compiled scripts in, or an empty
+     *              string to stop caching scripts
+     */
+    void set_animation_cache_path(const string &path);
+
     /**
      * Frees loaded animation frames data. Use this when you will no
      * longer be using the animation for any purpose, including within
@@ -448,6 +464,91 @@ namespace splashkit_lib
      * @param with_sound    Denotes whether the `animation` should play audio.
      */
     void update_animation(animation anim, float pct, bool with_sound);
+
+    /**
+     * Updates the animation by the time that has passed, moving through as
+     * many frames as that time covers. Frame durations in animation scripts
+     * count updates, and 60 updates are treated as one second. Whole trips
+     * around a looping animation are skipped at once, so a long pause does
+     * not take long to catch up. Only the frame the animation ends up in
+     * plays its sound.
+     *
+     * @param anim          The `animation` to update.
+     * @param seconds       The time that has passed, in seconds
+     *
+     * @attribute class     animation
+     * @attribute method    update_by_time
+     * @attribute self      anim
+     */
+    void update_animation_by_time(animation anim, float seconds);
+
+    /**
+     * Updates the animation by the time that has passed, moving through as
+     * many frames as that time covers. Only the frame the animation ends up
+     * in plays its sound.
+     *
+     * @param anim          The `animation` to update.
+     * @param seconds       The time that has passed, in seconds
+     * @param with_sound    Denotes whether the `animation` should play audio.
+     *
+     * @attribute class     animation
+     * @attribute method    update_by_time
+     * @attribute self      anim
+     */
+    void update_animation_by_time(animation anim, float seconds, bool with_sound);
+
+    /**
+     * Returns the number of frames the animation passed over without them
+     * being shown in its last update. This is only above 0 when a time based
+     * update covers more than one frame.
+     *
+     * @param anim          The `animation` to check.
+     * @returns             The number of frames skipped in the last update.
+     *
+     * @attribute class     animation
+     * @attribute getter    skipped_frames
+     * @attribute self      anim
+     */
+    int animation_skipped_frames(animation anim);
+
+    /**
+     * Updates every animation that has not ended, in the same way as calling
+     * `update_animation` on each. Animations are visited script by script,
+     * so this is much faster than updating a large number of animations one
+     * at a time. Do not use this with animations that are also updated by
+     * their sprites, or they will advance twice.
+     *
+     * @param pct           The amount that the frame time will be incremented
+     *
+     * @attribute static    animations
+     * @attribute method    update_all
+     */
+    void update_all_animations(float pct);
+
+    /**
+     * Updates every animation that has not ended, and reports which
+     * animations moved to a new frame and which ended during the update.
+     *
+     * @param pct           The amount that the frame time will be incremented
+     * @param entered       Filled with the animations that entered a new frame
+     * @param ended         Filled with the animations that ended
+     *
+     * @attribute static    animations
+     * @attribute method    update_all
+     * @attribute suffix    with_changes
+     */
+    void update_all_animations(float pct, vector<animation> &entered, vector<animation> &ended);
+
+    /**
+     * Updates every animation that has not ended by the time that has
+     * passed, in the same way as calling `update_animation_by_time` on each.
+     *
+     * @param seconds       The time that has passed, in seconds
+     *
+     * @attribute static    animations
+     * @attribute method    update_all_by_time
+     */
+    void update_all_animations_by_time(float seconds);
 }
 
 #endif /* animations_h */
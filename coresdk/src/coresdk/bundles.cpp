@@ -15,11 +15,19 @@
 #include "timers.h"
 #include "text.h"
 #include "audio.h"
+#include "core_driver.h"
+#include "concurrency_utils.h"
+#include "archive_driver.h"
 
 #include <map>
 #include <vector>
 #include <iostream>
 #include <fstream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <set>
+#include <sstream>
 namespace splashkit_lib
 {
     struct bundled_resource
@@ -33,16 +41,75 @@ namespace splashkit_lib
         string                      name;
         string                      filename;
         vector<bundled_resource>    resources;
+        sk_archive                  archive;    // the archive the bundle was read from, or nullptr
     };
 
     static map<string, resource_bundle> _resource_bundles;
 
+    // The number of bundles using each open archive. Music streams from the
+    // archive as it plays, so the archive stays open until its bundles are freed.
+    static map<sk_archive, int> _archive_users;
+
+    // The name of the entry holding the bundle text in a resource archive
+    #define ARCHIVE_BUNDLE_ENTRY "bundle"
+
+    // Default time spent each frame finishing resources for bundles that are
+    // loading asynchronously, in milliseconds
+    #define BUNDLE_UPLOAD_BUDGET_MS 4.0f
+
+    // The most worker threads used to load one bundle
+    #define BUNDLE_LOADER_THREADS 4
+
+    // A resource read from a line of a bundle file
+    struct bundle_item
+    {
+        resource_kind   kind;
+        string          name;
+        string          path;
+
+        bool            has_cells;
+        int             cell_details[5];    // width, height, columns, rows and count
+
+        const char *    data;               // the file's contents within an archive, or nullptr
+        size_t          size;
+
+        bool            was_prepared;       // prepared on a worker thread...
+        void *          prepared;           // ... giving this, or nullptr if it failed
+        bool            finished;
+    };
+
+    // A bundle being loaded asynchronously. Workers prepare the items, reading
+    // and decoding their files, and put their index in the prepared channel.
+    // The main thread then takes them and finishes them within its budget.
+    struct bundle_loader
+    {
+        string                  name;
+        vector<bundle_item>     items;
+        vector<int>             work;           // indexes of the items workers need to prepare
+        vector<string>          child_bundles;  // nested bundles, loading alongside this one
+        vector<thread>          workers;
+
+        atomic<int>             next_work;
+        atomic<bool>            cancelled;
+        channel<int>            prepared;
+
+        int                     finished;
+        resource_bundle         result;
+    };
+
+    static map<string, bundle_loader *> _bundle_loaders;
+    static float _bundle_upload_budget = BUNDLE_UPLOAD_BUDGET_MS;
 
     bool has_resource_bundle(const string &name)
     {
         return _resource_bundles.count(name) > 0;
     }
 
+    bool resource_bundle_loading(const string &name)
+    {
+        return _bundle_loaders.count(name) > 0;
+    }
+
     resource_kind string_to_resource_kind(const string &txt)
     {
         string kind = txt;
@@ -58,126 +125,619 @@ namespace splashkit_lib
         else return OTHER_RESOURCE;
     }
 
-    void load_resource_bundle(const string &name, const string &filename)
+    static void _retain_archive(sk_archive archive)
+    {
+        if ( archive ) _archive_users[archive]++;
+    }
+
+    static void _release_archive(sk_archive archive)
     {
-        if ( has_resource_bundle(name) )
+        if ( archive and --_archive_users[archive] == 0 )
         {
-            LOG(WARNING) << "Attempting to load resource bundle twice.";
-            return;
+            _archive_users.erase(archive);
+            sk_close_archive(archive);
+        }
+    }
+
+    // The name of a resource's entry in an archive. Each kind of resource is
+    // kept in its own folder, as in the Resources folder.
+    static string _archive_entry_name(resource_kind kind, const string &filename)
+    {
+        switch ( kind )
+        {
+            case BUNDLE_RESOURCE:       return "bundles/" + filename;
+            case IMAGE_RESOURCE:        return "images/" + filename;
+            case SOUND_RESOURCE:        return "sounds/" + filename;
+            case MUSIC_RESOURCE:        return "sounds/" + filename;
+            case ANIMATION_RESOURCE:    return "animations/" + filename;
+            default:                    return filename;
         }
+    }
 
-        string path = path_to_resource(filename, BUNDLE_RESOURCE);
+    // Read the items from the bundle file, returning false if the file cannot
+    // be found. The bundle is read from archive if it contains the bundle,
+    // otherwise from the file, which may itself be an archive. Archive is
+    // updated to the archive the bundle was read from, or nullptr.
+    static bool _read_bundle_file(const string &name, const string &filename, sk_archive &archive, vector<bundle_item> &items)
+    {
+        const char *data;
+        size_t size;
 
-        if ( ! file_exists(path) )
+        if ( not sk_archive_entry(archive, _archive_entry_name(BUNDLE_RESOURCE, filename), data, size) )
         {
-            LOG(WARNING) << cat({ "Unable to locate bundle file for ", name, " (", path, ")"});
-            return;
+            string path = path_to_resource(filename, BUNDLE_RESOURCE);
+            archive = nullptr;
+
+            if ( ! file_exists(path) )
+            {
+                LOG(WARNING) << cat({ "Unable to locate bundle file for ", name, " (", path, ")"});
+                return false;
+            }
+
+            if ( sk_is_archive(path) )
+            {
+                archive = sk_open_archive(path);
+
+                if ( not sk_archive_entry(archive, ARCHIVE_BUNDLE_ENTRY, data, size) )
+                {
+                    LOG(WARNING) << cat({ "Unable to read resource archive for ", name, " (", path, ")"});
+                    sk_close_archive(archive);
+                    archive = nullptr;
+                    return false;
+                }
+            }
+            else
+            {
+                data = nullptr;
+                size = 0;
+            }
         }
 
         int line_no = 0;
         string line;
-        ifstream input(path);
+        ifstream file_input;
+        istringstream archive_input;
 
-        resource_bundle result;
+        if ( archive )
+            archive_input.str(string(data, size));
+        else
+            file_input.open(path_to_resource(filename, BUNDLE_RESOURCE));
+
+        istream &input = archive ? static_cast<istream &>(archive_input) : file_input;
 
-        // Called on load of each bitmap
-        auto rb_load_bitmap = [&](string line_name, string line_path)
+        // Called for each bitmap, to read its cell details
+        auto read_cells = [&](bundle_item &item)
         {
-            bitmap bmp = load_bitmap(line_name, line_path);
             int num_delim = count_delimiter(line, ',');
             if ( num_delim > 2 and num_delim != 7 )
             {
-                LOG(WARNING) << "Incorrect cell options for bitmap " + line_name + " at " + to_string(line_no) + " of bundle " + name;
+                LOG(WARNING) << "Incorrect cell options for bitmap " + item.name + " at " + to_string(line_no) + " of bundle " + name;
                 return;
             }
             else if ( num_delim == 2 ) return;
 
-            bitmap_set_cell_details(bmp,
-                                    str_to_int(extract_delimited(4, line, ',')),
-                                    str_to_int(extract_delimited(5, line, ',')),
-                                    str_to_int(extract_delimited(6, line, ',')),
-                                    str_to_int(extract_delimited(7, line, ',')),
-                                    str_to_int(extract_delimited(8, line, ',')));
+            item.has_cells = true;
+            for (int i = 0; i < 5; i++)
+            {
+                item.cell_details[i] = str_to_int(extract_delimited(4 + i, line, ','));
+            }
         };
 
         // Called for each line in the bundle text file
         auto process_line = [&]()
         {
-            resource_kind kind = string_to_resource_kind(extract_delimited(1, line, ','));
-            string line_name = trim(extract_delimited(2, line, ','));
-            string line_path = trim(extract_delimited(3, line, ','));
-
-
-            if ( kind == OTHER_RESOURCE )
+            bundle_item item;
+            item.kind = string_to_resource_kind(extract_delimited(1, line, ','));
+            item.name = trim(extract_delimited(2, line, ','));
+            item.path = trim(extract_delimited(3, line, ','));
+            item.has_cells = false;
+            item.data = nullptr;
+            item.size = 0;
+            item.was_prepared = false;
+            item.prepared = nullptr;
+            item.finished = false;
+
+            if ( item.kind == OTHER_RESOURCE )
             {
                 LOG(WARNING) << "Unknown resource type at line " + to_string(line_no) + " of bundle " + name;
                 return;
             }
 
-            if ( line_name.length() == 0 )
+            if ( item.name.length() == 0 )
             {
                 LOG(WARNING) << "Name missing for resource at line " + to_string(line_no) + " of bundle " + name;
                 return;
             }
 
-            if ( line_path.length() == 0 && kind != TIMER_RESOURCE )
+            if ( item.path.length() == 0 && item.kind != TIMER_RESOURCE )
             {
                 LOG(WARNING) << "Name missing for resource at line " + to_string(line_no) + " of bundle " + name;
                 return;
             }
 
-            switch ( kind )
+            if ( item.kind == IMAGE_RESOURCE ) read_cells(item);
+
+            // Files missing from the archive are loaded from the Resources folder
+            if ( item.kind == BUNDLE_RESOURCE or not sk_archive_entry(archive, _archive_entry_name(item.kind, item.path), item.data, item.size) )
             {
-                case BUNDLE_RESOURCE:
-                    load_resource_bundle(line_name, line_path);
+                item.data = nullptr;
+                item.size = 0;
+            }
+
+            items.push_back(item);
+        };
+
+        while (getline(input, line))
+        {
+            line_no = line_no + 1;
+
+            line = trim(line);
+            if (line.length() == 0) continue;  //skip empty lines
+            if (line.substr(0,2) == "//") continue; //skip lines starting with //
+
+            process_line();
+        }
+
+        return true;
+    }
+
+    // Read and decode the item's file. Called on a worker thread, so this
+    // must not touch the named resource maps.
+    static void _prepare_bundle_item(bundle_item &item)
+    {
+        switch ( item.kind )
+        {
+            case IMAGE_RESOURCE:
+                item.prepared = prepare_bitmap(item.name, item.path, item.data, item.size);
+                break;
+            case SOUND_RESOURCE:
+                item.prepared = prepare_sound_effect(item.name, item.path, item.data, item.size);
+                break;
+            case MUSIC_RESOURCE:
+                item.prepared = prepare_music(item.name, item.path, item.data, item.size);
+                break;
+            case ANIMATION_RESOURCE:
+                item.prepared = prepare_animation_script(item.name, item.path, item.data, item.size);
+                break;
+            default:
+                return;
+        }
+
+        item.was_prepared = true;
+    }
+
+    static void _load_resource_bundle(const string &name, const string &filename, sk_archive archive);
+
+    // Create the item's resource on the main thread, using what was prepared
+    // for it if it was prepared on a worker, and add it to the bundle.
+    static void _finish_bundle_item(bundle_item &item, resource_bundle &result)
+    {
+        bitmap bmp;
+
+        switch ( item.kind )
+        {
+            case BUNDLE_RESOURCE:
+                // Asynchronous bundles start loading their nested bundles up front
+                if ( not item.was_prepared and not has_resource_bundle(item.name) )
+                    _load_resource_bundle(item.name, item.path, result.archive);
+                break;
+            case TIMER_RESOURCE:
+                create_timer(item.name);
+                break;
+            case IMAGE_RESOURCE:
+                if ( item.was_prepared )
+                    bmp = finish_bitmap(static_cast<_bitmap_data *>(item.prepared));
+                else
+                    bmp = load_bitmap(item.name, item.path);
+
+                if ( item.has_cells )
+                {
+                    bitmap_set_cell_details(bmp,
+                                            item.cell_details[0],
+                                            item.cell_details[1],
+                                            item.cell_details[2],
+                                            item.cell_details[3],
+                                            item.cell_details[4]);
+                }
+                break;
+            case FONT_RESOURCE:
+                // Fonts share the font library, so are always loaded on the main thread
+                load_font(item.name, item.path);
+                break;
+            case SOUND_RESOURCE:
+                if ( item.was_prepared )
+                    finish_sound_effect(static_cast<_sound_data *>(item.prepared));
+                else
+                    load_sound_effect(item.name, item.path);
+                break;
+            case MUSIC_RESOURCE:
+                if ( item.was_prepared )
+                    finish_music(static_cast<_music_data *>(item.prepared));
+                else
+                    load_music(item.name, item.path);
+                break;
+            case ANIMATION_RESOURCE:
+                if ( item.was_prepared )
+                    finish_animation_script(static_cast<_animation_script_source *>(item.prepared));
+                else
+                    load_animation_script(item.name, item.path);
+                break;
+            default:
+                return;
+        }
+
+        item.prepared = nullptr;
+        item.finished = true;
+
+        bundled_resource br;
+        br.name = item.name;
+        br.kind = item.kind;
+
+        result.resources.push_back(br);
+    }
+
+    static void _load_resource_bundle(const string &name, const string &filename, sk_archive archive)
+    {
+        if ( has_resource_bundle(name) or resource_bundle_loading(name) )
+        {
+            LOG(WARNING) << "Attempting to load resource bundle twice.";
+            return;
+        }
+
+        vector<bundle_item> items;
+        if ( not _read_bundle_file(name, filename, archive, items) ) return;
+
+        resource_bundle result;
+        result.name = name;
+        result.filename = filename;
+        result.archive = archive;
+        _retain_archive(archive);
+
+        // Decode the bundle's image files together, over several threads.
+        // Each is then found by name as the items are finished below.
+        vector<string> image_names, image_paths;
+        for (bundle_item &item : items)
+        {
+            if ( item.kind == IMAGE_RESOURCE and not item.data )
+            {
+                image_names.push_back(item.name);
+                image_paths.push_back(item.path);
+            }
+        }
+        if ( image_names.size() > 1 ) load_bitmaps(image_names, image_paths);
+
+        for (bundle_item &item : items)
+        {
+            // Files from an archive are decoded from memory
+            if ( item.data ) _prepare_bundle_item(item);
+            _finish_bundle_item(item, result);
+        }
+
+        _resource_bundles[name] = result;
+    }
+
+    void load_resource_bundle(const string &name, const string &filename)
+    {
+        _load_resource_bundle(name, filename, nullptr);
+    }
+
+    static void _bundle_loader_worker(bundle_loader *loader)
+    {
+        int idx;
+
+        while ( not loader->cancelled and (idx = loader->next_work++) < static_cast<int>(loader->work.size()) )
+        {
+            _prepare_bundle_item(loader->items[loader->work[idx]]);
+            loader->prepared.put(loader->work[idx]);
+        }
+    }
+
+    static void _load_resource_bundle_async(const string &name, const string &filename, sk_archive archive)
+    {
+        if ( has_resource_bundle(name) or resource_bundle_loading(name) )
+        {
+            LOG(WARNING) << "Attempting to load resource bundle twice.";
+            return;
+        }
+
+        // Initialise the audio and image libraries here, rather than on a worker
+        internal_sk_init();
+
+        bundle_loader *loader = new bundle_loader();
+        loader->name = name;
+        loader->next_work = 0;
+        loader->cancelled = false;
+        loader->finished = 0;
+        loader->result.name = name;
+        loader->result.filename = filename;
+
+        // Register the loader first, so a bundle that includes itself is caught
+        _bundle_loaders[name] = loader;
+
+        if ( not _read_bundle_file(name, filename, archive, loader->items) )
+        {
+            _bundle_loaders.erase(name);
+            delete loader;
+            return;
+        }
+
+        loader->result.archive = archive;
+        _retain_archive(archive);
+
+        for (int i = 0; i < static_cast<int>(loader->items.size()); i++)
+        {
+            bundle_item &item = loader->items[i];
+
+            switch ( item.kind )
+            {
+                case IMAGE_RESOURCE:
+                case SOUND_RESOURCE:
+                case MUSIC_RESOURCE:
+                case ANIMATION_RESOURCE:
+                    loader->work.push_back(i);
                     break;
-                case TIMER_RESOURCE:
-                    create_timer(line_name);
+                case BUNDLE_RESOURCE:
+                    if ( not has_resource_bundle(item.name) and not resource_bundle_loading(item.name) )
+                    {
+                        _load_resource_bundle_async(item.name, item.path, archive);
+                        if ( resource_bundle_loading(item.name) )
+                            loader->child_bundles.push_back(item.name);
+                    }
+                    item.was_prepared = true;
+                    loader->prepared.put(i);
                     break;
-                case IMAGE_RESOURCE:
-                    rb_load_bitmap(line_name, line_path);
+                default:
+                    // Nothing to read ahead of time, so these are finished
+                    // straight away on the main thread
+                    loader->prepared.put(i);
                     break;
-                case FONT_RESOURCE:
-                    load_font(line_name, line_path);
+            }
+        }
+
+        int threads = min(BUNDLE_LOADER_THREADS, parallel_part_count(static_cast<int>(loader->work.size()), 1));
+        for (int i = 0; i < threads and not loader->work.empty(); i++)
+        {
+            loader->workers.emplace_back(_bundle_loader_worker, loader);
+        }
+    }
+
+    void load_resource_bundle_async(const string &name, const string &filename)
+    {
+        _load_resource_bundle_async(name, filename, nullptr);
+    }
+
+    // Move the loader's bundle to the loaded bundles, once its workers are done
+    static void _complete_bundle_loader(bundle_loader *loader)
+    {
+        for (thread &worker : loader->workers)
+        {
+            worker.join();
+        }
+
+        _resource_bundles[loader->name] = loader->result;
+        _bundle_loaders.erase(loader->name);
+        delete loader;
+    }
+
+    // Stop loading the bundle, keeping the resources that are ready so they
+    // can be freed with the bundle
+    static void _cancel_bundle_loader(bundle_loader *loader)
+    {
+        int idx;
+
+        loader->cancelled = true;
+        for (thread &worker : loader->workers)
+        {
+            worker.join();
+        }
+        loader->workers.clear();
+
+        while ( loader->prepared.try_take(idx) )
+        {
+            _finish_bundle_item(loader->items[idx], loader->result);
+        }
+
+        // Record the nested bundles, so they are stopped and freed too
+        for (bundle_item &item : loader->items)
+        {
+            if ( item.kind == BUNDLE_RESOURCE and not item.finished )
+                _finish_bundle_item(item, loader->result);
+        }
+
+        _complete_bundle_loader(loader);
+    }
+
+    static bool _bundle_loader_done(bundle_loader *loader)
+    {
+        if ( loader->finished < static_cast<int>(loader->items.size()) ) return false;
+
+        for (const string &child : loader->child_bundles)
+        {
+            if ( resource_bundle_loading(child) ) return false;
+        }
+
+        return true;
+    }
+
+    void update_resource_bundle_loading()
+    {
+        if ( _bundle_loaders.empty() ) return;
+
+        auto start = chrono::steady_clock::now();
+        auto elapsed_ms = [&]()
+        {
+            return chrono::duration<float, milli>(chrono::steady_clock::now() - start).count();
+        };
+
+        // Finish prepared resources until the budget is spent, always
+        // finishing at least one so loading cannot stall
+        bool first = true;
+        int idx;
+
+        for (auto &kv : _bundle_loaders)
+        {
+            bundle_loader *loader = kv.second;
+
+            while ( (first or elapsed_ms() < _bundle_upload_budget) and loader->prepared.try_take(idx) )
+            {
+                _finish_bundle_item(loader->items[idx], loader->result);
+                loader->finished++;
+                first = false;
+            }
+        }
+
+        // Complete the bundles that are done. Nested bundles complete first,
+        // so check again after each one.
+        bool completed;
+        do
+        {
+            completed = false;
+            for (auto &kv : _bundle_loaders)
+            {
+                if ( _bundle_loader_done(kv.second) )
+                {
+                    _complete_bundle_loader(kv.second);
+                    completed = true;
                     break;
+                }
+            }
+        } while ( completed );
+    }
+
+    // Count the resources finished and the total in the bundle, and in the
+    // bundles it includes
+    static void _bundle_progress(const string &name, int &done, int &total)
+    {
+        if ( resource_bundle_loading(name) )
+        {
+            bundle_loader *loader = _bundle_loaders[name];
+            done += loader->finished;
+            total += static_cast<int>(loader->items.size());
+
+            for (const string &child : loader->child_bundles)
+            {
+                _bundle_progress(child, done, total);
+            }
+        }
+        else if ( has_resource_bundle(name) )
+        {
+            for (const bundled_resource &br : _resource_bundles[name].resources)
+            {
+                if ( br.kind == BUNDLE_RESOURCE and br.name != name ) _bundle_progress(br.name, done, total);
+                done++;
+                total++;
+            }
+        }
+    }
+
+    float resource_bundle_load_progress(const string &name)
+    {
+        int done = 0, total = 0;
+
+        if ( has_resource_bundle(name) ) return 1.0f;
+        if ( not resource_bundle_loading(name) ) return 0.0f;
+
+        _bundle_progress(name, done, total);
+
+        return total == 0 ? 1.0f : static_cast<float>(done) / total;
+    }
+
+    float resource_bundle_upload_budget()
+    {
+        return _bundle_upload_budget;
+    }
+
+    void set_resource_bundle_upload_budget(float milliseconds)
+    {
+        _bundle_upload_budget = milliseconds < 0 ? 0 : milliseconds;
+    }
+
+    // Add the bundle file and the files it uses to the archive entries,
+    // along with the bundles it includes
+    static bool _add_bundle_to_archive(const string &filename, const string &entry_name, set<string> &added, vector<string> &names, vector<string> &files)
+    {
+        vector<bundle_item> items;
+        sk_archive archive = nullptr;
+
+        if ( not _read_bundle_file(filename, filename, archive, items) ) return false;
+
+        if ( archive )
+        {
+            LOG(WARNING) << "Bundle " + filename + " is already a resource archive";
+            sk_close_archive(archive);
+            return false;
+        }
+
+        added.insert(entry_name);
+        names.push_back(entry_name);
+        files.push_back(path_to_resource(filename, BUNDLE_RESOURCE));
+
+        for (const bundle_item &item : items)
+        {
+            string entry = _archive_entry_name(item.kind, item.path);
+            string file_path;
+
+            if ( added.count(entry) > 0 ) continue;
+
+            switch ( item.kind )
+            {
+                case BUNDLE_RESOURCE:
+                    // Bundles that cannot be packed are reported, and loaded from their file
+                    _add_bundle_to_archive(item.path, entry, added, names, files);
+                    continue;
+                case IMAGE_RESOURCE:
                 case SOUND_RESOURCE:
-                    load_sound_effect(line_name, line_path);
-                    break;
                 case MUSIC_RESOURCE:
-                    load_music(line_name, line_path);
+                    // Find the file the same way the resource is loaded
+                    file_path = file_exists(item.path) ? item.path : path_to_resource(item.path, item.kind);
                     break;
                 case ANIMATION_RESOURCE:
-                    load_animation_script(line_name, line_path);
+                    file_path = path_to_resource(item.path, ANIMATION_RESOURCE);
                     break;
                 default:
-                    return;
+                    // Fonts reopen their file for each size, so are not packed
+                    continue;
             }
 
-            bundled_resource br;
-            br.name = line_name;
-            br.kind = kind;
+            if ( not file_exists(file_path) )
+            {
+                LOG(WARNING) << "Unable to locate file for " + item.name + " (" + file_path + ") in bundle " + filename;
+                continue;
+            }
 
-            result.resources.push_back(br);
+            added.insert(entry);
+            names.push_back(entry);
+            files.push_back(file_path);
+        }
 
-            return;
-        };
+        return true;
+    }
 
-        while (getline(input, line))
-        {
-            line_no = line_no + 1;
+    bool create_resource_archive(const string &filename, const string &archive_filename)
+    {
+        set<string> added;
+        vector<string> names, files;
 
-            line = trim(line);
-            if (line.length() == 0) continue;  //skip empty lines
-            if (line.substr(0,2) == "//") continue; //skip lines starting with //
+        if ( not _add_bundle_to_archive(filename, ARCHIVE_BUNDLE_ENTRY, added, names, files) ) return false;
 
-            process_line();
+        string path = path_to_resource(archive_filename, BUNDLE_RESOURCE);
+
+        if ( not sk_write_archive(path, names, files) )
+        {
+            LOG(WARNING) << "Unable to write resource archive " + path;
+            return false;
         }
 
-        _resource_bundles[name] = result;
+        return true;
     }
 
     void free_resource_bundle(const string name)
     {
+        if ( resource_bundle_loading(name) )
+        {
+            _cancel_bundle_loader(_bundle_loaders[name]);
+        }
+
         if ( ! has_resource_bundle(name) )
         {
             LOG(WARNING) << "Attempting to free unloaded resource bundle named " + name;
@@ -215,14 +775,22 @@ namespace splashkit_lib
                     free_animation_script(animation_script_named(br.name));
                     break;
                 default:
-                    return;
+                    break;
             }
         }
+
+        _release_archive(bndl.archive);
     }
 
     void free_all_resource_bundles()
     {
-        for (unsigned long i = _resource_bundles.size(); i > 0 ; i--)
+        while ( not _bundle_loaders.empty() )
+        {
+            _cancel_bundle_loader(_bundle_loaders.begin()->second);
+        }
+
+        // Freeing a bundle also frees the bundles it includes
+        while ( not _resource_bundles.empty() )
         {
             free_resource_bundle(_resource_bundles.begin()->first);
         }
@@ -85,11 +85,93 @@ namespace splashkit_lib
      *
      *    BUNDLE,another bundle,another.txt
      *
+     * The filename can also be a resource archive made with
+     * `create_resource_archive`, which is loaded in the same way.
+     *
      * @param name      The name of the bundle when it is loaded.
      * @param filename  The filename to load.
      */
     void load_resource_bundle(const string &name, const string &filename);
 
+    /**
+     * Pack a resource bundle, and the files it loads, into a single resource
+     * archive. The archive is saved in the **bundles** folder of your
+     * Resources, and can be passed to `load_resource_bundle` in place of the
+     * bundle. Loading from an archive opens one file rather than one file
+     * for each resource, which is much faster on slow or network drives.
+     *
+     * Bundles included in the bundle are packed into the same archive. Fonts
+     * are not packed, and are still loaded from the **fonts** folder, as are
+     * any sounds used by animations.
+     *
+     * @param filename          The filename of the bundle to pack.
+     * @param archive_filename  The filename of the archive to create.
+     * @returns                 True if the archive was created.
+     */
+    bool create_resource_archive(const string &filename, const string &archive_filename);
+
+    /**
+     * Starts loading the resources in the resource bundle without waiting
+     * for them, so you can show a loading screen while the bundle loads. The
+     * bundle uses the same format as `load_resource_bundle`.
+     *
+     * Worker threads read and decode the bitmaps, sounds, music and
+     * animations. The resources are then created each time the screen is
+     * refreshed, using at most the time set by
+     * `set_resource_bundle_upload_budget` each frame. Use
+     * `resource_bundle_load_progress` to see how far the load has progressed.
+     * Once the load is complete `has_resource_bundle` returns true, and the
+     * resources can be used.
+     *
+     * @param name      The name of the bundle when it is loaded.
+     * @param filename  The filename to load.
+     */
+    void load_resource_bundle_async(const string &name, const string &filename);
+
+    /**
+     * Returns true while the named resource bundle is loading asynchronously.
+     *
+     * @param name  The name of the resource bundle.
+     * @returns     True when the bundle has started loading, but is not
+     *              yet complete.
+     */
+    bool resource_bundle_loading(const string &name);
+
+    /**
+     * Returns how much of the named resource bundle has been loaded, including
+     * any bundles it includes.
+     *
+     * @param name  The name of the resource bundle.
+     * @returns     A value from 0 to 1, which is 1 once the bundle is loaded
+     *              and 0 for bundles that are not loading.
+     */
+    float resource_bundle_load_progress(const string &name);
+
+    /**
+     * Create the resources that worker threads have prepared for the resource
+     * bundles that are loading asynchronously, for up to the upload budget.
+     * This is called for you when you refresh the screen.
+     */
+    void update_resource_bundle_loading();
+
+    /**
+     * Returns the time each frame can spend creating the resources of bundles
+     * that are loading asynchronously.
+     *
+     * @returns The budget, in milliseconds.
+     */
+    float resource_bundle_upload_budget();
+
+    /**
+     * Sets the time each frame can spend creating the resources of bundles
+     * that are loading asynchronously. At least one resource is created each
+     * frame, so loading always continues. Larger budgets load bundles sooner,
+     * but can make frames take longer. The default is 4 milliseconds.
+     *
+     * @param milliseconds  The budget, in milliseconds.
+     */
+    void set_resource_bundle_upload_budget(float milliseconds);
+
     /**
      * Returns true when the named resource bundle has already been loaded.
      *
@@ -101,7 +183,8 @@ namespace splashkit_lib
     /**
      * When you are finished with the resources in a bundle, you can free them all
      * by calling this procedure. It will free the resource bundle and all of the
-     * associated resources.
+     * associated resources. Bundles that are still loading stop loading, and
+     * the resources they have loaded are freed.
      *
      * @param name  The name of the resource bundle to be freed
      */
@@ -11,8 +11,9 @@
 #include "sprites.h"
 #include "utility_functions.h"
 
+#include <algorithm>
 #include <cmath>
-#include <functional>
+#include <cstdint>
 
 #include "graphics.h"
 #include "utils.h"
@@ -20,125 +21,854 @@ namespace splashkit_lib
 {
     //#define DEBUG_STEP
 
-    // Step over pixels in the two areas based on the supplied matrix
+    // Cells larger than this (in either direction) are scanned using the
+    // coarse levels of their collision masks
+    #define COLLISION_BLOCK_THRESHOLD 32
+
+    // How far (in pixels) collision polygons may be from the pixel outline
+    #define COLLISION_POLYGON_TOLERANCE 1.0
+
+    // Narrow the range [lo, hi] of steps along a row so that pos + step * i
+    // remains within (-1, limit) on one of B's axes. Positions are truncated
+    // toward zero, so those between -1 and 0 fall on B's first pixel.
+    static inline void _clip_row_span(double pos, double step, double limit, double &lo, double &hi)
+    {
+        if ( step == 0 )
+        {
+            if ( pos <= -1 or pos >= limit ) hi = lo - 1; // never inside
+            return;
+        }
+
+        double t1 = (-1 - pos) / step;
+        double t2 = (limit - pos) / step;
+
+        lo = MAX(lo, MIN(t1, t2));
+        hi = MIN(hi, MAX(t1, t2));
+    }
+
+    // How pixels in A's local space map into B's local space
+    struct _pixel_steps
+    {
+        vector_2d origin;   // The top left corner of A in B's local space
+        vector_2d step_x;   // Movement in B for one pixel along A's x axis
+        vector_2d step_y;   // Movement in B for one pixel along A's y axis
+    };
+
+    static _pixel_steps _pixel_steps_between(const matrix_2d &matrix_a, const matrix_2d &matrix_b)
+    {
+        _pixel_steps result;
+
+        // Calculate a matrix which transforms from A's local space into
+        // world space and then into B's local space
+        matrix_2d transform_a_to_b = matrix_multiply(matrix_a, matrix_inverse(matrix_b));
+
+        // Calculate the top left corner of A in B's local space
+        result.origin = matrix_multiply(transform_a_to_b, vector_to(0,0));
+
+        // When a point moves in A's local space, it moves in B's local space with a
+        // fixed direction and distance proportional to the movement in A.
+        // This algorithm steps through A one pixel at a time along A's X and Y axes
+        // Calculate the analogous steps in B:
+        result.step_x = vector_subtract(matrix_multiply(transform_a_to_b, vector_to(1, 0)), result.origin);
+        result.step_y = vector_subtract(matrix_multiply(transform_a_to_b, vector_to(0, 1)), result.origin); // y inverted for drawing
+
+        return result;
+    }
+
+    // Step over the pixels of A in the area [x0, x1) x [y0, y1), calling
+    // end_fn with (x_a, y_a, x_b, y_b) for each one that falls within B.
+    // Stepping ends when end_fn returns true.
+    //
+    // Positions in B are tracked in 16.16 fixed point, and end_fn is a
+    // template parameter so that per pixel tests are inlined.
+    template <typename end_fn_type>
+    bool _step_through_pixel_area(const _pixel_steps &steps, int x0, int y0, int x1, int y1, int w_b, int h_b, end_fn_type end_fn)
+    {
+        const double FIXED_ONE = 65536.0;
+        const int32_t fixed_step_x = lround(steps.step_x.x * FIXED_ONE);
+        const int32_t fixed_step_y = lround(steps.step_x.y * FIXED_ONE);
+
+        // For each row of pixels in A
+        for (int y_a = y0; y_a < y1; y_a++)
+        {
+            // The start of this row in B. This is calculated for each row so
+            // that fixed point rounding does not build up down the bitmap.
+            double row_x = steps.origin.x + y_a * steps.step_y.x;
+            double row_y = steps.origin.y + y_a * steps.step_y.y;
+
+            // Work out the span of this row that can fall within B. This
+            // is padded by a pixel either side to allow for rounding, with
+            // the bounds check below still testing each pixel.
+            double lo = x0, hi = x1;
+            _clip_row_span(row_x, steps.step_x.x, w_b, lo, hi);
+            _clip_row_span(row_y, steps.step_x.y, h_b, lo, hi);
+
+            int start = MAX(x0, static_cast<int>(floor(lo)) - 1);
+            int end = MIN(x1, static_cast<int>(ceil(hi)) + 1);
+
+            if ( start >= end ) continue;
+
+            int32_t fixed_x = lround((row_x + start * steps.step_x.x) * FIXED_ONE);
+            int32_t fixed_y = lround((row_y + start * steps.step_x.y) * FIXED_ONE);
+
+            // For each pixel in this row
+            for (int x_a = start; x_a < end; x_a++)
+            {
+                // Truncate to the pixel in B (division rounds toward zero)
+                int x_b = fixed_x / 65536;
+                int y_b = fixed_y / 65536;
+
+                // If the pixel lies within the bounds of B
+                if  ( (0 <= x_b) and (x_b < w_b) and (0 <= y_b) and (y_b < h_b) )
+                {
+                    if ( end_fn(x_a, y_a, x_b, y_b) )
+                    {
+                        return true;
+                    }
+                }
+
+                // Move to the next pixel in the row
+                fixed_x += fixed_step_x;
+                fixed_y += fixed_step_y;
+            }
+        }
+
+        // No intersection found
+        return false;
+    }
+
+    // Step over pixels in the two areas based on the supplied matrix. The
+    // smaller area is scanned, and end_fn is called with (x1, y1, x2, y2)
+    // for each pair of overlapping pixels.
     //
     // See http://www.austincc.edu/cchrist1/GAME1343/TransformedCollision/TransformedCollision.htm
+    template <typename end_fn_type>
     bool _step_through_pixels (
                                float w1, float h1,
                                const matrix_2d &matrix1,
                                float w2, float h2,
                                const matrix_2d &matrix2,
-                               function<bool(int, int, int, int)> end_fn )
+                               end_fn_type end_fn )
     {
-        bool a_is_1;
-        double h_a, w_a;
-        double h_b, w_b;
-        matrix_2d transform_a_to_b;
-
         // Determine the smaller area to step through.
         if ( w1 * h1 <= w2 * h2 ) // use bitmap 1 as the one to scan
         {
-            a_is_1 = true;
-            h_a = h1;
-            w_a = w1;
+            return _step_through_pixel_area(_pixel_steps_between(matrix1, matrix2), 0, 0, w1, h1, w2, h2, end_fn);
+        }
+        else // use bitmap 2
+        {
+            return _step_through_pixel_area(_pixel_steps_between(matrix2, matrix1), 0, 0, w2, h2, w1, h1,
+                                            [&] (int x2, int y2, int x1, int y1)
+                                            {
+                                                return end_fn(x1, y1, x2, y2);
+                                            });
+        }
+    }
+
+    // The area of a bitmap's collision mask covered by one of its cells.
+    // The cell is clipped to the bitmap, so all locations within it can
+    // be read from the mask.
+    struct _mask_cell
+    {
+        const uint64_t *mask;
+        int words_per_row;
+        const _collision_mask_level *levels;    // Coarse levels, if available
+        int x, y;   // Location of the cell in the mask
+        int w, h;   // Size of the cell
+    };
+
+    static _mask_cell _mask_cell_of(bitmap bmp, int cell)
+    {
+        _mask_cell result;
+        vector_2d offset = bitmap_cell_offset(bmp, cell);
+
+        result.mask = bmp->pixel_mask;
+        result.words_per_row = bmp->mask_words_per_row;
+        result.levels = bmp->mask_levels;
+        result.x = offset.x;
+        result.y = offset.y;
+        result.w = MAX(0, MIN(bmp->cell_w, bmp->image.surface.width - result.x));
+        result.h = MAX(0, MIN(bmp->cell_h, bmp->image.surface.height - result.y));
+
+        return result;
+    }
+
+    // Is there a pixel set at x, y (relative to the cell) in the collision mask?
+    static inline bool _mask_pixel(const _mask_cell &c, int x, int y)
+    {
+        x += c.x;
+        y += c.y;
+        return ( c.mask[y * c.words_per_row + (x >> 6)] >> (x & 63) ) & 1;
+    }
+
+    // Does any block in the given level of the mask have a pixel set within
+    // the area [x0, x1) x [y0, y1) of the cell?
+    static bool _mask_area_occupied(const _mask_cell &c, int level, int x0, int y0, int x1, int y1)
+    {
+        const _collision_mask_level &lvl = c.levels[level];
+
+        int bx0 = (c.x + x0) / lvl.block_size;
+        int bx1 = (c.x + x1 - 1) / lvl.block_size;
+        int by0 = (c.y + y0) / lvl.block_size;
+        int by1 = (c.y + y1 - 1) / lvl.block_size;
 
-            h_b = h2;
-            w_b = w2;
+        for (int by = by0; by <= by1; by++)
+        {
+            const uint64_t *row = lvl.blocks + by * lvl.words_per_row;
 
-            // Calculate a matrix which transforms from 1's local space into
-            // world space and then into 2's local space
-            transform_a_to_b = matrix_multiply(matrix1, matrix_inverse(matrix2));
+            for (int bx = bx0; bx <= bx1; bx++)
+            {
+                if ( (row[bx >> 6] >> (bx & 63)) & 1 ) return true;
+            }
         }
-        else // use bitmap 2
+
+        return false;
+    }
+
+    // Could pixels in the area [x0, x1) x [y0, y1) of A collide with B,
+    // based on the given level of the two masks?
+    static bool _mask_blocks_may_collide(const _mask_cell &a, const _mask_cell &b, const _pixel_steps &steps, int level, int x0, int y0, int x1, int y1)
+    {
+        if ( not _mask_area_occupied(a, level, x0, y0, x1, y1) ) return false;
+
+        // Find the bounds of the area in B, padded by a pixel for rounding
+        double min_x, max_x, min_y, max_y;
+        double ex = steps.origin.x + x0 * steps.step_x.x + y0 * steps.step_y.x;
+        double ey = steps.origin.y + x0 * steps.step_x.y + y0 * steps.step_y.y;
+        double wx = (x1 - x0) * steps.step_x.x, wy = (x1 - x0) * steps.step_x.y;
+        double hx = (y1 - y0) * steps.step_y.x, hy = (y1 - y0) * steps.step_y.y;
+
+        min_x = ex + MIN(0, wx) + MIN(0, hx);
+        max_x = ex + MAX(0, wx) + MAX(0, hx);
+        min_y = ey + MIN(0, wy) + MIN(0, hy);
+        max_y = ey + MAX(0, wy) + MAX(0, hy);
+
+        int bx0 = MAX(0, static_cast<int>(floor(min_x)) - 1);
+        int bx1 = MIN(b.w, static_cast<int>(ceil(max_x)) + 1);
+        int by0 = MAX(0, static_cast<int>(floor(min_y)) - 1);
+        int by1 = MIN(b.h, static_cast<int>(ceil(max_y)) + 1);
+
+        if ( bx0 >= bx1 or by0 >= by1 ) return false;
+
+        return _mask_area_occupied(b, level, bx0, by0, bx1, by1);
+    }
+
+    // Pixel collision for transformed bitmap cells, using the coarse mask
+    // levels to skip the blocks of A that cannot collide with B. Only
+    // blocks that are occupied in both masks are stepped through.
+    bool _collision_within_bitmap_mask_blocks(const _mask_cell &a, const matrix_2d &matrix_a, const _mask_cell &b, const matrix_2d &matrix_b)
+    {
+        _pixel_steps steps = _pixel_steps_between(matrix_a, matrix_b);
+
+        const int coarse = a.levels[1].block_size;
+        const int fine = a.levels[0].block_size;
+
+        for (int ty = 0; ty < a.h; ty += coarse)
         {
-            a_is_1 = false;
-            h_a = h2;
-            w_a = w2;
+            for (int tx = 0; tx < a.w; tx += coarse)
+            {
+                int tx1 = MIN(tx + coarse, a.w), ty1 = MIN(ty + coarse, a.h);
 
-            h_b = h1;
-            w_b = w1;
+                if ( not _mask_blocks_may_collide(a, b, steps, 1, tx, ty, tx1, ty1) ) continue;
 
-            // Calculate a matrix which transforms from 1's local space into
-            // world space and then into 2's local space
-            transform_a_to_b = matrix_multiply(matrix2, matrix_inverse(matrix1));
+                for (int y = ty; y < ty1; y += fine)
+                {
+                    for (int x = tx; x < tx1; x += fine)
+                    {
+                        int x1 = MIN(x + fine, tx1), y1 = MIN(y + fine, ty1);
+
+                        if ( not _mask_blocks_may_collide(a, b, steps, 0, x, y, x1, y1) ) continue;
+
+                        if ( _step_through_pixel_area(steps, x, y, x1, y1, b.w, b.h,
+                                                      [&] (int ax, int ay, int bx, int by)
+                                                      {
+                                                          return _mask_pixel(a, ax, ay) and _mask_pixel(b, bx, by);
+                                                      }) )
+                        {
+                            return true;
+                        }
+                    }
+                }
+            }
         }
 
-        vector_2d step_x, step_y, y_pos_in_b, pos_in_b;
+        return false;
+    }
 
-        // Calculate the top left corner of A in B's local space
-        // This variable will be reused to keep track of the start of each row
-        y_pos_in_b = matrix_multiply(transform_a_to_b, vector_to(0,0));
+    // Is the matrix only a translation (no rotation or scaling)?
+    static inline bool _is_translation_only(const matrix_2d &m)
+    {
+        return m.elements[0][0] == 1 and m.elements[0][1] == 0 and
+               m.elements[1][0] == 0 and m.elements[1][1] == 1;
+    }
 
-        // When a point moves in A's local space, it moves in B's local space with a
-        // fixed direction and distance proportional to the movement in A.
-        // This algorithm steps through A one pixel at a time along A's X and Y axes
-        // Calculate the analogous steps in B:
-        step_x = vector_subtract(matrix_multiply(transform_a_to_b, vector_to(1, 0)), y_pos_in_b);
-        step_y = vector_subtract(matrix_multiply(transform_a_to_b, vector_to(0, 1)), y_pos_in_b); // y inverted for drawing
+    // Read 64 bits from a row of a bitmap's collision mask, starting at pixel x.
+    // Bits past the end of the row are 0.
+    static inline uint64_t _mask_bits_at(const uint64_t *row, int words_per_row, int x)
+    {
+        int word = x >> 6;
+        int shift = x & 63;
+
+        uint64_t result = row[word] >> shift;
+        if ( shift and word + 1 < words_per_row )
+            result |= row[word + 1] << (64 - shift);
+
+        return result;
+    }
 
-        int x_b, y_b;
+    // Pixel collision for two unrotated and unscaled bitmap cells. This works
+    // directly on the packed collision masks, testing 64 pixels at a time
+    // across the rows where the two cells overlap.
+    //
+    // Pixels of cell 1 map into cell 2 as they do when stepping through
+    // pixels, truncating toward zero. When the offset is not whole, the
+    // column (and row) of cell 1 that starts just before cell 2 also maps
+    // onto cell 2's first column (and row).
+    bool _collision_within_translated_bitmap_masks(const _mask_cell &m1, const matrix_2d& matrix1, const _mask_cell &m2, const matrix_2d& matrix2)
+    {
+        if ( m1.w <= 0 or m1.h <= 0 or m2.w <= 0 or m2.h <= 0 ) return false;
+
+        // Offset of cell 1 in cell 2's space
+        double offset_x = matrix1.elements[0][2] - matrix2.elements[0][2];
+        double offset_y = matrix1.elements[1][2] - matrix2.elements[1][2];
+        int dx = floor(offset_x);
+        int dy = floor(offset_y);
+
+        // The column and row of cell 1 that truncate onto cell 2's first
+        // column and row, or -1 if there are none
+        int edge_x = ( dx < 0 and offset_x != dx and -dx - 1 < m1.w ) ? -dx - 1 : -1;
+        int edge_y = ( dy < 0 and offset_y != dy ) ? -dy - 1 : -1;
+
+        // Overlapping area in cell 1's space
+        int left = MAX(0, -dx);
+        int right = MIN(m1.w, m2.w - dx);
+        int top = edge_y >= 0 ? edge_y : MAX(0, -dy);
+        int bottom = MIN(m1.h, m2.h - dy);
 
-        // have to check all pixels of one bitmap
-        // For each row of pixels in A (the smaller)
-        for (int y_a = 0; y_a < h_a; y_a++)
+        if ( ( left >= right and edge_x < 0 ) or top >= bottom ) return false;
+
+        int x1 = m1.x + left;
+        int x2 = m2.x + left + dx;
+        int words1 = m1.words_per_row;
+        int words2 = m2.words_per_row;
+
+        for (int y = top; y < bottom; y++)
         {
-            pos_in_b = y_pos_in_b;
+            const uint64_t *row1 = m1.mask + (m1.y + y) * words1;
+            const uint64_t *row2 = m2.mask + (m2.y + MAX(0, y + dy)) * words2;
 
-            // For each pixel in this row
-            for (int x_a = 0; x_a < w_a; x_a++)
+            if ( edge_x >= 0 and ( _mask_bits_at(row1, words1, m1.x + edge_x) & _mask_bits_at(row2, words2, m2.x) & 1 ) )
             {
-                // Calculate this pixel's location in B
-                // positionInB = transform_a_to_b * vector_to(xA, yA);
+                return true;
+            }
 
-                // Round to the nearest pixel
-                x_b = trunc(pos_in_b.x);
-                y_b = trunc(pos_in_b.y);
+            for (int x = 0; x < right - left; x += 64)
+            {
+                int count = right - left - x;
+                uint64_t in_range = count >= 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
 
-                // If the pixel lies within the bounds of B
-                if  ( (0 <= x_b) and (x_b < w_b) and (0 <= y_b) and (y_b < h_b) )
+                if ( _mask_bits_at(row1, words1, x1 + x) & _mask_bits_at(row2, words2, x2 + x) & in_range )
                 {
-                    if ( ( a_is_1 and end_fn(x_a, y_a, x_b, y_b) )
-                        or ( (not a_is_1) and end_fn(x_b, y_b, x_a, y_a)) )
+                    return true;
+                }
+            }
+        }
+
+        return false;
+    }
+
+    // If the bitmap has pre-rotated collision masks, and the matrix only
+    // rotates and translates, get the mask at the nearest rotation and the
+    // translation that places it.
+    static bool _rotated_mask_cell(bitmap bmp, int cell, const matrix_2d &matrix, _mask_cell &result, matrix_2d &translation)
+    {
+        int steps = bmp->rotated_mask_steps;
+        if ( steps <= 0 ) return false;
+
+        double c = matrix.elements[0][0];
+        double s = matrix.elements[1][0];
+
+        if ( fabs(matrix.elements[1][1] - c) > 0.0001 or fabs(matrix.elements[0][1] + s) > 0.0001 or fabs(c * c + s * s - 1) > 0.001 )
+            return false;
+
+        int step = static_cast<int>(lround(rad_to_deg(atan2(s, c)) * steps / 360.0)) % steps;
+        if ( step < 0 ) step += steps;
+        if ( cell < 0 or cell >= bmp->cell_count ) cell = 0;
+
+        const _rotated_collision_mask &rotated = bmp->rotated_masks[cell * steps + step];
+
+        result.mask = rotated.pixel_mask;
+        result.words_per_row = rotated.words_per_row;
+        result.levels = nullptr;
+        result.x = 0;
+        result.y = 0;
+        result.w = rotated.width;
+        result.h = rotated.height;
+
+        translation = translation_matrix(matrix.elements[0][2] + rotated.offset_x, matrix.elements[1][2] + rotated.offset_y);
+        return true;
+    }
+
+    bool _collision_within_bitmap_images_with_translation(bitmap bmp1, int c1, const matrix_2d& matrix1, bitmap bmp2, int c2, const matrix_2d& matrix2)
+    {
+        if ( INVALID_PTR(bmp1, BITMAP_PTR) or INVALID_PTR(bmp2, BITMAP_PTR) ) return false;
+        if ( not ensure_collision_mask(bmp1) or not ensure_collision_mask(bmp2) ) return false;
+
+        _mask_cell m1 = _mask_cell_of(bmp1, c1);
+        _mask_cell m2 = _mask_cell_of(bmp2, c2);
+
+#if !DEBUG_STEP
+        // Where both cells are only translated, or are rotated and have
+        // pre-rotated masks, the masks can be compared row by row
+        _mask_cell r1 = m1, r2 = m2;
+        matrix_2d t1 = matrix1, t2 = matrix2;
+
+        if ( ( _is_translation_only(matrix1) or _rotated_mask_cell(bmp1, c1, matrix1, r1, t1) ) and
+             ( _is_translation_only(matrix2) or _rotated_mask_cell(bmp2, c2, matrix2, r2, t2) ) )
+        {
+            // Map from the smaller cell into the larger, as the pixel stepping does
+            if ( r1.w * r1.h <= r2.w * r2.h )
+                return _collision_within_translated_bitmap_masks(r1, t1, r2, t2);
+            else
+                return _collision_within_translated_bitmap_masks(r2, t2, r1, t1);
+        }
+
+        // Use the coarse mask levels when scanning more than a single block
+        if ( m1.w * m1.h <= m2.w * m2.h )
+        {
+            if ( m1.w > COLLISION_BLOCK_THRESHOLD or m1.h > COLLISION_BLOCK_THRESHOLD )
+                return _collision_within_bitmap_mask_blocks(m1, matrix1, m2, matrix2);
+        }
+        else if ( m2.w > COLLISION_BLOCK_THRESHOLD or m2.h > COLLISION_BLOCK_THRESHOLD )
+        {
+            return _collision_within_bitmap_mask_blocks(m2, matrix2, m1, matrix1);
+        }
+#endif
+
+        return _step_through_pixels(m1.w, m1.h, matrix1,
+                                    m2.w, m2.h, matrix2,
+                                    [&] (int ax, int ay, int bx, int by)
+                                    {
+#if DEBUG_STEP
+                                        point_2d apt, bpt;
+                                        apt = matrix_multiply(matrix1, point_at(ax,ay));
+                                        if ( pixel_drawn_at_point(bmp1, c1, ax, ay) )
+                                            draw_circle(COLOR_RED, apt.x, apt.y, 3);
+                                        bpt = matrix_multiply(matrix2, point_at(bx,by));
+                                        if ( pixel_drawn_at_point(bmp2, c2, bx, by) )
+                                            draw_circle(COLOR_PINK, bpt.x, bpt.y, 2);
+
+                                        if ( pixel_drawn_at_point(bmp1, c1, ax, ay) and pixel_drawn_at_point(bmp2, c2, bx, by) )
+                                        {
+                                            fill_circle(COLOR_GREEN, apt.x, apt.y, 1);
+                                            fill_circle(COLOR_YELLOW, bpt.x, bpt.y, 3);
+                                        }
+#endif
+                                        return _mask_pixel(m1, ax, ay) and _mask_pixel(m2, bx, by);
+                                    });
+    }
+
+    //
+    // Polygon collision shapes
+    //
+
+    // Twice the signed area of the triangle a, b, c. This is positive when
+    // the points turn in the direction used by the collision polygons.
+    static inline double _turn(const point_2d &a, const point_2d &b, const point_2d &c)
+    {
+        return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+    }
+
+    // Trace the outline of a connected area of pixels with marching squares,
+    // starting from the area's top left pixel. Vertices are at pixel corners
+    // and the set pixels are kept on the left of each edge.
+    static vector<point_2d> _trace_outline(int w, int h, const vector<int> &labels, int label, int start_x, int start_y)
+    {
+        enum { NO_STEP, STEP_UP, STEP_DOWN, STEP_LEFT, STEP_RIGHT } step = NO_STEP, prev;
+
+        auto inside = [&] (int x, int y)
+        {
+            return x >= 0 and x < w and y >= 0 and y < h and labels[y * w + x] == label;
+        };
+
+        vector<point_2d> result;
+        int x = start_x, y = start_y;
+        int steps_left = 4 * (w + 1) * (h + 1);
+
+        do
+        {
+            int state = (inside(x - 1, y - 1) ? 1 : 0) | (inside(x, y - 1) ? 2 : 0) |
+                        (inside(x - 1, y) ? 4 : 0)     | (inside(x, y) ? 8 : 0);
+
+            prev = step;
+            switch (state)
+            {
+                case 1: case 5: case 13:    step = STEP_UP; break;
+                case 2: case 3: case 7:     step = STEP_RIGHT; break;
+                case 4: case 12: case 14:   step = STEP_LEFT; break;
+                case 8: case 10: case 11:   step = STEP_DOWN; break;
+                case 6:                     step = prev == STEP_UP ? STEP_LEFT : STEP_RIGHT; break;
+                case 9:                     step = prev == STEP_RIGHT ? STEP_UP : STEP_DOWN; break;
+                default:                    return result;
+            }
+
+            // Only keep the corners of the outline
+            if ( step != prev ) result.push_back(point_at(x, y));
+
+            switch (step)
+            {
+                case STEP_UP:       y--; break;
+                case STEP_DOWN:     y++; break;
+                case STEP_LEFT:     x--; break;
+                default:            x++; break;
+            }
+        } while ( (x != start_x or y != start_y) and --steps_left > 0 );
+
+        return result;
+    }
+
+    // Mark the points to keep from pts[first] to pts[last] using the
+    // Douglas-Peucker algorithm.
+    static void _simplify_outline(const vector<point_2d> &pts, int first, int last, double tolerance, vector<bool> &keep)
+    {
+        if ( last - first < 2 ) return;
+
+        const point_2d &a = pts[first];
+        const point_2d &b = pts[last % pts.size()];
+        double len = sqrt((b.x - a.x) * (b.x - a.x) + (b.y - a.y) * (b.y - a.y));
+
+        int furthest = -1;
+        double max_dist = tolerance;
+
+        for (int i = first + 1; i < last; i++)
+        {
+            const point_2d &p = pts[i];
+            double dist = len > 0 ? fabs(_turn(a, b, p)) / len : sqrt((p.x - a.x) * (p.x - a.x) + (p.y - a.y) * (p.y - a.y));
+
+            if ( dist > max_dist )
+            {
+                max_dist = dist;
+                furthest = i;
+            }
+        }
+
+        if ( furthest < 0 ) return;
+
+        keep[furthest] = true;
+        _simplify_outline(pts, first, furthest, tolerance, keep);
+        _simplify_outline(pts, furthest, last, tolerance, keep);
+    }
+
+    // Simplify a closed outline, keeping points that are more than tolerance
+    // from the simplified edges.
+    static vector<point_2d> _simplified_outline(const vector<point_2d> &pts, double tolerance)
+    {
+        int n = pts.size();
+        if ( n <= 3 ) return pts;
+
+        // Split the loop at the point furthest from the first point
+        int split = 1;
+        for (int i = 2; i < n; i++)
+        {
+            if ( point_point_distance(pts[0], pts[i]) > point_point_distance(pts[0], pts[split]) )
+                split = i;
+        }
+
+        vector<bool> keep(n, false);
+        keep[0] = true;
+        keep[split] = true;
+        _simplify_outline(pts, 0, split, tolerance, keep);
+        _simplify_outline(pts, split, n, tolerance, keep);
+
+        vector<point_2d> result;
+        for (int i = 0; i < n; i++)
+        {
+            if ( keep[i] ) result.push_back(pts[i]);
+        }
+        return result;
+    }
+
+    // The convex hull of the points, using the monotone chain algorithm
+    static vector<point_2d> _convex_hull(vector<point_2d> pts)
+    {
+        sort(pts.begin(), pts.end(), [] (const point_2d &a, const point_2d &b)
+        {
+            return a.x < b.x or (a.x == b.x and a.y < b.y);
+        });
+
+        int n = pts.size(), k = 0;
+        if ( n < 3 ) return pts;
+
+        vector<point_2d> result(2 * n);
+        for (int i = 0; i < n; i++)
+        {
+            while ( k >= 2 and _turn(result[k - 2], result[k - 1], pts[i]) <= 0 ) k--;
+            result[k++] = pts[i];
+        }
+        for (int i = n - 2, lower = k + 1; i >= 0; i--)
+        {
+            while ( k >= lower and _turn(result[k - 2], result[k - 1], pts[i]) <= 0 ) k--;
+            result[k++] = pts[i];
+        }
+
+        result.resize(k - 1);
+        return result;
+    }
+
+    // Is the polygon convex, with all turns in the positive direction?
+    // Collinear points are removed from the polygon.
+    static bool _make_convex(vector<point_2d> &poly)
+    {
+        for (size_t i = 0; i < poly.size() and poly.size() > 3; )
+        {
+            size_t n = poly.size();
+            if ( fabs(_turn(poly[(i + n - 1) % n], poly[i], poly[(i + 1) % n])) < 0.000001 )
+                poly.erase(poly.begin() + i);
+            else
+                i++;
+        }
+
+        for (size_t i = 0, n = poly.size(); i < n; i++)
+        {
+            if ( _turn(poly[i], poly[(i + 1) % n], poly[(i + 2) % n]) < 0 ) return false;
+        }
+        return true;
+    }
+
+    // Split a simple polygon into triangles by clipping ears
+    static void _triangulate(vector<point_2d> poly, vector<vector<point_2d>> &result)
+    {
+        while ( poly.size() > 3 )
+        {
+            size_t n = poly.size();
+            bool clipped = false;
+
+            for (size_t i = 0; i < n and not clipped; i++)
+            {
+                const point_2d &a = poly[(i + n - 1) % n], &b = poly[i], &c = poly[(i + 1) % n];
+
+                if ( _turn(a, b, c) <= 0 ) continue;
+
+                // It is an ear if no other point is inside the triangle
+                bool ear = true;
+                for (size_t j = 0; j < n and ear; j++)
+                {
+                    const point_2d &p = poly[j];
+                    if ( j == i or j == (i + 1) % n or j == (i + n - 1) % n ) continue;
+                    if ( _turn(a, b, p) >= 0 and _turn(b, c, p) >= 0 and _turn(c, a, p) >= 0 ) ear = false;
+                }
+
+                if ( ear )
+                {
+                    result.push_back({ a, b, c });
+                    poly.erase(poly.begin() + i);
+                    clipped = true;
+                }
+            }
+
+            // Only happens if simplifying made the outline cross itself
+            if ( not clipped )
+            {
+                result.push_back(_convex_hull(poly));
+                return;
+            }
+        }
+
+        if ( poly.size() == 3 and _turn(poly[0], poly[1], poly[2]) > 0 )
+            result.push_back(poly);
+    }
+
+    // Merge neighbouring convex polygons where the result is still convex
+    static void _merge_convex_parts(vector<vector<point_2d>> &parts)
+    {
+        bool merged = true;
+
+        while ( merged )
+        {
+            merged = false;
+
+            for (size_t i = 0; i < parts.size() and not merged; i++)
+            {
+                for (size_t j = i + 1; j < parts.size() and not merged; j++)
+                {
+                    vector<point_2d> &a = parts[i], &b = parts[j];
+
+                    // Look for an edge p -> q in a that is q -> p in b
+                    for (size_t ai = 0; ai < a.size() and not merged; ai++)
                     {
-                        return true;
+                        const point_2d &p = a[ai], &q = a[(ai + 1) % a.size()];
+
+                        for (size_t bi = 0; bi < b.size(); bi++)
+                        {
+                            const point_2d &bq = b[bi], &bp = b[(bi + 1) % b.size()];
+                            if ( bq.x != q.x or bq.y != q.y or bp.x != p.x or bp.y != p.y ) continue;
+
+                            // Join a from q around to p, then b from after p around to before q
+                            vector<point_2d> joined;
+                            for (size_t k = 0; k < a.size(); k++)
+                                joined.push_back(a[(ai + 1 + k) % a.size()]);
+                            for (size_t k = 2; k < b.size(); k++)
+                                joined.push_back(b[(bi + k) % b.size()]);
+
+                            if ( _make_convex(joined) )
+                            {
+                                parts[i] = joined;
+                                parts.erase(parts.begin() + j);
+                                merged = true;
+                            }
+                            break;
+                        }
                     }
                 }
+            }
+        }
+    }
+
+    // Build the collision polygons for a cell from its collision mask. Each
+    // separate area of pixels is outlined, simplified, and then split into
+    // convex parts. Holes within an area are not included in the outline.
+    static void _build_collision_shape(bitmap bmp, int cell, _cell_collision_shape &shape)
+    {
+        shape.built = true;
+        shape.parts.clear();
+
+        if ( not ensure_collision_mask(bmp) ) return;
+
+        _mask_cell m = _mask_cell_of(bmp, cell);
+        int w = m.w, h = m.h;
+
+        // Label each connected area of set pixels
+        vector<int> labels(w * h, 0);
+        vector<int> pending;
+        int label_count = 0;
+
+        for (int y = 0; y < h; y++)
+        {
+            for (int x = 0; x < w; x++)
+            {
+                if ( labels[y * w + x] or not _mask_pixel(m, x, y) ) continue;
+
+                int label = ++label_count;
+                labels[y * w + x] = label;
+                pending.push_back(y * w + x);
+
+                while ( not pending.empty() )
+                {
+                    int idx = pending.back();
+                    pending.pop_back();
+
+                    int px = idx % w, py = idx / w;
+                    const int nx[4] = { px - 1, px + 1, px, px };
+                    const int ny[4] = { py, py, py - 1, py + 1 };
+
+                    for (int i = 0; i < 4; i++)
+                    {
+                        if ( nx[i] < 0 or nx[i] >= w or ny[i] < 0 or ny[i] >= h ) continue;
+                        if ( labels[ny[i] * w + nx[i]] or not _mask_pixel(m, nx[i], ny[i]) ) continue;
+
+                        labels[ny[i] * w + nx[i]] = label;
+                        pending.push_back(ny[i] * w + nx[i]);
+                    }
+                }
+
+                vector<point_2d> outline = _simplified_outline(_trace_outline(w, h, labels, label, x, y), COLLISION_POLYGON_TOLERANCE);
+
+                // Outlines keep pixels on their left, so turn in the negative
+                // direction on screen. Reverse them to give positive turns.
+                reverse(outline.begin(), outline.end());
+
+                vector<vector<point_2d>> parts;
+                _triangulate(outline, parts);
+                _merge_convex_parts(parts);
+
+                shape.parts.insert(shape.parts.end(), parts.begin(), parts.end());
+            }
+        }
+    }
+
+    // Get the collision polygons of a bitmap's cell, building them if needed
+    static const _cell_collision_shape &_collision_shape(bitmap bmp, int cell)
+    {
+        if ( cell < 0 or cell >= bmp->cell_count ) cell = 0;
+
+        if ( bmp->collision_shapes.size() != static_cast<size_t>(bmp->cell_count) )
+        {
+            bmp->collision_shapes.clear();
+            bmp->collision_shapes.resize(bmp->cell_count, { false, {} });
+        }
+
+        _cell_collision_shape &result = bmp->collision_shapes[cell];
+        if ( not result.built ) _build_collision_shape(bmp, cell, result);
+
+        return result;
+    }
+
+    // Transform the collision polygons into world space
+    static vector<vector<point_2d>> _collision_shape_in_world(const _cell_collision_shape &shape, const matrix_2d &matrix)
+    {
+        vector<vector<point_2d>> result(shape.parts.size());
+
+        for (size_t i = 0; i < shape.parts.size(); i++)
+        {
+            result[i].reserve(shape.parts[i].size());
+            for (const point_2d &pt : shape.parts[i])
+            {
+                result[i].push_back(matrix_multiply(matrix, pt));
+            }
+        }
+
+        return result;
+    }
+
+    static bool _collision_shapes_intersect(const vector<vector<point_2d>> &a, const vector<vector<point_2d>> &b)
+    {
+        for (const vector<point_2d> &part_a : a)
+        {
+            for (const vector<point_2d> &part_b : b)
+            {
+                if ( convex_polygons_intersect(part_a.data(), static_cast<int>(part_a.size()), part_b.data(), static_cast<int>(part_b.size())) ) return true;
+            }
+        }
+        return false;
+    }
 
-                // Move to the next pixel in the row
-                pos_in_b = vector_add(pos_in_b, step_x);
+    static bool _point_in_collision_shape(const point_2d &pt, const vector<vector<point_2d>> &shape)
+    {
+        for (const vector<point_2d> &part : shape)
+        {
+            bool left = true, right = true;
+
+            for (size_t i = 0, n = part.size(); i < n; i++)
+            {
+                double turn = _turn(part[i], part[(i + 1) % n], pt);
+                left = left and turn > 0;
+                right = right and turn < 0;
             }
 
-            // Move to the next row
-            y_pos_in_b = vector_add(y_pos_in_b, step_y);
+            if ( left or right ) return true;
         }
-
-        // No intersection found
         return false;
     }
 
-    bool _collision_within_bitmap_images_with_translation(bitmap bmp1, int c1, const matrix_2d& matrix1, bitmap bmp2, int c2, const matrix_2d& matrix2)
+    // The collision polygons of a sprite, in world space. This is also used
+    // to build the shapes of physics bodies.
+    vector<vector<point_2d>> _sprite_collision_shape(sprite s)
     {
-        return _step_through_pixels(bitmap_cell_width(bmp1), bitmap_cell_height(bmp1), matrix1,
-                                    bitmap_cell_width(bmp2), bitmap_cell_height(bmp2), matrix2,
-                                    [&] (int ax, int ay, int bx, int by)
-                                    {
-#if DEBUG_STEP
-                                        point_2d apt, bpt;
-                                        apt = matrix_multiply(matrix1, point_at(ax,ay));
-                                        if ( pixel_drawn_at_point(bmp1, c1, ax, ay) )
-                                            draw_circle(COLOR_RED, apt.x, apt.y, 3);
-                                        bpt = matrix_multiply(matrix2, point_at(bx,by));
-                                        if ( pixel_drawn_at_point(bmp2, c2, bx, by) )
-                                            draw_circle(COLOR_PINK, bpt.x, bpt.y, 2);
+        bitmap bmp = sprite_collision_bitmap(s);
 
-                                        if ( pixel_drawn_at_point(bmp1, c1, ax, ay) and pixel_drawn_at_point(bmp2, c2, bx, by) )
-                                        {
-                                            fill_circle(COLOR_GREEN, apt.x, apt.y, 1);
-                                            fill_circle(COLOR_YELLOW, bpt.x, bpt.y, 3);
-                                        }
-#endif
-                                        return pixel_drawn_at_point(bmp1, c1, ax, ay) and pixel_drawn_at_point(bmp2, c2, bx, by);
-                                    });
+        if ( INVALID_PTR(bmp, BITMAP_PTR) ) return {};
+
+        return _collision_shape_in_world(_collision_shape(bmp, sprite_current_cell(s)), sprite_location_matrix(s));
+    }
+
+    static vector<vector<point_2d>> _rectangle_shape(const rectangle &rect)
+    {
+        return { {
+            point_at(rect.x, rect.y),
+            point_at(rect.x, rect.y + rect.height),
+            point_at(rect.x + rect.width, rect.y + rect.height),
+            point_at(rect.x + rect.width, rect.y)
+        } };
     }
 
     bool bitmap_point_collision(bitmap bmp, int cell, const matrix_2d& translation, const point_2d& pt )
@@ -153,7 +883,11 @@ namespace splashkit_lib
             return false;
         }
 
-        return _step_through_pixels(1, 1, translation_matrix(pt.x, pt.y), bmp->cell_w, bmp->cell_h, translation, [&] (int ax, int ay, int bx, int by)
+        if ( not ensure_collision_mask(bmp) ) return false;
+
+        _mask_cell m = _mask_cell_of(bmp, cell);
+
+        return _step_through_pixels(1, 1, translation_matrix(pt.x, pt.y), m.w, m.h, translation, [&] (int ax, int ay, int bx, int by)
                                     {
 #if DEBUG_STEP
                                         point_2d bpt;
@@ -161,7 +895,7 @@ namespace splashkit_lib
                                         if ( pixel_drawn_at_point(bmp, cell, bx, by) )
                                             fill_rectangle(COLOR_PINK, bpt.x, bpt.y, translation.elements[0][0], translation.elements[1][1] );
 #endif
-                                        return pixel_drawn_at_point(bmp, cell, bx, by);
+                                        return _mask_pixel(m, bx, by);
                                     });
     }
 
@@ -187,16 +921,17 @@ namespace splashkit_lib
             return false;
         }
 
-        quad q1, q2;
+        quad q = quad_from(bitmap_cell_rectangle(bmp), translation);
+
+        if ( not quad_rectangle_intersect(q, rect) ) return false;
 
-        q1 = quad_from(bitmap_cell_rectangle(bmp), translation);
-        q2 = quad_from(rect);
+        if ( not ensure_collision_mask(bmp) ) return false;
 
-        if ( not quads_intersect(q1, q2) ) return false;
+        _mask_cell m = _mask_cell_of(bmp, cell);
 
-        return _step_through_pixels(rect.width, rect.height, translation_matrix(rect.x, rect.y), bmp->cell_w, bmp->cell_h, translation, [&] (int ax, int ay, int bx, int by)
+        return _step_through_pixels(rect.width, rect.height, translation_matrix(rect.x, rect.y), m.w, m.h, translation, [&] (int ax, int ay, int bx, int by)
                                     {
-                                        return pixel_drawn_at_point(bmp, cell, bx, by);
+                                        return _mask_pixel(m, bx, by);
                                     });
     }
 
@@ -241,6 +976,10 @@ namespace splashkit_lib
         {
             return false;
         }
+        else if (sprite_collision_kind(s) == POLYGON_COLLISIONS)
+        {
+            return _point_in_collision_shape(pt, _sprite_collision_shape(s));
+        }
         else if (bitmap_cell_count(sprite_collision_bitmap(s)) > 1)
         {
             return bitmap_point_collision(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), pt);
@@ -257,6 +996,11 @@ namespace splashkit_lib
         {
             return false;
         }
+
+        if (sprite_collision_kind(s) == POLYGON_COLLISIONS)
+        {
+            return _collision_shapes_intersect(_sprite_collision_shape(s), _rectangle_shape(rect));
+        }
         
         return bitmap_rectangle_collision(sprite_collision_bitmap(s), sprite_current_cell(s), sprite_location_matrix(s), rect);
     }
@@ -277,6 +1021,11 @@ namespace splashkit_lib
         {
             return sprite_rectangle_collision(s1, sprite_collision_rectangle(s2));
         }
+
+        if (sprite_collision_kind(s1) == POLYGON_COLLISIONS and sprite_collision_kind(s2) == POLYGON_COLLISIONS)
+        {
+            return _collision_shapes_intersect(_sprite_collision_shape(s1), _sprite_collision_shape(s2));
+        }
         
         return _collision_within_bitmap_images_with_translation (
                                                                  sprite_collision_bitmap(s1), sprite_current_cell(s1), sprite_location_matrix(s1),
@@ -317,4 +1066,524 @@ namespace splashkit_lib
         return bitmap_collision(bmp1, 0, translation_matrix(x1, y1), bmp2, 0, translation_matrix(x2, y2));
     }
 
-}
\ No newline at end of file
+    //
+    // Swept collisions
+    //
+
+    // In sprites
+    extern map<string, vector<sprite>> _sprite_packs;
+
+    // The shape of a sprite used when sweeping it, in world space
+    struct _sweep_shape
+    {
+        bool is_circle;
+        circle c;
+        vector<vector<point_2d>> parts;
+    };
+
+    static _sweep_shape _sprite_sweep_shape(sprite s)
+    {
+        _sweep_shape result;
+
+        result.is_circle = false;
+
+        switch ( sprite_collision_kind(s) )
+        {
+            case AABB_COLLISIONS:
+                result.parts = _rectangle_shape(sprite_collision_rectangle(s));
+                break;
+            case POLYGON_COLLISIONS:
+                result.parts = _sprite_collision_shape(s);
+                break;
+            default:
+                result.is_circle = true;
+                result.c = sprite_collision_circle(s);
+                break;
+        }
+
+        return result;
+    }
+
+    static inline double _dot(const vector_2d &v, double x, double y)
+    {
+        return v.x * x + v.y * y;
+    }
+
+    // Sweep a circle moving by d toward a circle that is not moving
+    static bool _sweep_circles(const circle &c1, const circle &c2, const vector_2d &d, double &time, vector_2d &normal)
+    {
+        double px = c1.center.x - c2.center.x, py = c1.center.y - c2.center.y;
+        double r = c1.radius + c2.radius;
+        double dist_sq = px * px + py * py;
+
+        if ( dist_sq < r * r )
+        {
+            double dist = sqrt(dist_sq);
+            time = 0;
+            normal = dist > 0 ? vector_to(px / dist, py / dist) : vector_to(0, -1);
+            return true;
+        }
+
+        double a = _dot(d, d.x, d.y), b = 2 * _dot(d, px, py), c = dist_sq - r * r;
+        double disc = b * b - 4 * a * c;
+
+        if ( a == 0 or disc < 0 ) return false;
+
+        double t = (-b - sqrt(disc)) / (2 * a);
+        if ( t < 0 or t > 1 ) return false;
+
+        time = t;
+        normal = vector_to((px + t * d.x) / r, (py + t * d.y) / r);
+        return true;
+    }
+
+    // Sweep a circle moving by d toward a convex polygon that is not moving.
+    // This casts the circle's centre against the polygon grown by the radius.
+    static bool _sweep_circle_polygon(const circle &c, const vector<point_2d> &poly, const vector_2d &d, double &time, vector_2d &normal)
+    {
+        size_t n = poly.size();
+        if ( n < 3 ) return false;
+
+        double r = c.radius;
+        double gx = 0, gy = 0;
+        for (const point_2d &p : poly)
+        {
+            gx += p.x / n;
+            gy += p.y / n;
+        }
+
+        // Already touching: push out from the closest edge
+        double best_dist = INFINITY;
+        vector_2d best_normal = vector_to(0, -1);
+        bool inside = true;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const point_2d &a = poly[i], &b = poly[(i + 1) % n];
+            double ex = b.x - a.x, ey = b.y - a.y;
+            double len = sqrt(ex * ex + ey * ey);
+            if ( len == 0 ) continue;
+
+            vector_2d out = vector_to(ey / len, -ex / len);
+            if ( _dot(out, a.x - gx, a.y - gy) < 0 ) out = vector_to(-out.x, -out.y);
+
+            double side = _dot(out, c.center.x - a.x, c.center.y - a.y);
+            if ( side > 0 ) inside = false;
+
+            double s = MAX(0.0, MIN(1.0, ((c.center.x - a.x) * ex + (c.center.y - a.y) * ey) / (len * len)));
+            double qx = c.center.x - (a.x + s * ex), qy = c.center.y - (a.y + s * ey);
+            double dist = sqrt(qx * qx + qy * qy);
+
+            if ( side < 0 ) dist = -side;   // inside, use the distance to the edge line
+            if ( dist < best_dist )
+            {
+                best_dist = dist;
+                best_normal = ( side > 0 and dist > 0 ) ? vector_to(qx / dist, qy / dist) : out;
+            }
+        }
+
+        if ( inside or best_dist < r )
+        {
+            time = 0;
+            normal = best_normal;
+            return true;
+        }
+
+        double best = INFINITY;
+
+        for (size_t i = 0; i < n; i++)
+        {
+            const point_2d &a = poly[i], &b = poly[(i + 1) % n];
+            double ex = b.x - a.x, ey = b.y - a.y;
+            double len = sqrt(ex * ex + ey * ey);
+            if ( len == 0 ) continue;
+
+            vector_2d out = vector_to(ey / len, -ex / len);
+            if ( _dot(out, a.x - gx, a.y - gy) < 0 ) out = vector_to(-out.x, -out.y);
+
+            // Hit the edge, moved out by the radius
+            double speed = _dot(out, d.x, d.y);
+            if ( speed < 0 )
+            {
+                double t = (_dot(out, a.x, a.y) + r - _dot(out, c.center.x, c.center.y)) / speed;
+                double hx = c.center.x + t * d.x - r * out.x - a.x;
+                double hy = c.center.y + t * d.y - r * out.y - a.y;
+                double s = (hx * ex + hy * ey) / (len * len);
+
+                if ( t >= 0 and t < best and s >= 0 and s <= 1 )
+                {
+                    best = t;
+                    normal = out;
+                }
+            }
+
+            // Hit the corner at a
+            double fx = c.center.x - a.x, fy = c.center.y - a.y;
+            double qa = _dot(d, d.x, d.y), qb = 2 * _dot(d, fx, fy), qc = fx * fx + fy * fy - r * r;
+            double disc = qb * qb - 4 * qa * qc;
+
+            if ( qa > 0 and disc >= 0 )
+            {
+                double t = (-qb - sqrt(disc)) / (2 * qa);
+                if ( t >= 0 and t < best )
+                {
+                    best = t;
+                    normal = vector_to((fx + t * d.x) / r, (fy + t * d.y) / r);
+                }
+            }
+        }
+
+        if ( best > 1 ) return false;
+
+        time = best;
+        return true;
+    }
+
+    // Sweep convex polygon a moving by d toward convex polygon b that is not
+    // moving. Each separating axis gives the times the projections overlap,
+    // and the polygons touch when the latest entry is before the first exit.
+    static bool _sweep_polygons(const vector<point_2d> &a, const vector<point_2d> &b, const vector_2d &d, double &time, vector_2d &normal)
+    {
+        double t_enter = -INFINITY, t_exit = INFINITY;
+        double min_overlap = INFINITY;
+        vector_2d enter_normal = vector_to(0, -1), overlap_normal = vector_to(0, -1);
+
+        for (int pass = 0; pass < 2; pass++)
+        {
+            const vector<point_2d> &edges = pass == 0 ? a : b;
+
+            for (size_t i = 0, n = edges.size(); i < n; i++)
+            {
+                double ax = edges[i].y - edges[(i + 1) % n].y;
+                double ay = edges[(i + 1) % n].x - edges[i].x;
+                double len = sqrt(ax * ax + ay * ay);
+                if ( len == 0 ) continue;
+
+                vector_2d axis = vector_to(ax / len, ay / len);
+
+                double min_a = INFINITY, max_a = -INFINITY, min_b = INFINITY, max_b = -INFINITY;
+                for (const point_2d &p : a)
+                {
+                    double v = _dot(axis, p.x, p.y);
+                    min_a = MIN(min_a, v);
+                    max_a = MAX(max_a, v);
+                }
+                for (const point_2d &p : b)
+                {
+                    double v = _dot(axis, p.x, p.y);
+                    min_b = MIN(min_b, v);
+                    max_b = MAX(max_b, v);
+                }
+
+                double speed = _dot(axis, d.x, d.y);
+                double t0, t1;
+
+                if ( max_a <= min_b ) // a is before b on this axis
+                {
+                    if ( speed <= 0 ) return false;
+                    t0 = (min_b - max_a) / speed;
+                    t1 = (max_b - min_a) / speed;
+                    if ( t0 > t_enter ) { t_enter = t0; enter_normal = vector_to(-axis.x, -axis.y); }
+                }
+                else if ( max_b <= min_a ) // a is after b on this axis
+                {
+                    if ( speed >= 0 ) return false;
+                    t0 = (max_b - min_a) / speed;
+                    t1 = (min_b - max_a) / speed;
+                    if ( t0 > t_enter ) { t_enter = t0; enter_normal = axis; }
+                }
+                else // already overlapping on this axis
+                {
+                    if ( speed > 0 ) t1 = (max_b - min_a) / speed;
+                    else if ( speed < 0 ) t1 = (min_b - max_a) / speed;
+                    else t1 = INFINITY;
+
+                    double push_back = max_a - min_b, push_forward = max_b - min_a;
+                    if ( MIN(push_back, push_forward) < min_overlap )
+                    {
+                        min_overlap = MIN(push_back, push_forward);
+                        overlap_normal = push_back < push_forward ? vector_to(-axis.x, -axis.y) : axis;
+                    }
+                }
+
+                t_exit = MIN(t_exit, t1);
+                if ( t_enter > t_exit or t_enter > 1 ) return false;
+            }
+        }
+
+        if ( t_enter < 0 ) // overlapping at the start
+        {
+            time = 0;
+            normal = overlap_normal;
+        }
+        else
+        {
+            time = t_enter;
+            normal = enter_normal;
+        }
+        return true;
+    }
+
+    // Sweep shape a moving by d toward shape b that is not moving, keeping
+    // the earliest contact.
+    static bool _sweep_shapes(const _sweep_shape &a, const _sweep_shape &b, const vector_2d &d, double &time, vector_2d &normal)
+    {
+        bool hit = false;
+        double t;
+        vector_2d n;
+
+        time = INFINITY;
+
+        if ( a.is_circle and b.is_circle )
+        {
+            if ( _sweep_circles(a.c, b.c, d, t, n) )
+            {
+                hit = true;
+                time = t;
+                normal = n;
+            }
+        }
+        else if ( a.is_circle )
+        {
+            for (const vector<point_2d> &part : b.parts)
+            {
+                if ( _sweep_circle_polygon(a.c, part, d, t, n) and t < time )
+                {
+                    hit = true;
+                    time = t;
+                    normal = n;
+                }
+            }
+        }
+        else if ( b.is_circle )
+        {
+            // Sweep the circle the other way, and push a the opposite way
+            for (const vector<point_2d> &part : a.parts)
+            {
+                if ( _sweep_circle_polygon(b.c, part, vector_to(-d.x, -d.y), t, n) and t < time )
+                {
+                    hit = true;
+                    time = t;
+                    normal = vector_to(-n.x, -n.y);
+                }
+            }
+        }
+        else
+        {
+            for (const vector<point_2d> &part_a : a.parts)
+            {
+                for (const vector<point_2d> &part_b : b.parts)
+                {
+                    if ( _sweep_polygons(part_a, part_b, d, t, n) and t < time )
+                    {
+                        hit = true;
+                        time = t;
+                        normal = n;
+                    }
+                }
+            }
+        }
+
+        return hit;
+    }
+
+    // Could a rectangle moving by d touch the other rectangle?
+    static bool _swept_rectangles_intersect(const rectangle &moving, const vector_2d &d, const rectangle &other)
+    {
+        rectangle swept = rectangle_from(moving.x + MIN(0.0, d.x), moving.y + MIN(0.0, d.y), moving.width + fabs(d.x), moving.height + fabs(d.y));
+        return swept.x <= other.x + other.width and other.x <= swept.x + swept.width and
+               swept.y <= other.y + other.height and other.y <= swept.y + swept.height;
+    }
+
+    static swept_collision _no_swept_collision()
+    {
+        swept_collision result;
+        result.collided = false;
+        result.time = 1;
+        result.normal = vector_to(0, 0);
+        result.other = nullptr;
+        return result;
+    }
+
+    static swept_collision _sprite_swept_collision(sprite s1, const _sweep_shape &shape1, sprite s2)
+    {
+        swept_collision result = _no_swept_collision();
+
+        vector_2d d = vector_subtract(sprite_velocity(s1), sprite_velocity(s2));
+
+        if ( not _swept_rectangles_intersect(sprite_collision_rectangle(s1), d, sprite_collision_rectangle(s2)) )
+            return result;
+
+        double time;
+        vector_2d normal;
+
+        if ( _sweep_shapes(shape1, _sprite_sweep_shape(s2), d, time, normal) )
+        {
+            result.collided = true;
+            result.time = time;
+            result.normal = normal;
+            result.other = s2;
+        }
+
+        return result;
+    }
+
+    swept_collision sprite_swept_collision(sprite s1, sprite s2)
+    {
+        return _sprite_swept_collision(s1, _sprite_sweep_shape(s1), s2);
+    }
+
+    swept_collision sprite_swept_collision(sprite s, const string &pack_name)
+    {
+        if ( not has_sprite_pack(pack_name) )
+        {
+            LOG(WARNING) << "No sprite_pack named " << pack_name << " to sweep collisions against.";
+            return _no_swept_collision();
+        }
+
+        swept_collision result = _no_swept_collision();
+        _sweep_shape shape = _sprite_sweep_shape(s);
+
+        for (sprite other : _sprite_packs[pack_name])
+        {
+            if ( other == s ) continue;
+
+            swept_collision hit = _sprite_swept_collision(s, shape, other);
+
+            if ( hit.collided and ( not result.collided or hit.time < result.time ) )
+                result = hit;
+        }
+
+        return result;
+    }
+
+    //
+    // Batched collisions
+    //
+
+    // Sprite lists with more candidate pairs than this check them on
+    // multiple threads
+    #define BATCH_COLLISIONS_PER_THREAD 256
+
+    struct _batch_entry
+    {
+        rectangle rect;
+        int index;
+        bool in_second;
+    };
+
+    // Find the pairs of sprites whose collision rectangles overlap by sorting
+    // them along x and sweeping across, keeping the sprites still in range.
+    static vector<sprite_collision_pair> _batch_candidates(const vector<sprite> &first, const vector<sprite> &second, bool same_list)
+    {
+        vector<_batch_entry> entries;
+        entries.reserve(first.size() + ( same_list ? 0 : second.size() ));
+
+        for (size_t i = 0; i < first.size(); i++)
+            entries.push_back({ sprite_collision_rectangle(first[i]), static_cast<int>(i), false });
+
+        if ( not same_list )
+        {
+            for (size_t i = 0; i < second.size(); i++)
+                entries.push_back({ sprite_collision_rectangle(second[i]), static_cast<int>(i), true });
+        }
+
+        sort(entries.begin(), entries.end(), [] (const _batch_entry &a, const _batch_entry &b) { return a.rect.x < b.rect.x; });
+
+        vector<sprite_collision_pair> result;
+        vector<const _batch_entry *> active;
+
+        for (const _batch_entry &entry : entries)
+        {
+            // Remove the sprites that end before this one starts
+            size_t keep = 0;
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                if ( active[i]->rect.x + active[i]->rect.width >= entry.rect.x )
+                    active[keep++] = active[i];
+            }
+            active.resize(keep);
+
+            for (const _batch_entry *other : active)
+            {
+                if ( not same_list and other->in_second == entry.in_second ) continue;
+                if ( other->rect.y > entry.rect.y + entry.rect.height or entry.rect.y > other->rect.y + other->rect.height ) continue;
+
+                if ( same_list )
+                    result.push_back({ MIN(other->index, entry.index), MAX(other->index, entry.index) });
+                else if ( entry.in_second )
+                    result.push_back({ other->index, entry.index });
+                else
+                    result.push_back({ entry.index, other->index });
+            }
+
+            active.push_back(&entry);
+        }
+
+        return result;
+    }
+
+    vector<sprite_collision_pair> sprite_collisions(const vector<sprite> &first, const vector<sprite> &second)
+    {
+        bool same_list = &first == &second;
+
+        vector<sprite_collision_pair> candidates = _batch_candidates(first, second, same_list);
+
+        // Collision masks and polygons are built lazily when first used.
+        // Build every one the tests below could need now, on this thread, so
+        // the worker threads only read them
+        for (const vector<sprite> *list : { &first, &second })
+        {
+            for (sprite s : *list)
+            {
+                bitmap bmp = sprite_collision_bitmap(s);
+                if ( INVALID_PTR(bmp, BITMAP_PTR) ) continue;
+
+                // Rectangle collisions never read the sprite's own mask
+                if ( sprite_collision_kind(s) != AABB_COLLISIONS )
+                    ensure_collision_mask(bmp);
+
+                if ( sprite_collision_kind(s) == POLYGON_COLLISIONS )
+                    _collision_shape(bmp, sprite_current_cell(s));
+            }
+        }
+
+        int count = candidates.size();
+        int parts = parallel_part_count(count, BATCH_COLLISIONS_PER_THREAD);
+        vector<vector<sprite_collision_pair>> part_results(parts);
+
+        parallel_for(count, parts, [&] (int part, int start, int end)
+        {
+            for (int i = start; i < end; i++)
+            {
+                const sprite_collision_pair &pair = candidates[i];
+                if ( sprite_collision(first[pair.first], second[pair.second]) )
+                    part_results[part].push_back(pair);
+            }
+        });
+
+        vector<sprite_collision_pair> result;
+        for (const vector<sprite_collision_pair> &part : part_results)
+        {
+            result.insert(result.end(), part.begin(), part.end());
+        }
+
+        return result;
+    }
+
+    vector<sprite_collision_pair> sprite_collisions(const string &pack_name)
+    {
+        return sprite_collisions(pack_name, pack_name);
+    }
+
+    vector<sprite_collision_pair> sprite_collisions(const string &first_pack, const string &second_pack)
+    {
+        if ( not has_sprite_pack(first_pack) or not has_sprite_pack(second_pack) )
+        {
+            LOG(WARNING) << "No sprite_pack named " << ( has_sprite_pack(first_pack) ? second_pack : first_pack ) << " to check collisions in.";
+            return {};
+        }
+
+        return sprite_collisions(_sprite_packs[first_pack], _sprite_packs[second_pack]);
+    }
+}
@@ -155,7 +155,11 @@ namespace splashkit_lib
     bool sprite_rectangle_collision(sprite s, const rectangle& rect);
 
     /**
-     * Tests if two given sprites `s1` and `s2` are collided
+     * Tests if two given sprites `s1` and `s2` are collided. If either sprite
+     * uses `AABB_COLLISIONS` its bounding box is used, if both use
+     * `POLYGON_COLLISIONS` their collision polygons are used, otherwise
+     * their pixels are checked.
+     *
      * @param  s1 the first `sprite` to test
      * @param  s2 the second `sprite` to test
      *
@@ -233,5 +237,103 @@ namespace splashkit_lib
      */
     bool bitmap_collision(bitmap bmp1, float x1, float y1, bitmap bmp2, float x2, float y2);
 
+    /**
+     * The details of a swept collision, found by moving sprites along their
+     * velocity over their next update.
+     *
+     * @param collided  True if the sprites touch during the movement.
+     * @param time      The fraction of the movement (0 to 1) at which the
+     *                  sprites first touch. This is 0 if they already overlap.
+     * @param normal    A unit vector pointing away from the other sprite at the
+     *                  point of contact. Move the swept sprite along this to
+     *                  separate the two.
+     * @param other     The sprite that was hit.
+     */
+    struct swept_collision
+    {
+        bool collided;
+        float time;
+        vector_2d normal;
+        sprite other;
+    };
+
+    /**
+     * Checks if two sprites will collide as they move along their velocities
+     * in the next update, and when they first touch. Unlike `sprite_collision`,
+     * this will detect fast moving sprites that would pass through each other
+     * between updates. Sprites using `AABB_COLLISIONS` are swept as their
+     * collision rectangle, `POLYGON_COLLISIONS` as their collision polygons,
+     * and `PIXEL_COLLISIONS` as their collision circle.
+     *
+     * Call this before updating the sprites.
+     *
+     * @param  s1 The sprite to sweep
+     * @param  s2 The sprite to check against
+     * @returns   The details of the first contact, if any. The normal points
+     *            away from `s2`.
+     */
+    swept_collision sprite_swept_collision(sprite s1, sprite s2);
+
+    /**
+     * Checks if a sprite will collide with any sprite in the named sprite
+     * pack as they move along their velocities in the next update, returning
+     * the earliest contact. Use this to stop fast moving sprites, such as
+     * projectiles, passing through the sprites in the pack.
+     *
+     * @param  s          The sprite to sweep
+     * @param  pack_name  The name of the sprite pack to check against
+     * @returns           The details of the earliest contact, with `other` set
+     *                    to the sprite that was hit.
+     */
+    swept_collision sprite_swept_collision(sprite s, const string &pack_name);
+
+    /**
+     * A pair of sprites that collide, found by `sprite_collisions`.
+     *
+     * @param first   The index of the sprite in the first list or pack
+     * @param second  The index of the sprite in the second list or pack
+     */
+    struct sprite_collision_pair
+    {
+        int first;
+        int second;
+    };
+
+    /**
+     * Finds all of the sprites in the first list that collide with sprites in
+     * the second list. This is much faster than calling `sprite_collision` for
+     * each pair: only sprites with overlapping collision rectangles are
+     * tested, and large numbers of tests are shared across multiple threads.
+     *
+     * If the same list is passed for both, each pair is reported once with
+     * the lower index first, and sprites are not tested with themselves.
+     *
+     * @param first   The first list of sprites
+     * @param second  The second list of sprites
+     * @returns       The pairs of indexes of colliding sprites, one from each
+     *                list
+     */
+    vector<sprite_collision_pair> sprite_collisions(const vector<sprite> &first, const vector<sprite> &second);
+
+    /**
+     * Finds all of the pairs of sprites that collide within the named sprite
+     * pack. Each pair is reported once with the lower index first.
+     *
+     * @param pack_name The name of the sprite pack to check
+     * @returns         The pairs of indexes of colliding sprites in the pack
+     */
+    vector<sprite_collision_pair> sprite_collisions(const string &pack_name);
+
+    /**
+     * Finds all of the sprites in the first sprite pack that collide with
+     * sprites in the second sprite pack.
+     *
+     * @param first_pack    The name of the first sprite pack
+     * @param second_pack   The name of the second sprite pack
+     * @returns             The pairs of indexes of colliding sprites, one
+     *                      from each pack
+     */
+    vector<sprite_collision_pair> sprite_collisions(const string &first_pack, const string &second_pack);
+
 }
 #endif /* collisions_h */
@@ -12,13 +12,76 @@
 #include <cmath>
 namespace splashkit_lib
 {
+    static bool _fast_trigonometry = false;
+
+    void use_fast_trigonometry(bool value)
+    {
+        _fast_trigonometry = value;
+    }
+
+    bool using_fast_trigonometry()
+    {
+        return _fast_trigonometry;
+    }
+
+    // Split the angle into a number of quarter turns, and the remaining
+    // angle in radians between -45 and 45 degrees.
+    static inline int _quarter_turns(float degrees, float &rads)
+    {
+        float turns = nearbyint(degrees * (1.0f / 90.0f));
+
+        rads = (degrees - turns * 90.0f) * static_cast<float>(M_PI / 180.0);
+        return static_cast<int>(static_cast<long long>(turns) & 3);
+    }
+
+    // Minimax polynomials for sine and cosine between -pi/4 and pi/4
+    static inline float _sine_poly(float x)
+    {
+        float z = x * x;
+        return ((-1.9515295891E-4f * z + 8.3321608736E-3f) * z - 1.6666654611E-1f) * z * x + x;
+    }
+
+    static inline float _cosine_poly(float x)
+    {
+        float z = x * x;
+        return ((2.443315711809948E-5f * z - 1.388731625493765E-3f) * z + 4.166664568298827E-2f) * z * z - 0.5f * z + 1.0f;
+    }
+
+    float fast_sine(float degrees)
+    {
+        float x;
+
+        switch (_quarter_turns(degrees, x))
+        {
+            case 0: return _sine_poly(x);
+            case 1: return _cosine_poly(x);
+            case 2: return -_sine_poly(x);
+            default: return -_cosine_poly(x);
+        }
+    }
+
+    float fast_cosine(float degrees)
+    {
+        float x;
+
+        switch (_quarter_turns(degrees, x))
+        {
+            case 0: return _cosine_poly(x);
+            case 1: return -_sine_poly(x);
+            case 2: return -_cosine_poly(x);
+            default: return _sine_poly(x);
+        }
+    }
+
     float cosine(float angle)
     {
+        if ( _fast_trigonometry ) return fast_cosine(angle);
         return cos(deg_to_rad(angle));
     }
 
     float sine(float angle)
     {
+        if ( _fast_trigonometry ) return fast_sine(angle);
         return sin(deg_to_rad(angle));
     }
 
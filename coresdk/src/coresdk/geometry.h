@@ -43,5 +43,43 @@ namespace splashkit_lib
      */
     float tangent(float degrees);
 
+    /**
+     *  Returns an approximation of the sine of the supplied angle (in
+     *  degrees). This is faster than `sine`, and is within 1e-7 of the exact
+     *  value for angles between -1,000,000 and 1,000,000 degrees.
+     *
+     * @param  degrees The angle in degrees
+     * @return         the approximate sine of the supplied angle.
+     */
+    float fast_sine(float degrees);
+
+    /**
+     *  Returns an approximation of the cosine of the supplied angle (in
+     *  degrees). This is faster than `cosine`, with the same
+     *  accuracy as `fast_sine`.
+     *
+     * @param  degrees The angle in degrees
+     * @return         the approximate cosine of the supplied angle.
+     */
+    float fast_cosine(float degrees);
+
+    /**
+     *  Choose if `sine`, `cosine`, and the matrices and vectors made from
+     *  angles (such as `rotation_matrix` and `vector_from_angle`) use the
+     *  approximations from `fast_sine` and `fast_cosine`. This is off by
+     *  default.
+     *
+     * @param value True to use the fast approximations
+     */
+    void use_fast_trigonometry(bool value);
+
+    /**
+     *  Returns true if the fast approximations of sine and cosine are being
+     *  used. See `use_fast_trigonometry`.
+     *
+     * @return True if the fast approximations are in use
+     */
+    bool using_fast_trigonometry();
+
 }
 #endif /* geometry_hpp */
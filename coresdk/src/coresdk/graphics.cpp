@@ -7,6 +7,8 @@
 //
 
 #include "graphics.h"
+#include "audio.h"
+#include "bundles.h"
 #include "window_manager.h"
 #include "utils.h"
 #include "camera.h"
@@ -33,6 +35,12 @@ namespace splashkit_lib
 
     void refresh_screen(unsigned int target_fps)
     {
+        // Play any sounds queued by animations updated this frame
+        flush_queued_sound_effects();
+
+        // Create the resources bundles have loaded in the background
+        update_resource_bundle_loading();
+
         for (const auto& kv : _windows)
         {
             refresh_window(kv.second);
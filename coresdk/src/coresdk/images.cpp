@@ -9,12 +9,19 @@
 #include "images.h"
 
 #include "graphics_driver.h"
+#include "core_driver.h"
 #include "backend_types.h"
 #include "utility_functions.h"
 #include "resources.h"
+#include "simd_utils.h"
+#include "concurrency_utils.h"
 
 #include <map>
+#include <vector>
+#include <fstream>
+#include <cstdio>
 #include <cstdlib>
+#include <cstdint>
 #include <cmath>
 
 using namespace std;
@@ -22,32 +29,242 @@ namespace splashkit_lib
 {
     static map<string, bitmap> _bitmaps;
 
+    // Build a coarse level of the bitmap's collision mask, with a bit set for
+    // each block of pixels that has any pixel set in the mask.
+    void setup_collision_mask_level(_bitmap_data *bmp, _collision_mask_level &level, int block_size)
+    {
+        int w = bmp->image.surface.width;
+        int h = bmp->image.surface.height;
+        int block_cols = (w + block_size - 1) / block_size;
+        int block_rows = (h + block_size - 1) / block_size;
+        int blocks_per_word = 64 / block_size;
+        uint64_t block_bits = block_size == 64 ? ~uint64_t(0) : (uint64_t(1) << block_size) - 1;
+
+        level.block_size = block_size;
+        level.words_per_row = (block_cols + 63) / 64;
+        level.blocks = (uint64_t *) calloc( level.words_per_row * block_rows, sizeof(uint64_t) );
+
+        for (int r = 0; r < h; r++)
+        {
+            const uint64_t *row = bmp->pixel_mask + r * bmp->mask_words_per_row;
+            uint64_t *block_row = level.blocks + (r / block_size) * level.words_per_row;
+
+            for (int bc = 0; bc < block_cols; bc++)
+            {
+                // Each block sits within a single word of the pixel mask row
+                int word = bc / blocks_per_word;
+                int shift = (bc % blocks_per_word) * block_size;
+
+                if ( (row[word] >> shift) & block_bits )
+                    block_row[bc >> 6] |= uint64_t(1) << (bc & 63);
+            }
+        }
+    }
+
+    // Set the bit in the mask row for each pixel that is more than half
+    // opaque. The alpha of each pixel is the byte at alpha_shift, and an alpha
+    // above 0x7F is one with its top bit set.
+    static void _alpha_mask_row(const uint32_t *pixels, int width, int alpha_shift, uint64_t *mask_row)
+    {
+        int c = 0;
+
+#if defined(SK_SIMD_AVX) || defined(SK_SIMD_SSE2)
+        // Move the top bit of each alpha into the sign bit, then gather the
+        // sign bits 16 pixels at a time
+        __m128i shift = _mm_cvtsi32_si128(24 - alpha_shift);
+        for (; c + 16 <= width; c += 16)
+        {
+            uint64_t bits = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                __m128i p = _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(pixels + c + k * 4)), shift);
+                bits |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(p))) << (k * 4);
+            }
+            mask_row[c >> 6] |= bits << (c & 63);
+        }
+#elif defined(SK_SIMD_NEON)
+        const uint32_t weight_values[4] = { 1, 2, 4, 8 };
+        uint32x4_t weights = vld1q_u32(weight_values);
+        int32x4_t shift = vdupq_n_s32(-(alpha_shift + 7));
+        for (; c + 16 <= width; c += 16)
+        {
+            uint64_t bits = 0;
+            for (int k = 0; k < 4; k++)
+            {
+                // Shift the top bit of each alpha down to bit 0
+                uint32x4_t top = vandq_u32(vshlq_u32(vld1q_u32(pixels + c + k * 4), shift), vdupq_n_u32(1));
+                bits |= static_cast<uint64_t>(vaddvq_u32(vmulq_u32(top, weights))) << (k * 4);
+            }
+            mask_row[c >> 6] |= bits << (c & 63);
+        }
+#endif
+
+        for (; c < width; c++)
+        {
+            if ( (pixels[c] >> alpha_shift) & 0x80 )
+                mask_row[c >> 6] |= uint64_t(1) << (c & 63);
+        }
+    }
+
+    // Build the collision mask from the bitmap's pixels. Rows of pixels are
+    // row_stride pixels apart.
+    static void _setup_collision_mask_from_pixels(_bitmap_data *bmp, const uint32_t *pixels, int row_stride, int alpha_shift)
+    {
+        int w = bmp->image.surface.width;
+        int h = bmp->image.surface.height;
+
+        bmp->mask_words_per_row = (w + 63) / 64;
+        bmp->pixel_mask = (uint64_t *) calloc( bmp->mask_words_per_row * h, sizeof(uint64_t) );
+
+        for (int r = 0; r < h; r++)
+        {
+            _alpha_mask_row(pixels + r * row_stride, w, alpha_shift, bmp->pixel_mask + r * bmp->mask_words_per_row);
+        }
+
+        setup_collision_mask_level(bmp, bmp->mask_levels[0], 8);
+        setup_collision_mask_level(bmp, bmp->mask_levels[1], 32);
+    }
+
     void setup_collision_mask(_bitmap_data *bmp)
     {
-        int *pixels;
-        int sz;
-        int r, c;
+        const uint32_t *surface_pixels;
+        int pitch, alpha_shift;
+        int w = bmp->image.surface.width;
+        int h = bmp->image.surface.height;
+
+        // Read straight from the loaded image when it is still in memory,
+        // only reading back from the renderer when it is not
+        if ( sk_bitmap_surface_pixels(&bmp->image.surface, surface_pixels, pitch, alpha_shift) )
+        {
+            _setup_collision_mask_from_pixels(bmp, surface_pixels, pitch / static_cast<int>(sizeof(uint32_t)), alpha_shift);
+            return;
+        }
+
+        vector<uint32_t> pixels(static_cast<size_t>(w) * h);
+
+        if ( sk_bitmap_argb_pixels(&bmp->image.surface, pixels.data()) )
+        {
+            _setup_collision_mask_from_pixels(bmp, pixels.data(), w, 24);
+        }
+        else
+        {
+            // Pixels are read as RGBA, with alpha in the low byte
+            sk_to_pixels(&bmp->image.surface, reinterpret_cast<int *>(pixels.data()), w * h);
+            _setup_collision_mask_from_pixels(bmp, pixels.data(), w, 0);
+        }
+    }
+
+    // Main thread only, see utility_functions.h
+    bool ensure_collision_mask(_bitmap_data *bmp)
+    {
+        if ( bmp->collision_mask_pending )
+        {
+            bmp->collision_mask_pending = false;
+            setup_collision_mask(bmp);
+        }
 
-        sz = bmp->image.surface.width * bmp->image.surface.height;
-        pixels = (int *) malloc(sizeof(int) * sz);
+        return bmp->pixel_mask != nullptr;
+    }
 
-        sk_to_pixels(&bmp->image.surface, pixels, sz);
+    void free_rotated_collision_masks(_bitmap_data *bmp)
+    {
+        for (_rotated_collision_mask &rotated : bmp->rotated_masks)
+        {
+            free(rotated.pixel_mask);
+        }
+        bmp->rotated_masks.clear();
+    }
 
-        bmp->pixel_mask = (bool *) malloc( sizeof(bool) * sz );
+    // Rasterise the collision mask of a cell rotated by the given angle. Each
+    // pixel of the rotated mask is set if its centre falls on a set pixel.
+    _rotated_collision_mask rotated_collision_mask(_bitmap_data *bmp, int cell, float angle)
+    {
+        _rotated_collision_mask result;
 
-        // WriteLn(bmp^.name);
-        for (r = 0; r < bmp->image.surface.height; r++)
+        vector_2d offset = bitmap_cell_offset(bmp, cell);
+        int cell_x = offset.x, cell_y = offset.y;
+        int w = MAX(0, MIN(bmp->cell_w, bmp->image.surface.width - cell_x));
+        int h = MAX(0, MIN(bmp->cell_h, bmp->image.surface.height - cell_y));
+
+        double rads = deg_to_rad(angle);
+        double c = cos(rads), s = sin(rads);
+
+        // Find the bounds of the rotated cell
+        double xs[4] = { 0, c * w, -s * h, c * w - s * h };
+        double ys[4] = { 0, s * w, c * h, s * w + c * h };
+        double min_x = xs[0], max_x = xs[0], min_y = ys[0], max_y = ys[0];
+        for (int i = 1; i < 4; i++)
         {
-            for(c = 0; c < bmp->image.surface.width; c++)
+            min_x = MIN(min_x, xs[i]);
+            max_x = MAX(max_x, xs[i]);
+            min_y = MIN(min_y, ys[i]);
+            max_y = MAX(max_y, ys[i]);
+        }
+
+        result.offset_x = floor(min_x);
+        result.offset_y = floor(min_y);
+        result.width = static_cast<int>(ceil(max_x)) - result.offset_x;
+        result.height = static_cast<int>(ceil(max_y)) - result.offset_y;
+        result.words_per_row = (result.width + 63) / 64;
+        result.pixel_mask = (uint64_t *) calloc( MAX(1, result.words_per_row * result.height), sizeof(uint64_t) );
+
+        for (int r = 0; r < result.height; r++)
+        {
+            uint64_t *row = result.pixel_mask + r * result.words_per_row;
+            double wy = result.offset_y + r + 0.5;
+
+            for (int col = 0; col < result.width; col++)
             {
-                bmp->pixel_mask[c + r * bmp->image.surface.width] = ((pixels[c + r * bmp->image.surface.width] & 0x000000FF) > 0x0000007F );
-                // if b^.nonTransparentPixels[c, r] then Write(1) else Write(0);
+                double wx = result.offset_x + col + 0.5;
+
+                // Rotate back into the cell
+                int px = floor(c * wx + s * wy);
+                int py = floor(-s * wx + c * wy);
+
+                if ( px < 0 or px >= w or py < 0 or py >= h ) continue;
+
+                px += cell_x;
+                py += cell_y;
+
+                if ( (bmp->pixel_mask[py * bmp->mask_words_per_row + (px >> 6)] >> (px & 63)) & 1 )
+                    row[col >> 6] |= uint64_t(1) << (col & 63);
             }
-            // WriteLn();
         }
-        // WriteLn();
 
-        free(pixels);
+        return result;
+    }
+
+    void setup_rotated_collision_masks(_bitmap_data *bmp)
+    {
+        free_rotated_collision_masks(bmp);
+
+        if ( bmp->rotated_mask_steps <= 0 or not ensure_collision_mask(bmp) ) return;
+
+        for (int cell = 0; cell < bmp->cell_count; cell++)
+        {
+            for (int step = 0; step < bmp->rotated_mask_steps; step++)
+            {
+                bmp->rotated_masks.push_back(rotated_collision_mask(bmp, cell, step * 360.0f / bmp->rotated_mask_steps));
+            }
+        }
+    }
+
+    void bitmap_set_rotated_collision_masks(bitmap bmp, int angle_steps)
+    {
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Trying to set rotated collision masks of invalid bitmap.";
+            return;
+        }
+
+        if ( angle_steps < 0 )
+        {
+            LOG(WARNING) << "Trying to set a negative number of rotated collision masks for bitmap " << bmp->name;
+            return;
+        }
+
+        bmp->rotated_mask_steps = angle_steps;
+        setup_rotated_collision_masks(bmp);
     }
 
     bool has_bitmap(string name)
@@ -70,27 +287,155 @@ namespace splashkit_lib
     }
 
 
-    bitmap load_bitmap(string name, string filename)
+    //
+    // Decoded bitmap cache
+    //
+    // Once a cache folder is set, bitmaps loaded from files save their
+    // decoded pixels there, so later loads do not need to decode the image.
+    // Each image gets its own file, named from the image's file name and a
+    // hash of its full path. The cache records the time and size of the
+    // image it was made from, so it is remade when the image changes. The
+    // collision mask is not saved, as it is built from the pixels only when
+    // the bitmap is first used in a collision. The file is:
+    //
+    //   header:  magic, version, image modified time, image size, width
+    //            and height
+    //   pixels:  width * height ARGB8888 values, the format textures use
+    //
+
+    #define BITMAP_CACHE_EXTENSION ".skbmp"
+    #define BITMAP_CACHE_MAGIC 0x4d424b53  // 'SKBM' when read in the order it was written
+    #define BITMAP_CACHE_VERSION 2
+
+    // Empty when bitmaps are not cached
+    static string _bitmap_cache_path;
+
+    struct _bitmap_cache_header
     {
-        if (has_bitmap(name)) return bitmap_named(name);
+        uint32_t magic;
+        uint32_t version;
+        int64_t source_modified;
+        int64_t source_size;
+        int32_t width;
+        int32_t height;
+    };
+
+    void set_bitmap_cache_path(const string &path)
+    {
+        if ( path.length() > 0 and not directory_exists(path) )
+        {
+            LOG(WARNING) << "Unable to cache bitmaps in " << path << ". The folder does not exist.";
+            _bitmap_cache_path = "";
+            return;
+        }
+
+        _bitmap_cache_path = path;
+    }
+
+    // Read the cached bitmap, returning false if the cache is missing, damaged
+    // or older than the image
+    static bool _read_bitmap_cache(const string &cache_path, const string &source_path, sk_drawing_surface &surface)
+    {
+        int64_t source_modified, source_size, cache_modified, cache_size;
+        _bitmap_cache_header header;
+
+        if ( not file_details(source_path, source_modified, source_size) ) return false;
+        if ( not file_details(cache_path, cache_modified, cache_size) ) return false;
+
+        ifstream input(cache_path, ios::binary);
+        if ( not input.read(reinterpret_cast<char *>(&header), sizeof(header)) ) return false;
+
+        if ( header.magic != BITMAP_CACHE_MAGIC or header.version != BITMAP_CACHE_VERSION or
+             header.source_modified != source_modified or header.source_size != source_size or
+             header.width <= 0 or header.height <= 0 )
+            return false;
+
+        size_t pixel_count = static_cast<size_t>(header.width) * header.height;
+
+        if ( static_cast<uint64_t>(cache_size) != sizeof(header) + pixel_count * sizeof(uint32_t) )
+            return false;
+
+        vector<uint32_t> pixels(pixel_count);
+
+        if ( not input.read(reinterpret_cast<char *>(pixels.data()), pixel_count * sizeof(uint32_t)) )
+            return false;
+
+        surface = sk_decode_bitmap_from_pixels(header.width, header.height, pixels.data());
+        return surface._data != nullptr;
+    }
+
+    static void _write_bitmap_cache(const string &cache_path, const string &source_path, _bitmap_data *bmp)
+    {
+        _bitmap_cache_header header;
+        if ( not file_details(source_path, header.source_modified, header.source_size) ) return;
 
+        vector<uint32_t> pixels(static_cast<size_t>(bmp->image.surface.width) * bmp->image.surface.height);
+        if ( not sk_bitmap_argb_pixels(&bmp->image.surface, pixels.data()) ) return;
+
+        header.magic = BITMAP_CACHE_MAGIC;
+        header.version = BITMAP_CACHE_VERSION;
+        header.width = bmp->image.surface.width;
+        header.height = bmp->image.surface.height;
+
+        // Write to a temporary file first, so a partly written cache is
+        // never read
+        string temp_path = temp_path_for(cache_path);
+        {
+            ofstream out(temp_path, ios::binary | ios::trunc);
+
+            // The cache folder may not be writable, in which case the image is decoded each time
+            if ( not out ) return;
+
+            out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char *>(pixels.data()), pixels.size() * sizeof(uint32_t));
+
+            if ( not out )
+            {
+                out.close();
+                remove(temp_path.c_str());
+                return;
+            }
+        }
+
+        replace_file(temp_path, cache_path);
+    }
+
+    _bitmap_data *prepare_bitmap(const string &name, const string &filename, const char *data, size_t size)
+    {
         sk_drawing_surface surface;
         bitmap result = nullptr;
+        bool cached = false;
 
         string file_path = filename;
+        string cache_path;
 
-        if ( ! file_exists(file_path) )
+        if ( data )
+        {
+            surface = sk_decode_bitmap_from_memory(data, size);
+        }
+        else
         {
-            file_path = path_to_resource(filename, IMAGE_RESOURCE);
-
             if ( ! file_exists(file_path) )
             {
-                LOG(WARNING) << cat({ "Unable to locate file for ", name, " (", file_path, ")"});
-                return nullptr;
+                file_path = path_to_resource(filename, IMAGE_RESOURCE);
+
+                if ( ! file_exists(file_path) )
+                {
+                    LOG(WARNING) << cat({ "Unable to locate file for ", name, " (", file_path, ")"});
+                    return nullptr;
+                }
             }
+
+            if ( _bitmap_cache_path.length() > 0 )
+            {
+                cache_path = cache_file_for(_bitmap_cache_path, file_path, BITMAP_CACHE_EXTENSION);
+                cached = _read_bitmap_cache(cache_path, file_path, surface);
+            }
+
+            if ( not cached )
+                surface = sk_decode_bitmap(file_path.c_str());
         }
 
-        surface = sk_load_bitmap(file_path.c_str());
         if ( not surface._data )
         {
             LOG(WARNING) <<  cat({ "Error loading image for ", name, " (", file_path, ")"}) ;
@@ -106,13 +451,110 @@ namespace splashkit_lib
         result->cell_cols  = 1;
         result->cell_rows  = 1;
         result->cell_count = 1;
+        result->cell_version = 0;
+
+        result->rotated_mask_steps = 0;
 
         result->name       = name;
         result->filename   = file_path;
 
-        setup_collision_mask(result);
+        // Most bitmaps are never used in pixel collisions, so wait until
+        // the mask is needed before building it
+        result->pixel_mask = nullptr;
+        result->mask_words_per_row = 0;
+        for (int i = 0; i < COLLISION_MASK_LEVELS; i++)
+            result->mask_levels[i].blocks = nullptr;
+        result->collision_mask_pending = true;
+
+        if ( cache_path.length() > 0 and not cached ) _write_bitmap_cache(cache_path, file_path, result);
+
+        return result;
+    }
+
+    // Release a bitmap that was never added to the bitmaps map
+    static void _release_bitmap(bitmap bmp)
+    {
+        sk_close_drawing_surface(&bmp->image.surface);
+        free(bmp->pixel_mask);
+        bmp->pixel_mask = nullptr;
+        for (int i = 0; i < COLLISION_MASK_LEVELS; i++)
+        {
+            free(bmp->mask_levels[i].blocks);
+            bmp->mask_levels[i].blocks = nullptr;
+        }
+        free_rotated_collision_masks(bmp);
+        bmp->id = NONE_PTR;  // ensure future use of this pointer will fail...
+        delete(bmp);
+    }
+
+    bitmap finish_bitmap(_bitmap_data *bmp)
+    {
+        if ( not bmp ) return nullptr;
+
+        sk_upload_bitmap(&bmp->image.surface);
+
+        // Another bitmap may have taken the name while this one was loading
+        if ( has_bitmap(bmp->name) )
+        {
+            bitmap existing = _bitmaps[bmp->name];
+            _release_bitmap(bmp);
+            return existing;
+        }
+
+        _bitmaps[bmp->name] = bmp;
+        return bmp;
+    }
+
+    bitmap load_bitmap(string name, string filename)
+    {
+        if (has_bitmap(name)) return bitmap_named(name);
+
+        internal_sk_init();
+        return finish_bitmap(prepare_bitmap(name, filename));
+    }
+
+    vector<bitmap> load_bitmaps(const vector<string> &names, const vector<string> &filenames)
+    {
+        vector<bitmap> result;
+
+        if ( names.size() != filenames.size() )
+        {
+            LOG(WARNING) << "Unable to load bitmaps, as there are " << names.size() << " names and " << filenames.size() << " filenames";
+            return result;
+        }
+
+        internal_sk_init();
+
+        // Decode the images that are not already loaded
+        vector<int> work;
+        for (int i = 0; i < static_cast<int>(names.size()); i++)
+        {
+            if ( not has_bitmap(names[i]) ) work.push_back(i);
+        }
+
+        vector<_bitmap_data *> prepared(names.size(), nullptr);
 
-        _bitmaps[name] = result;
+        // Images differ in size, so each is its own part. The worker pool
+        // gives each thread the next image as it finishes, rather than a
+        // fixed share of them.
+        int count = static_cast<int>(work.size());
+        parallel_for(count, count, [&] (int /*part*/, int start, int end)
+        {
+            for (int idx = start; idx < end; idx++)
+            {
+                prepared[work[idx]] = prepare_bitmap(names[work[idx]], filenames[work[idx]]);
+            }
+        });
+
+        // Textures are created, and names added, on this thread
+        result.resize(names.size(), nullptr);
+        for (size_t i = 0; i < names.size(); i++)
+        {
+            if ( prepared[i] )
+                result[i] = finish_bitmap(prepared[i]);
+            else if ( has_bitmap(names[i]) )
+                result[i] = _bitmaps[names[i]];
+        }
 
         return result;
     }
@@ -129,6 +571,14 @@ namespace splashkit_lib
         result->cell_cols  = 1;
         result->cell_rows  = 1;
         result->cell_count = 1;
+        result->cell_version = 0;
+
+        result->pixel_mask = nullptr;
+        result->mask_words_per_row = 0;
+        for (int i = 0; i < COLLISION_MASK_LEVELS; i++)
+            result->mask_levels[i].blocks = nullptr;
+        result->collision_mask_pending = false;
+        result->rotated_mask_steps = 0;
 
         result->filename   = "";
 
@@ -154,9 +604,7 @@ namespace splashkit_lib
             notify_of_free(bmp);
 
             _bitmaps.erase(bmp->name);
-            sk_close_drawing_surface(&bmp->image.surface);
-            bmp->id = NONE_PTR;  // ensure future use of this pointer will fail...
-            delete(bmp);
+            _release_bitmap(bmp);
         }
         else
         {
@@ -398,6 +846,14 @@ namespace splashkit_lib
         bmp->cell_cols  = columns;
         bmp->cell_rows  = rows;
         bmp->cell_count = count;
+        bmp->cell_version++;
+
+        // Collision polygons are for each cell, so rebuild when next needed
+        bmp->collision_shapes.clear();
+
+        // Rotated masks are made for each cell, so need to be rebuilt
+        if ( bmp->rotated_mask_steps > 0 )
+            setup_rotated_collision_masks(bmp);
     }
 
     int bitmap_width(bitmap bmp)
@@ -482,7 +938,9 @@ namespace splashkit_lib
 
         if ( INVALID_PTR(bmp, BITMAP_PTR) or px < 0 or px >= bitmap_width(bmp) or py < 0 or py >= bitmap_height(bmp) ) return false;
 
-        return bmp->pixel_mask[px + py * bmp->image.surface.width];
+        if ( not ensure_collision_mask(bmp) ) return false;
+
+        return ( bmp->pixel_mask[py * bmp->mask_words_per_row + (px >> 6)] >> (px & 63) ) & 1;
     }
 
     bool pixel_drawn_at_point(bitmap bmp, int cell, float x, float y)
@@ -15,6 +15,7 @@
 #include "physics.h"
 
 #include <string>
+#include <vector>
 using namespace std;
 namespace splashkit_lib
 {
@@ -30,6 +31,32 @@ namespace splashkit_lib
      */
     bitmap load_bitmap(string name, string filename);
 
+    /**
+     * Loads a number of bitmaps at once. The image files are decoded on
+     * several threads, and then the bitmaps are created, so this is much
+     * faster than calling `load_bitmap` for each file when there are many
+     * images to load. Names that already have a bitmap are not loaded again.
+     *
+     * @param  names     The names of the bitmap resources in SplashKit
+     * @param  filenames The filenames to load, one for each name
+     * @return           The loaded bitmaps, in the same order as the names. A
+     *                   bitmap that could not be loaded is left empty.
+     */
+    vector<bitmap> load_bitmaps(const vector<string> &names, const vector<string> &filenames);
+
+    /**
+     * Sets the folder used to cache decoded bitmaps. While a folder is set,
+     * bitmaps loaded from image files save their decoded pixels there, and
+     * later loads of an unchanged image read these pixels rather than
+     * decoding the image again. Bitmaps are not cached until a folder is
+     * set, and setting an empty path turns the cache off. The folder must
+     * already exist, and should be set before any bitmaps are loaded.
+     *
+     * @param path  The folder to store cached bitmaps in, or an empty string
+     *              to stop caching bitmaps
+     */
+    void set_bitmap_cache_path(const string &path);
+
     /**
      * Determines if SplashKit has a bitmap loaded for the supplied name.
      * This checks against all bitmaps loaded.
@@ -378,6 +405,20 @@ namespace splashkit_lib
      */
     void bitmap_set_cell_details(bitmap bmp, int width, int height, int columns, int rows, int count);
 
+    /**
+     * Prepare collision masks for each cell of the bitmap at a number of fixed
+     * rotations, evenly spaced around the circle. Pixel level collisions with
+     * the rotated bitmap then use the mask at the nearest of these rotations,
+     * which is much faster than checking the rotated pixels. This is useful
+     * for sprites that only rotate in fixed steps, such as 64 headings. The
+     * masks use more memory, and are rebuilt if the cell details change.
+     *
+     * @param bmp           The bitmap
+     * @param angle_steps   The number of rotations to prepare masks for, or 0
+     *                      to remove the rotated masks
+     */
+    void bitmap_set_rotated_collision_masks(bitmap bmp, int angle_steps);
+
     /**
      * Returns the number of cells within the bitmap.
      *
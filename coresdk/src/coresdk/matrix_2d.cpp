@@ -9,7 +9,9 @@
 #include "matrix_2d.h"
 
 #include "point_geometry.h"
+#include "geometry.h"
 #include "utility_functions.h"
+#include "simd_utils.h"
 
 #include <cmath>
 #include <iomanip>
@@ -73,17 +75,35 @@ namespace splashkit_lib
         return result;
     }
 
+    // Get the sine and cosine of the angle, using the fast approximations
+    // when they have been enabled.
+    static void _sine_cosine(float deg, double &s, double &c)
+    {
+        if ( using_fast_trigonometry() )
+        {
+            s = fast_sine(deg);
+            c = fast_cosine(deg);
+        }
+        else
+        {
+            float rads = deg_to_rad(deg);
+            s = sin(rads);
+            c = cos(rads);
+        }
+    }
+
     matrix_2d rotation_matrix(float deg)
     {
-        float rads = deg_to_rad(-deg);
+        double s, c;
+        _sine_cosine(-deg, s, c);
 
         matrix_2d result;
-        result.elements[0][0] = cos(rads);
-        result.elements[0][1] = sin(rads);
+        result.elements[0][0] = c;
+        result.elements[0][1] = s;
         result.elements[0][2] = 0;
 
-        result.elements[1][0] = -sin(rads);
-        result.elements[1][1] = cos(rads);
+        result.elements[1][0] = -s;
+        result.elements[1][1] = c;
         result.elements[1][2] = 0;
 
         result.elements[2][0] = 0;
@@ -95,15 +115,16 @@ namespace splashkit_lib
 
     matrix_2d scale_rotate_translate_matrix(const point_2d &scale, float deg, const point_2d &translate)
     {
-        float rads = deg_to_rad(-deg);
+        double s, c;
+        _sine_cosine(-deg, s, c);
 
         matrix_2d result;
-        result.elements[0][0] = cos(rads) * scale.x;
-        result.elements[0][1] = sin(rads);
+        result.elements[0][0] = c * scale.x;
+        result.elements[0][1] = s;
         result.elements[0][2] = translate.x;
 
-        result.elements[1][0] = -sin(rads);
-        result.elements[1][1] = cos(rads) * scale.y;
+        result.elements[1][0] = -s;
+        result.elements[1][1] = c * scale.y;
         result.elements[1][2] = translate.y;
 
         result.elements[2][0] = 0;
@@ -113,8 +134,46 @@ namespace splashkit_lib
         return result;
     }
 
+    // Is the bottom row of the matrix 0, 0, 1? Translation, rotation and
+    // scaling matrices all are, and so is anything made by combining them.
+    static inline bool _is_affine(const matrix_2d &m)
+    {
+        return m.elements[2][0] == 0 and m.elements[2][1] == 0 and m.elements[2][2] == 1;
+    }
+
+    // Inverse of a matrix with a bottom row of 0, 0, 1. This gives the same
+    // values as the general version, skipping the terms that are multiplied
+    // by zero, but keeps the bottom row exact.
+    static matrix_2d _affine_inverse(const matrix_2d &m)
+    {
+        float det = m.elements[0][0] * m.elements[1][1] - m.elements[0][1] * m.elements[1][0];
+
+        float invdet;
+        if (det == 0) //cant actually compute inverse!
+        {
+            invdet = 3.4E38;
+            LOG(WARNING) << "Unable to compute inverse of matrix.";
+        }
+        else
+            invdet = 1 / det;
+
+        matrix_2d result;
+        result.elements[0][0] = m.elements[1][1] * invdet;
+        result.elements[0][1] = -m.elements[0][1] * invdet;
+        result.elements[0][2] = (m.elements[0][1] * m.elements[1][2] - m.elements[0][2] * m.elements[1][1]) * invdet;
+        result.elements[1][0] = -m.elements[1][0] * invdet;
+        result.elements[1][1] = m.elements[0][0] * invdet;
+        result.elements[1][2] = (m.elements[1][0] * m.elements[0][2] - m.elements[0][0] * m.elements[1][2]) * invdet;
+        result.elements[2][0] = 0;
+        result.elements[2][1] = 0;
+        result.elements[2][2] = 1;
+        return result;
+    }
+
     matrix_2d matrix_inverse(const matrix_2d &m)
     {
+        if ( _is_affine(m) ) return _affine_inverse(m);
+
         float det =  m.elements[0][0] * (m.elements[1][1] * m.elements[2][2] - m.elements[2][1] * m.elements[1][2]) -
         m.elements[0][1] * (m.elements[1][0] * m.elements[2][2] - m.elements[1][2] * m.elements[2][0]) +
         m.elements[0][2] * (m.elements[1][0] * m.elements[2][1] - m.elements[1][1] * m.elements[2][0]);
@@ -159,8 +218,30 @@ namespace splashkit_lib
         return result.str();
     }
 
+    // Multiply two matrices with a bottom row of 0, 0, 1. The result is the
+    // same as the general version, which only adds zeros to these values.
+    static matrix_2d _affine_multiply(const matrix_2d &m2, const matrix_2d &m1)
+    {
+        matrix_2d result;
+
+        result.elements[0][0] = m1.elements[0][0] * m2.elements[0][0] + m1.elements[0][1] * m2.elements[1][0];
+        result.elements[0][1] = m1.elements[0][0] * m2.elements[0][1] + m1.elements[0][1] * m2.elements[1][1];
+        result.elements[0][2] = m1.elements[0][0] * m2.elements[0][2] + m1.elements[0][1] * m2.elements[1][2] + m1.elements[0][2];
+
+        result.elements[1][0] = m1.elements[1][0] * m2.elements[0][0] + m1.elements[1][1] * m2.elements[1][0];
+        result.elements[1][1] = m1.elements[1][0] * m2.elements[0][1] + m1.elements[1][1] * m2.elements[1][1];
+        result.elements[1][2] = m1.elements[1][0] * m2.elements[0][2] + m1.elements[1][1] * m2.elements[1][2] + m1.elements[1][2];
+
+        result.elements[2][0] = 0;
+        result.elements[2][1] = 0;
+        result.elements[2][2] = 1;
+        return result;
+    }
+
     matrix_2d matrix_multiply(const matrix_2d &m2, const matrix_2d &m1)
     {
+        if ( _is_affine(m1) and _is_affine(m2) ) return _affine_multiply(m2, m1);
+
         matrix_2d result;
 
         result.elements[0][0] = m1.elements[0][0] * m2.elements[0][0] +
@@ -205,6 +286,72 @@ namespace splashkit_lib
         return result;
     }
 
+    void matrix_multiply(const matrix_2d &m, const vector<point_2d> &pts, vector<point_2d> &result)
+    {
+        static_assert(sizeof(point_2d) == 2 * sizeof(float), "points must be packed x, y pairs");
+
+        size_t count = pts.size();
+        size_t i = 0;
+
+        result.resize(count);
+
+        const float *src = reinterpret_cast<const float *>(pts.data());
+        float *dest = reinterpret_cast<float *>(result.data());
+
+        // Each kernel works in double precision, like the single point
+        // version, so the results match it exactly.
+#if defined(SK_SIMD_AVX)
+        __m256d c0 = _mm256_setr_pd(m.elements[0][0], m.elements[1][0], m.elements[0][0], m.elements[1][0]);
+        __m256d c1 = _mm256_setr_pd(m.elements[0][1], m.elements[1][1], m.elements[0][1], m.elements[1][1]);
+        __m256d c2 = _mm256_setr_pd(m.elements[0][2], m.elements[1][2], m.elements[0][2], m.elements[1][2]);
+
+        // Two points at a time: (x0, y0, x1, y1)
+        for (; i + 2 <= count; i += 2)
+        {
+            __m256d p = _mm256_cvtps_pd(_mm_loadu_ps(src + i * 2));
+            __m256d x = _mm256_unpacklo_pd(p, p);
+            __m256d y = _mm256_unpackhi_pd(p, p);
+
+            __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, c0), _mm256_mul_pd(y, c1)), c2);
+            _mm_storeu_ps(dest + i * 2, _mm256_cvtpd_ps(r));
+        }
+#elif defined(SK_SIMD_SSE2)
+        __m128d c0 = _mm_setr_pd(m.elements[0][0], m.elements[1][0]);
+        __m128d c1 = _mm_setr_pd(m.elements[0][1], m.elements[1][1]);
+        __m128d c2 = _mm_setr_pd(m.elements[0][2], m.elements[1][2]);
+
+        for (; i < count; i++)
+        {
+            __m128d p = _mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(src + i * 2))));
+            __m128d x = _mm_unpacklo_pd(p, p);
+            __m128d y = _mm_unpackhi_pd(p, p);
+
+            __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(x, c0), _mm_mul_pd(y, c1)), c2);
+            _mm_store_sd(reinterpret_cast<double *>(dest + i * 2), _mm_castps_pd(_mm_cvtpd_ps(r)));
+        }
+#elif defined(SK_SIMD_NEON)
+        const double col0[2] = { m.elements[0][0], m.elements[1][0] };
+        const double col1[2] = { m.elements[0][1], m.elements[1][1] };
+        const double col2[2] = { m.elements[0][2], m.elements[1][2] };
+        float64x2_t c0 = vld1q_f64(col0), c1 = vld1q_f64(col1), c2 = vld1q_f64(col2);
+
+        for (; i < count; i++)
+        {
+            float64x2_t p = vcvt_f64_f32(vld1_f32(src + i * 2));
+            float64x2_t x = vdupq_laneq_f64(p, 0);
+            float64x2_t y = vdupq_laneq_f64(p, 1);
+
+            float64x2_t r = vaddq_f64(vaddq_f64(vmulq_f64(x, c0), vmulq_f64(y, c1)), c2);
+            vst1_f32(dest + i * 2, vcvt_f32_f64(r));
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            result[i] = matrix_multiply(m, pts[i]);
+        }
+    }
+
     vector_2d matrix_multiply(const matrix_2d &m, const vector_2d &v)
     {
         vector_2d result;
@@ -10,6 +10,7 @@
 #define matrix_2d_h
 
 #include <string>
+#include <vector>
 #include "types.h"
 using namespace std;
 namespace splashkit_lib
@@ -124,6 +125,19 @@ namespace splashkit_lib
      */
     point_2d matrix_multiply(const matrix_2d &m, const point_2d &pt);
 
+    /**
+     *  Multiplies each of the points in `pts` with the `matrix_2d` `m`,
+     *  storing the transformed points in `result`. This gives the same values
+     *  as transforming each point on its own, but works through the points
+     *  several at a time so it is much faster for large arrays. `result` is
+     *  resized to match `pts`, and may be the same vector as `pts`.
+     *
+     * @param m         The matrix with the transformation to apply.
+     * @param pts       The points to be transformed.
+     * @param result    The vector to store the transformed points in.
+     */
+    void matrix_multiply(const matrix_2d &m, const vector<point_2d> &pts, vector<point_2d> &result);
+
     /**
      *  Calculate the inverse of a matrix.
      *
@@ -20,12 +20,22 @@ namespace splashkit_lib
     vector_2d _wheel_scroll = {0,0};
     map<int, bool> _button_clicked;
 
+    // Incremented each time events are processed, so other modules can
+    // tell when mouse state has changed (e.g. to resolve clicks once)
+    unsigned int _mouse_event_frame = 0;
+
     void _mouse_start_process_events()
     {
         //called at the start of process events -- used to clear state
 
         _wheel_scroll = vector_to(0,0);
         _button_clicked.clear();
+        _mouse_event_frame++;
+    }
+
+    unsigned int _mouse_process_events_count()
+    {
+        return _mouse_event_frame;
     }
 
     void _process_mouse_up_event(int code)
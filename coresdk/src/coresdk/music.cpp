@@ -27,13 +27,11 @@ namespace splashkit_lib
         string filename, name;
     };
 
-    music load_music(const string &name, const string &filename)
+    _music_data *prepare_music(const string &name, const string &filename, const char *data, size_t size)
     {
-        if (has_music(name)) return music_named(name);
-
         string file_path = filename;
 
-        if ( ! file_exists(file_path) )
+        if ( ! data and ! file_exists(file_path) )
         {
             file_path = path_to_resource(filename, MUSIC_RESOURCE);
 
@@ -44,12 +42,15 @@ namespace splashkit_lib
             }
         }
 
-        music result = new _music_data();
+        _music_data *result = new _music_data();
 
         result->id = MUSIC_PTR;
         result->filename = file_path;
         result->name = name;
-        result->audio = sk_load_sound_data(file_path, SGSD_MUSIC);
+        if ( data )
+            result->audio = sk_load_sound_data_from_memory(data, size, SGSD_MUSIC);
+        else
+            result->audio = sk_load_sound_data(file_path, SGSD_MUSIC);
 
         // Unable to load sound effect
         if ( ! result->audio._data )
@@ -60,10 +61,34 @@ namespace splashkit_lib
             return nullptr;
         }
 
-        _music[name] = result;
         return result;
     }
 
+    music finish_music(_music_data *prepared)
+    {
+        if ( not prepared ) return nullptr;
+
+        // Music with the same name may have been loaded while this was loading
+        if ( has_music(prepared->name) )
+        {
+            music existing = _music[prepared->name];
+            sk_close_sound_data(&prepared->audio);
+            prepared->id = NONE_PTR;
+            delete prepared;
+            return existing;
+        }
+
+        _music[prepared->name] = prepared;
+        return prepared;
+    }
+
+    music load_music(const string &name, const string &filename)
+    {
+        if (has_music(name)) return music_named(name);
+
+        return finish_music(prepare_music(name, filename));
+    }
+
     void free_music(music effect)
     {
         if ( VALID_PTR(effect, MUSIC_PTR) )
@@ -0,0 +1,605 @@
+//
+//  particles.cpp
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#include "particles.h"
+
+#include "images.h"
+#include "random.h"
+#include "resources.h"
+
+#include "graphics_driver.h"
+#include "backend_types.h"
+#include "utility_functions.h"
+#include "concurrency_utils.h"
+#include "simd_utils.h"
+
+#include <cmath>
+#include <map>
+#include <vector>
+
+using namespace std;
+namespace splashkit_lib
+{
+    // The fewest particles worth giving their own thread when an emitter
+    // uses threads
+    #define PARTICLES_PER_THREAD 16384
+
+    static map<string, particle_emitter> _particle_emitters;
+
+    struct _particle_emitter_data
+    {
+        pointer_identifier id;
+        string name;
+        bitmap bmp;
+
+        // The particles, with one array per value so they can be moved
+        // several at a time. Only the first count entries are alive.
+        int count, max_particles;
+        vector<float> x, y, vx, vy;
+        vector<float> life;         // Seconds left to live
+        vector<float> inv_life;     // 1 / the seconds the particle was given
+        vector<unsigned int> clr;   // Tint, red in the low byte and alpha in the high byte
+        vector<int> cell;
+
+        // How new particles are created
+        point_2d position;
+        float rate, emit_remainder;
+        float min_life, max_life;
+        float min_speed, max_speed;
+        float direction, spread;
+        color clr1, clr2;
+        int first_cell, cell_count;
+        uint32_t random_state;
+
+        vector_2d gravity;
+        float scale;
+        bool fade;
+        bool use_threads;
+
+        // Space to build each batch of particles to draw, kept between draws
+        vector<rectangle> cell_rects;
+        vector<float> src_data, dst_data;
+        vector<unsigned int> draw_clr;
+    };
+
+    // A fast random number in [0, 1). Emitters can create many thousands of
+    // particles a frame, so they keep their own generator rather than use rnd.
+    static inline float _particle_rnd(uint32_t &state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return (state >> 8) * (1.0f / 16777216.0f);
+    }
+
+    static inline unsigned int _color_byte(float value)
+    {
+        return static_cast<unsigned int>(MAX(0.0f, MIN(value, 1.0f)) * 255.0f + 0.5f);
+    }
+
+    static unsigned int _pack_color(const color &clr)
+    {
+        return _color_byte(clr.r) | _color_byte(clr.g) << 8 | _color_byte(clr.b) << 16 | _color_byte(clr.a) << 24;
+    }
+
+    // Stop emitters using bitmaps that have been freed
+    static void _particle_free_notifier(void *resource)
+    {
+        for (auto &kv : _particle_emitters)
+        {
+            if ( kv.second->bmp == resource )
+                kv.second->bmp = nullptr;
+        }
+    }
+
+    // Apply gravity, then move the particles in [start, end)
+    static void _move_particles(particle_emitter emitter, int start, int end, float dt)
+    {
+        float *x = emitter->x.data();
+        float *y = emitter->y.data();
+        float *vx = emitter->vx.data();
+        float *vy = emitter->vy.data();
+        float *life = emitter->life.data();
+
+        float gx = static_cast<float>(emitter->gravity.x) * dt;
+        float gy = static_cast<float>(emitter->gravity.y) * dt;
+
+        int i = start;
+
+#if defined(SK_SIMD_AVX)
+        __m256 v_dt = _mm256_set1_ps(dt), v_gx = _mm256_set1_ps(gx), v_gy = _mm256_set1_ps(gy);
+        for (; i + 8 <= end; i += 8)
+        {
+            __m256 new_vx = _mm256_add_ps(_mm256_loadu_ps(vx + i), v_gx);
+            __m256 new_vy = _mm256_add_ps(_mm256_loadu_ps(vy + i), v_gy);
+            _mm256_storeu_ps(vx + i, new_vx);
+            _mm256_storeu_ps(vy + i, new_vy);
+            _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_mul_ps(new_vx, v_dt)));
+            _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(new_vy, v_dt)));
+            _mm256_storeu_ps(life + i, _mm256_sub_ps(_mm256_loadu_ps(life + i), v_dt));
+        }
+#elif defined(SK_SIMD_SSE2)
+        __m128 v_dt = _mm_set1_ps(dt), v_gx = _mm_set1_ps(gx), v_gy = _mm_set1_ps(gy);
+        for (; i + 4 <= end; i += 4)
+        {
+            __m128 new_vx = _mm_add_ps(_mm_loadu_ps(vx + i), v_gx);
+            __m128 new_vy = _mm_add_ps(_mm_loadu_ps(vy + i), v_gy);
+            _mm_storeu_ps(vx + i, new_vx);
+            _mm_storeu_ps(vy + i, new_vy);
+            _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_mul_ps(new_vx, v_dt)));
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(new_vy, v_dt)));
+            _mm_storeu_ps(life + i, _mm_sub_ps(_mm_loadu_ps(life + i), v_dt));
+        }
+#elif defined(SK_SIMD_NEON)
+        float32x4_t v_dt = vdupq_n_f32(dt), v_gx = vdupq_n_f32(gx), v_gy = vdupq_n_f32(gy);
+        for (; i + 4 <= end; i += 4)
+        {
+            float32x4_t new_vx = vaddq_f32(vld1q_f32(vx + i), v_gx);
+            float32x4_t new_vy = vaddq_f32(vld1q_f32(vy + i), v_gy);
+            vst1q_f32(vx + i, new_vx);
+            vst1q_f32(vy + i, new_vy);
+            vst1q_f32(x + i, vaddq_f32(vld1q_f32(x + i), vmulq_f32(new_vx, v_dt)));
+            vst1q_f32(y + i, vaddq_f32(vld1q_f32(y + i), vmulq_f32(new_vy, v_dt)));
+            vst1q_f32(life + i, vsubq_f32(vld1q_f32(life + i), v_dt));
+        }
+#endif
+
+        for (; i < end; i++)
+        {
+            vx[i] += gx;
+            vy[i] += gy;
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            life[i] -= dt;
+        }
+    }
+
+    // Remove particles that have run out of life, moving the last particle
+    // into each gap so the live particles stay at the front of the arrays
+    static void _remove_dead_particles(particle_emitter emitter)
+    {
+        int i = 0;
+        while ( i < emitter->count )
+        {
+            if ( emitter->life[i] > 0 )
+            {
+                i++;
+                continue;
+            }
+
+            int last = --emitter->count;
+            emitter->x[i] = emitter->x[last];
+            emitter->y[i] = emitter->y[last];
+            emitter->vx[i] = emitter->vx[last];
+            emitter->vy[i] = emitter->vy[last];
+            emitter->life[i] = emitter->life[last];
+            emitter->inv_life[i] = emitter->inv_life[last];
+            emitter->clr[i] = emitter->clr[last];
+            emitter->cell[i] = emitter->cell[last];
+        }
+    }
+
+    // Fill in the batch entries for the particles in [start, end)
+    static void _prepare_particle_batch(particle_emitter emitter, int start, int end, float offset_x, float offset_y)
+    {
+        int cell_total = static_cast<int>(emitter->cell_rects.size());
+
+        for (int i = start; i < end; i++)
+        {
+            int cell = emitter->cell[i];
+            const rectangle &part = emitter->cell_rects[cell < cell_total ? cell : 0];
+
+            float w = part.width * emitter->scale;
+            float h = part.height * emitter->scale;
+
+            float *src = &emitter->src_data[i * 4];
+            src[0] = part.x;
+            src[1] = part.y;
+            src[2] = part.width;
+            src[3] = part.height;
+
+            float *dst = &emitter->dst_data[i * 4];
+            dst[0] = emitter->x[i] - w / 2 + offset_x;
+            dst[1] = emitter->y[i] - h / 2 + offset_y;
+            dst[2] = w;
+            dst[3] = h;
+
+            unsigned int clr = emitter->clr[i];
+            if ( emitter->fade )
+            {
+                float alpha = (clr >> 24) * MIN(emitter->life[i] * emitter->inv_life[i], 1.0f);
+                clr = (clr & 0x00ffffff) | static_cast<unsigned int>(alpha) << 24;
+            }
+            emitter->draw_clr[i] = clr;
+        }
+    }
+
+    particle_emitter create_particle_emitter(const string &name, bitmap bmp, int max_particles)
+    {
+        static bool notifier_registered = false;
+
+        if ( INVALID_PTR(bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Attempting to create particle emitter with invalid bitmap";
+            return nullptr;
+        }
+
+        if ( max_particles <= 0 )
+        {
+            LOG(WARNING) << "Attempting to create particle emitter without space for particles";
+            return nullptr;
+        }
+
+        if ( has_particle_emitter(name) ) return particle_emitter_named(name);
+
+        if ( not notifier_registered )
+        {
+            register_free_notifier(_particle_free_notifier);
+            notifier_registered = true;
+        }
+
+        particle_emitter result = new _particle_emitter_data();
+        result->id = PARTICLE_EMITTER_PTR;
+        result->name = name;
+        result->bmp = bmp;
+
+        result->count = 0;
+        result->max_particles = max_particles;
+        result->x.resize(max_particles);
+        result->y.resize(max_particles);
+        result->vx.resize(max_particles);
+        result->vy.resize(max_particles);
+        result->life.resize(max_particles);
+        result->inv_life.resize(max_particles);
+        result->clr.resize(max_particles);
+        result->cell.resize(max_particles);
+
+        result->position = point_at(0, 0);
+        result->rate = 0;
+        result->emit_remainder = 0;
+        result->min_life = 1;
+        result->max_life = 2;
+        result->min_speed = 50;
+        result->max_speed = 100;
+        result->direction = 270;
+        result->spread = 30;
+        result->clr1 = color_white();
+        result->clr2 = color_white();
+        result->first_cell = 0;
+        result->cell_count = 1;
+        result->random_state = static_cast<uint32_t>(rnd(RAND_MAX)) | 1;
+
+        result->gravity = vector_to(0, 0);
+        result->scale = 1;
+        result->fade = true;
+        result->use_threads = false;
+
+        _particle_emitters[to_lower(name)] = result;
+        return result;
+    }
+
+    void free_particle_emitter(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Trying to free particle emitter with invalid pointer";
+            return;
+        }
+
+        notify_of_free(emitter);
+
+        _particle_emitters.erase(to_lower(emitter->name));
+
+        emitter->id = NONE_PTR;
+        delete emitter;
+    }
+
+    void free_all_particle_emitters()
+    {
+        FREE_ALL_FROM_MAP(_particle_emitters, PARTICLE_EMITTER_PTR, free_particle_emitter);
+    }
+
+    bool has_particle_emitter(const string &name)
+    {
+        return _particle_emitters.count(to_lower(name)) > 0;
+    }
+
+    particle_emitter particle_emitter_named(const string &name)
+    {
+        if ( not has_particle_emitter(name) ) return nullptr;
+
+        return _particle_emitters[to_lower(name)];
+    }
+
+    void update_particle_emitter(particle_emitter emitter, float seconds)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to update invalid particle emitter";
+            return;
+        }
+
+        if ( seconds <= 0 ) return;
+
+        int parts = emitter->use_threads ? parallel_part_count(emitter->count, PARTICLES_PER_THREAD) : 1;
+        if ( parts > 1 )
+        {
+            parallel_for(emitter->count, parts, [emitter, seconds] (int /*part*/, int start, int end)
+            {
+                _move_particles(emitter, start, end, seconds);
+            });
+        }
+        else
+            _move_particles(emitter, 0, emitter->count, seconds);
+
+        _remove_dead_particles(emitter);
+
+        emitter->emit_remainder += emitter->rate * seconds;
+        int to_emit = static_cast<int>(emitter->emit_remainder);
+        emitter->emit_remainder -= to_emit;
+
+        emit_particles(emitter, to_emit);
+    }
+
+    void draw_particle_emitter(particle_emitter emitter)
+    {
+        draw_particle_emitter(emitter, option_defaults());
+    }
+
+    void draw_particle_emitter(particle_emitter emitter, const drawing_options &opts)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to draw invalid particle emitter";
+            return;
+        }
+
+        if ( INVALID_PTR(emitter->bmp, BITMAP_PTR) )
+        {
+            LOG(WARNING) << "Attempting to draw particle emitter " << emitter->name << " without a valid bitmap";
+            return;
+        }
+
+        int count = emitter->count;
+        if ( count == 0 ) return;
+
+        sk_drawing_surface *dest = to_surface_ptr(opts.dest);
+        if ( not dest ) return;
+
+        // The camera moves every particle by the same amount
+        float offset_x = 0, offset_y = 0;
+        xy_from_opts(opts, offset_x, offset_y);
+
+        int cell_total = MAX(1, bitmap_cell_count(emitter->bmp));
+        emitter->cell_rects.resize(cell_total);
+        for (int i = 0; i < cell_total; i++)
+        {
+            emitter->cell_rects[i] = bitmap_rectangle_of_cell(emitter->bmp, i);
+        }
+
+        emitter->src_data.resize(count * 4);
+        emitter->dst_data.resize(count * 4);
+        emitter->draw_clr.resize(count);
+
+        int parts = emitter->use_threads ? parallel_part_count(count, PARTICLES_PER_THREAD) : 1;
+        if ( parts > 1 )
+        {
+            parallel_for(count, parts, [emitter, offset_x, offset_y] (int /*part*/, int start, int end)
+            {
+                _prepare_particle_batch(emitter, start, end, offset_x, offset_y);
+            });
+        }
+        else
+            _prepare_particle_batch(emitter, 0, count, offset_x, offset_y);
+
+        sk_draw_bitmap_batch(&emitter->bmp->image.surface, dest, emitter->src_data.data(), emitter->dst_data.data(), emitter->draw_clr.data(), count);
+    }
+
+    void emit_particles(particle_emitter emitter, int count)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to emit particles from invalid particle emitter";
+            return;
+        }
+
+        count = MIN(count, emitter->max_particles - emitter->count);
+
+        uint32_t &state = emitter->random_state;
+        for (int n = 0; n < count; n++)
+        {
+            int i = emitter->count++;
+
+            double angle = deg_to_rad(emitter->direction + (_particle_rnd(state) * 2 - 1) * emitter->spread);
+            float speed = emitter->min_speed + _particle_rnd(state) * (emitter->max_speed - emitter->min_speed);
+            float life = emitter->min_life + _particle_rnd(state) * (emitter->max_life - emitter->min_life);
+
+            emitter->x[i] = emitter->position.x;
+            emitter->y[i] = emitter->position.y;
+            emitter->vx[i] = static_cast<float>(cos(angle)) * speed;
+            emitter->vy[i] = static_cast<float>(sin(angle)) * speed;
+            emitter->life[i] = life;
+            emitter->inv_life[i] = 1 / life;
+
+            float t = _particle_rnd(state);
+            color clr;
+            clr.r = emitter->clr1.r + t * (emitter->clr2.r - emitter->clr1.r);
+            clr.g = emitter->clr1.g + t * (emitter->clr2.g - emitter->clr1.g);
+            clr.b = emitter->clr1.b + t * (emitter->clr2.b - emitter->clr1.b);
+            clr.a = emitter->clr1.a + t * (emitter->clr2.a - emitter->clr1.a);
+            emitter->clr[i] = _pack_color(clr);
+
+            emitter->cell[i] = emitter->first_cell + MIN(static_cast<int>(_particle_rnd(state) * emitter->cell_count), emitter->cell_count - 1);
+        }
+    }
+
+    int particle_emitter_particle_count(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) ) return 0;
+
+        return emitter->count;
+    }
+
+    point_2d particle_emitter_position(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) ) return point_at(0, 0);
+
+        return emitter->position;
+    }
+
+    void particle_emitter_set_position(particle_emitter emitter, const point_2d &value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to move invalid particle emitter";
+            return;
+        }
+
+        emitter->position = value;
+    }
+
+    float particle_emitter_rate(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) ) return 0;
+
+        return emitter->rate;
+    }
+
+    void particle_emitter_set_rate(particle_emitter emitter, float value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set rate of invalid particle emitter";
+            return;
+        }
+
+        emitter->rate = MAX(0.0f, value);
+    }
+
+    vector_2d particle_emitter_gravity(particle_emitter emitter)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) ) return vector_to(0, 0);
+
+        return emitter->gravity;
+    }
+
+    void particle_emitter_set_gravity(particle_emitter emitter, const vector_2d &value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set gravity of invalid particle emitter";
+            return;
+        }
+
+        emitter->gravity = value;
+    }
+
+    void particle_emitter_set_life(particle_emitter emitter, float min_life, float max_life)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set life of invalid particle emitter";
+            return;
+        }
+
+        if ( min_life <= 0 or max_life <= 0 )
+        {
+            LOG(WARNING) << "Particles must live for more than 0 seconds";
+            return;
+        }
+
+        emitter->min_life = min_life;
+        emitter->max_life = max_life;
+    }
+
+    void particle_emitter_set_speed(particle_emitter emitter, float min_speed, float max_speed)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set speed of invalid particle emitter";
+            return;
+        }
+
+        emitter->min_speed = min_speed;
+        emitter->max_speed = max_speed;
+    }
+
+    void particle_emitter_set_direction(particle_emitter emitter, float angle, float spread)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set direction of invalid particle emitter";
+            return;
+        }
+
+        emitter->direction = angle;
+        emitter->spread = spread;
+    }
+
+    void particle_emitter_set_colors(particle_emitter emitter, color clr1, color clr2)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set colors of invalid particle emitter";
+            return;
+        }
+
+        emitter->clr1 = clr1;
+        emitter->clr2 = clr2;
+    }
+
+    void particle_emitter_set_cells(particle_emitter emitter, int first_cell, int cell_count)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set cells of invalid particle emitter";
+            return;
+        }
+
+        if ( first_cell < 0 or cell_count <= 0 )
+        {
+            LOG(WARNING) << "Particle emitter cells must start at 0 or more, and include at least one cell";
+            return;
+        }
+
+        emitter->first_cell = first_cell;
+        emitter->cell_count = cell_count;
+    }
+
+    void particle_emitter_set_scale(particle_emitter emitter, float value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set scale of invalid particle emitter";
+            return;
+        }
+
+        emitter->scale = value;
+    }
+
+    void particle_emitter_set_fade(particle_emitter emitter, bool value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set fade of invalid particle emitter";
+            return;
+        }
+
+        emitter->fade = value;
+    }
+
+    void particle_emitter_set_use_threads(particle_emitter emitter, bool value)
+    {
+        if ( INVALID_PTR(emitter, PARTICLE_EMITTER_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set threading of invalid particle emitter";
+            return;
+        }
+
+        emitter->use_threads = value;
+    }
+}
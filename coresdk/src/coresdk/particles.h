@@ -0,0 +1,314 @@
+//
+//  particles.h
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#ifndef particles_h
+#define particles_h
+
+#include "types.h"
+#include "vector_2d.h"
+#include "drawing_options.h"
+
+#include <string>
+using namespace std;
+namespace splashkit_lib
+{
+    /**
+     * A particle emitter creates and moves a large number of small particles,
+     * such as sparks, smoke or rain. Each particle is drawn using a cell of
+     * the emitter's bitmap, and lives for a short time before it disappears.
+     * Particles are much lighter than sprites, so an emitter can manage
+     * hundreds of thousands of them each frame.
+     *
+     * @attribute class particle_emitter
+     */
+    typedef struct _particle_emitter_data *particle_emitter;
+
+    /**
+     * Create a new particle emitter. The emitter starts with no particles,
+     * and does not emit any until its rate is set or `emit_particles` is
+     * called. Particles move upward at 50 to 100 pixels per second, live
+     * for 1 to 2 seconds, and fade out as they age.
+     *
+     * @param name          The name of the emitter for resource tracking
+     * @param bmp           The bitmap used to draw the particles
+     * @param max_particles The most particles the emitter can hold at once
+     * @returns             A new particle emitter.
+     *
+     * @attribute class particle_emitter
+     * @attribute constructor true
+     */
+    particle_emitter create_particle_emitter(const string &name, bitmap bmp, int max_particles);
+
+    /**
+     * Free the particle emitter, and all of its particles.
+     *
+     * @param emitter The emitter to free
+     *
+     * @attribute class particle_emitter
+     * @attribute destructor true
+     */
+    void free_particle_emitter(particle_emitter emitter);
+
+    /**
+     * Free all of the particle emitters that have been created.
+     *
+     * @attribute static particle_emitters
+     * @attribute method release_all
+     */
+    void free_all_particle_emitters();
+
+    /**
+     * Checks if SplashKit has a particle emitter with the indicated name.
+     *
+     * @param name  The name of the emitter
+     * @returns     True if an emitter with that name has been created
+     *
+     * @attribute static particle_emitters
+     * @attribute method has_particle_emitter
+     */
+    bool has_particle_emitter(const string &name);
+
+    /**
+     * Get the particle emitter created with the indicated name.
+     *
+     * @param name  The name of the emitter to fetch
+     * @returns     The emitter, or nullptr if there is no emitter with that name
+     *
+     * @attribute static particle_emitters
+     * @attribute method get_named
+     */
+    particle_emitter particle_emitter_named(const string &name);
+
+    /**
+     * Move the emitter's particles by the time that has passed, remove the
+     * particles that have run out of life, then emit new particles at the
+     * emitter's rate.
+     *
+     * @param emitter   The emitter to update
+     * @param seconds   The time that has passed, in seconds
+     *
+     * @attribute class particle_emitter
+     * @attribute method update
+     */
+    void update_particle_emitter(particle_emitter emitter, float seconds);
+
+    /**
+     * Draw all of the emitter's particles to the current window. The
+     * particles are sent to the renderer together, rather than one at a time.
+     *
+     * @param emitter The emitter to draw
+     *
+     * @attribute class particle_emitter
+     * @attribute method draw
+     */
+    void draw_particle_emitter(particle_emitter emitter);
+
+    /**
+     * Draw all of the emitter's particles, using the destination and camera
+     * from the drawing options.
+     *
+     * @param emitter   The emitter to draw
+     * @param opts      The drawing options
+     *
+     * @attribute class particle_emitter
+     * @attribute method draw
+     * @attribute suffix with_options
+     */
+    void draw_particle_emitter(particle_emitter emitter, const drawing_options &opts);
+
+    /**
+     * Immediately create a number of particles at the emitter's position.
+     * Particles beyond the emitter's maximum are not created.
+     *
+     * @param emitter   The emitter
+     * @param count     The number of particles to create
+     *
+     * @attribute class particle_emitter
+     * @attribute method emit
+     */
+    void emit_particles(particle_emitter emitter, int count);
+
+    /**
+     * Returns the number of particles that are currently alive.
+     *
+     * @param emitter   The emitter
+     * @returns         The number of live particles
+     *
+     * @attribute class particle_emitter
+     * @attribute getter particle_count
+     */
+    int particle_emitter_particle_count(particle_emitter emitter);
+
+    /**
+     * Returns the location new particles are created at.
+     *
+     * @param emitter   The emitter
+     * @returns         The position of the emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute getter position
+     */
+    point_2d particle_emitter_position(particle_emitter emitter);
+
+    /**
+     * Move the emitter. Particles that have already been emitted are not
+     * moved.
+     *
+     * @param emitter   The emitter to move
+     * @param value     The new position of the emitter
+     *
+     * @attribute class particle_emitter
+     * @attribute setter position
+     */
+    void particle_emitter_set_position(particle_emitter emitter, const point_2d &value);
+
+    /**
+     * Returns the number of particles the emitter creates each second.
+     *
+     * @param emitter   The emitter
+     * @returns         The emission rate, in particles per second
+     *
+     * @attribute class particle_emitter
+     * @attribute getter rate
+     */
+    float particle_emitter_rate(particle_emitter emitter);
+
+    /**
+     * Set the number of particles the emitter creates each second as it is
+     * updated. A rate of 0 stops the emitter creating particles.
+     *
+     * @param emitter   The emitter to change
+     * @param value     The emission rate, in particles per second
+     *
+     * @attribute class particle_emitter
+     * @attribute setter rate
+     */
+    void particle_emitter_set_rate(particle_emitter emitter, float value);
+
+    /**
+     * Returns the acceleration applied to the emitter's particles.
+     *
+     * @param emitter   The emitter
+     * @returns         The gravity, in pixels per second per second
+     *
+     * @attribute class particle_emitter
+     * @attribute getter gravity
+     */
+    vector_2d particle_emitter_gravity(particle_emitter emitter);
+
+    /**
+     * Set the acceleration applied to the emitter's particles.
+     *
+     * @param emitter   The emitter to change
+     * @param value     The gravity, in pixels per second per second
+     *
+     * @attribute class particle_emitter
+     * @attribute setter gravity
+     */
+    void particle_emitter_set_gravity(particle_emitter emitter, const vector_2d &value);
+
+    /**
+     * Set how long new particles live. Each particle lives for a random time
+     * between the minimum and maximum.
+     *
+     * @param emitter   The emitter to change
+     * @param min_life  The shortest life of a particle, in seconds
+     * @param max_life  The longest life of a particle, in seconds
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_life
+     */
+    void particle_emitter_set_life(particle_emitter emitter, float min_life, float max_life);
+
+    /**
+     * Set how fast new particles move. Each particle moves at a random speed
+     * between the minimum and maximum.
+     *
+     * @param emitter   The emitter to change
+     * @param min_speed The slowest speed, in pixels per second
+     * @param max_speed The fastest speed, in pixels per second
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_speed
+     */
+    void particle_emitter_set_speed(particle_emitter emitter, float min_speed, float max_speed);
+
+    /**
+     * Set the direction new particles move in. Each particle moves at a
+     * random angle within spread degrees either side of the direction.
+     *
+     * @param emitter   The emitter to change
+     * @param angle     The direction, in degrees
+     * @param spread    The largest change from the direction, in degrees
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_direction
+     */
+    void particle_emitter_set_direction(particle_emitter emitter, float angle, float spread);
+
+    /**
+     * Set the colours of new particles. Each particle is tinted with a random
+     * colour between the two.
+     *
+     * @param emitter   The emitter to change
+     * @param clr1      One end of the range of colours
+     * @param clr2      The other end of the range of colours
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_colors
+     */
+    void particle_emitter_set_colors(particle_emitter emitter, color clr1, color clr2);
+
+    /**
+     * Set the cells of the bitmap used to draw new particles. Each particle
+     * uses a random cell from the range.
+     *
+     * @param emitter       The emitter to change
+     * @param first_cell    The first cell to use
+     * @param cell_count    The number of cells to use
+     *
+     * @attribute class particle_emitter
+     * @attribute method set_cells
+     */
+    void particle_emitter_set_cells(particle_emitter emitter, int first_cell, int cell_count);
+
+    /**
+     * Set the size particles are drawn at, relative to the bitmap's cells.
+     *
+     * @param emitter   The emitter to change
+     * @param value     The scale of the particles
+     *
+     * @attribute class particle_emitter
+     * @attribute setter scale
+     */
+    void particle_emitter_set_scale(particle_emitter emitter, float value);
+
+    /**
+     * Set if particles fade out as they age.
+     *
+     * @param emitter   The emitter to change
+     * @param value     True to fade particles out over their life
+     *
+     * @attribute class particle_emitter
+     * @attribute setter fade
+     */
+    void particle_emitter_set_fade(particle_emitter emitter, bool value);
+
+    /**
+     * Set if the emitter can share the work of updating and drawing its
+     * particles over several threads. This helps emitters with many
+     * thousands of particles, and is off by default.
+     *
+     * @param emitter   The emitter to change
+     * @param value     True to use several threads
+     *
+     * @attribute class particle_emitter
+     * @attribute setter use_threads
+     */
+    void particle_emitter_set_use_threads(particle_emitter emitter, bool value);
+}
+#endif /* particles_h */
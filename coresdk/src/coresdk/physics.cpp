@@ -7,3 +7,1449 @@
 //
 
 #include "physics.h"
+
+#include "geometry.h"
+#include "images.h"
+#include "resources.h"
+
+#include "backend_types.h"
+#include "utility_functions.h"
+#include "concurrency_utils.h"
+
+#include <cmath>
+#include <map>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+using namespace std;
+namespace splashkit_lib
+{
+    // In collisions
+    vector<vector<point_2d>> _sprite_collision_shape(sprite s);
+
+    // The most steps taken in one update, so a slow frame does not lead to
+    // more steps, and even slower frames
+    #define PHYSICS_MAX_STEPS 5
+
+    // Bodies can overlap by this many pixels before they are pushed apart,
+    // which keeps resting contacts from jittering
+    #define PHYSICS_SLOP 0.5
+
+    // The fraction of the overlap between bodies removed each step
+    #define PHYSICS_BAUMGARTE 0.2
+
+    // Bodies hitting slower than this (in pixels per second) do not bounce
+    #define PHYSICS_BOUNCE_THRESHOLD 30.0
+
+    // Contacts are made when bodies come within this many pixels, so the
+    // solver can stop them just as they touch rather than after they overlap
+    #define PHYSICS_CONTACT_MARGIN 1.0
+
+    // Contacts within this many pixels of a contact from the last step are
+    // treated as the same contact, and start with its impulses
+    #define PHYSICS_CONTACT_MATCH 2.0
+
+    // Prefer the first polygon's edge for contacts unless the other polygon's
+    // edge is this much (in pixels) better, so contacts do not flip between
+    // steps
+    #define PHYSICS_EDGE_TOLERANCE 0.05
+
+    // Below this, the work of a step is not worth spreading over threads
+    #define PHYSICS_PAIRS_PER_THREAD 256
+    #define PHYSICS_CONTACTS_PER_THREAD 128
+
+    // A convex part of a body's shape: either a circle, or a polygon with its
+    // points wound so the outward normal of each edge is (dy, -dx)
+    struct _physics_part
+    {
+        bool is_circle;
+        point_2d center;
+        float radius;
+        vector<point_2d> points;
+        vector<vector_2d> normals;
+        rectangle bounds;
+    };
+
+    struct _physics_body_data
+    {
+        pointer_identifier id;
+        physics_world world;
+        sprite owner;
+
+        // The shape around the body's position with no rotation, and that
+        // shape moved into the world for the current step
+        vector<_physics_part> parts;
+        vector<_physics_part> world_parts;
+        rectangle bounds;
+
+        // The details of the sprite the shape was built from
+        bitmap shape_bitmap;
+        int shape_cell;
+        collision_test_kind shape_kind;
+
+        point_2d position;
+        double angle;
+        vector_2d velocity;
+        double angular_velocity;
+        vector_2d force;
+
+        float mass, inv_mass;
+        float inertia, inv_inertia;
+        float unit_inertia;
+        float restitution;
+        float friction;
+
+        // The body's index in the world during a step
+        int index;
+    };
+
+    struct _physics_contact
+    {
+        point_2d point;
+        double depth;
+        vector_2d ra, rb;
+        double normal_mass, tangent_mass;
+        double bias;
+        double normal_impulse, tangent_impulse;
+    };
+
+    // The contacts between a part of body a and a part of body b. The normal
+    // points from a to b.
+    struct _physics_manifold
+    {
+        physics_body a, b;
+        int part_a, part_b;
+        vector_2d normal;
+        int count;
+        _physics_contact contacts[2];
+        double friction;
+        double restitution;
+    };
+
+    struct _physics_world_data
+    {
+        pointer_identifier id;
+        string name;
+        vector<physics_body> bodies;
+        vector<_physics_manifold> manifolds;
+        vector_2d gravity;
+        float timestep;
+        float remaining_time;
+        int iterations;
+    };
+
+    static map<string, physics_world> _physics_worlds;
+
+    //---------------------------------------------------------------------------
+    // Vector helpers
+    //---------------------------------------------------------------------------
+
+    static inline double _dot(const vector_2d &a, const vector_2d &b)
+    {
+        return a.x * b.x + a.y * b.y;
+    }
+
+    static inline double _cross(const vector_2d &a, const vector_2d &b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    // The velocity of a point at r turning at w radians per second
+    static inline vector_2d _cross(double w, const vector_2d &r)
+    {
+        return vector_to(-w * r.y, w * r.x);
+    }
+
+    static inline vector_2d _between(const point_2d &from, const point_2d &to)
+    {
+        return vector_to(to.x - from.x, to.y - from.y);
+    }
+
+    static inline point_2d _offset(const point_2d &pt, const vector_2d &v, double amount)
+    {
+        return point_at(pt.x + v.x * amount, pt.y + v.y * amount);
+    }
+
+    static inline point_2d _midpoint(const point_2d &a, const point_2d &b)
+    {
+        return point_at((a.x + b.x) / 2, (a.y + b.y) / 2);
+    }
+
+    //---------------------------------------------------------------------------
+    // Body shapes and mass
+    //---------------------------------------------------------------------------
+
+    static _physics_part _circle_part(const point_2d &center, float radius)
+    {
+        _physics_part result;
+        result.is_circle = true;
+        result.center = center;
+        result.radius = abs(radius);
+        return result;
+    }
+
+    // Make a polygon part, returning false if the points have no area
+    static bool _polygon_part(const vector<point_2d> &points, _physics_part &result)
+    {
+        result.is_circle = false;
+        result.radius = 0;
+        result.points.clear();
+        result.normals.clear();
+
+        for (const point_2d &pt : points)
+        {
+            if ( result.points.empty() or pt.x != result.points.back().x or pt.y != result.points.back().y )
+                result.points.push_back(pt);
+        }
+        while ( result.points.size() > 1 and result.points.front().x == result.points.back().x and result.points.front().y == result.points.back().y )
+            result.points.pop_back();
+
+        size_t count = result.points.size();
+        if ( count < 3 ) return false;
+
+        double area = 0, cx = 0, cy = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            const point_2d &p1 = result.points[i], &p2 = result.points[(i + 1) % count];
+            area += p1.x * p2.y - p2.x * p1.y;
+            cx += p1.x;
+            cy += p1.y;
+        }
+
+        if ( abs(area) < 0.01 ) return false;
+        if ( area < 0 ) reverse(result.points.begin(), result.points.end());
+
+        result.center = point_at(cx / count, cy / count);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            vector_2d edge = _between(result.points[i], result.points[(i + 1) % count]);
+            double length = sqrt(_dot(edge, edge));
+            result.normals.push_back(vector_to(edge.y / length, -edge.x / length));
+        }
+
+        return true;
+    }
+
+    // The inertia of the parts around the body's position, for a mass of 1
+    // spread evenly over their area
+    static float _unit_inertia(const vector<_physics_part> &parts)
+    {
+        double area = 0, inertia = 0;
+
+        for (const _physics_part &part : parts)
+        {
+            if ( part.is_circle )
+            {
+                double a = M_PI * part.radius * part.radius;
+                area += a;
+                inertia += a * (0.5 * part.radius * part.radius + part.center.x * part.center.x + part.center.y * part.center.y);
+                continue;
+            }
+
+            // Sum the triangles between the body's position and each edge
+            size_t count = part.points.size();
+            for (size_t i = 0; i < count; i++)
+            {
+                const point_2d &p1 = part.points[i], &p2 = part.points[(i + 1) % count];
+                double cross = p1.x * p2.y - p2.x * p1.y;
+
+                area += cross / 2;
+                inertia += cross * (p1.x * p1.x + p1.y * p1.y + p1.x * p2.x + p1.y * p2.y + p2.x * p2.x + p2.y * p2.y) / 12;
+            }
+        }
+
+        if ( area <= 0 ) return 0;
+        return inertia / area;
+    }
+
+    static void _set_body_mass(physics_body body, float mass)
+    {
+        body->mass = MAX(mass, 0.0f);
+        body->inv_mass = body->mass > 0 ? 1 / body->mass : 0;
+        body->inertia = body->mass * body->unit_inertia;
+        body->inv_inertia = body->inertia > 0 ? 1 / body->inertia : 0;
+    }
+
+    // Build the shape of a sprite's body from its current collision shape,
+    // undoing its rotation around its anchor point
+    static void _build_sprite_shape(physics_body body)
+    {
+        sprite s = body->owner;
+
+        body->shape_bitmap = sprite_collision_bitmap(s);
+        body->shape_cell = sprite_current_cell(s);
+        body->shape_kind = sprite_collision_kind(s);
+
+        vector<vector<point_2d>> world_parts;
+        if ( body->shape_kind != AABB_COLLISIONS )
+            world_parts = _sprite_collision_shape(s);
+
+        // Use the sprite's box when there are no pixels to outline
+        if ( world_parts.empty() )
+        {
+            quad q = quad_from(rectangle_from(0, 0, sprite_width(s), sprite_height(s)), sprite_location_matrix(s));
+            world_parts.push_back({ q.points[0], q.points[1], q.points[3], q.points[2] });
+        }
+
+        point_2d origin = sprite_anchor_position(s);
+        double angle = deg_to_rad(sprite_rotation(s));
+        double c = cos(-angle), sn = sin(-angle);
+
+        body->parts.clear();
+        for (const vector<point_2d> &world_part : world_parts)
+        {
+            vector<point_2d> local;
+            local.reserve(world_part.size());
+
+            for (const point_2d &pt : world_part)
+            {
+                double dx = pt.x - origin.x, dy = pt.y - origin.y;
+                local.push_back(point_at(c * dx - sn * dy, sn * dx + c * dy));
+            }
+
+            _physics_part part;
+            if ( _polygon_part(local, part) ) body->parts.push_back(part);
+        }
+
+        body->unit_inertia = _unit_inertia(body->parts);
+    }
+
+    static rectangle _part_bounds(const _physics_part &part)
+    {
+        if ( part.is_circle )
+            return rectangle_from(part.center.x - part.radius, part.center.y - part.radius, part.radius * 2, part.radius * 2);
+
+        float left = part.points[0].x, right = left, top = part.points[0].y, bottom = top;
+        for (const point_2d &pt : part.points)
+        {
+            left = MIN(left, pt.x);
+            right = MAX(right, pt.x);
+            top = MIN(top, pt.y);
+            bottom = MAX(bottom, pt.y);
+        }
+        return rectangle_from(left, top, right - left, bottom - top);
+    }
+
+    // Move the body's shape to its position and rotation in the world
+    static void _update_world_shape(physics_body body)
+    {
+        double c = cos(body->angle), s = sin(body->angle);
+
+        auto to_world = [&] (const point_2d &pt)
+        {
+            return point_at(c * pt.x - s * pt.y + body->position.x, s * pt.x + c * pt.y + body->position.y);
+        };
+
+        body->world_parts.resize(body->parts.size());
+
+        for (size_t i = 0; i < body->parts.size(); i++)
+        {
+            const _physics_part &part = body->parts[i];
+            _physics_part &world_part = body->world_parts[i];
+
+            world_part.is_circle = part.is_circle;
+            world_part.radius = part.radius;
+            world_part.center = to_world(part.center);
+            world_part.points.resize(part.points.size());
+            world_part.normals.resize(part.normals.size());
+
+            for (size_t j = 0; j < part.points.size(); j++)
+            {
+                world_part.points[j] = to_world(part.points[j]);
+                world_part.normals[j] = vector_to(c * part.normals[j].x - s * part.normals[j].y, s * part.normals[j].x + c * part.normals[j].y);
+            }
+
+            world_part.bounds = _part_bounds(world_part);
+
+            if ( i == 0 )
+                body->bounds = world_part.bounds;
+            else
+            {
+                float right = MAX(rectangle_right(body->bounds), rectangle_right(world_part.bounds));
+                float bottom = MAX(rectangle_bottom(body->bounds), rectangle_bottom(world_part.bounds));
+                body->bounds.x = MIN(body->bounds.x, world_part.bounds.x);
+                body->bounds.y = MIN(body->bounds.y, world_part.bounds.y);
+                body->bounds.width = right - body->bounds.x;
+                body->bounds.height = bottom - body->bounds.y;
+            }
+        }
+
+        if ( body->parts.empty() )
+            body->bounds = rectangle_from(body->position.x, body->position.y, 0, 0);
+    }
+
+    //---------------------------------------------------------------------------
+    // Contacts between parts
+    //---------------------------------------------------------------------------
+
+    static bool _collide_circles(const _physics_part &a, const _physics_part &b, _physics_manifold &m)
+    {
+        vector_2d d = _between(a.center, b.center);
+        double radius = a.radius + b.radius;
+        double dist_sq = _dot(d, d);
+
+        if ( dist_sq > (radius + PHYSICS_CONTACT_MARGIN) * (radius + PHYSICS_CONTACT_MARGIN) ) return false;
+
+        double dist = sqrt(dist_sq);
+        m.normal = dist > 0 ? vector_to(d.x / dist, d.y / dist) : vector_to(0, 1);
+        m.count = 1;
+        m.contacts[0].depth = radius - dist;
+        m.contacts[0].point = _midpoint(_offset(a.center, m.normal, a.radius), _offset(b.center, m.normal, -b.radius));
+        return true;
+    }
+
+    // Contacts between a polygon and a circle, with the normal pointing from
+    // the polygon to the circle
+    static bool _collide_polygon_circle(const _physics_part &poly, const _physics_part &circ, _physics_manifold &m)
+    {
+        size_t count = poly.points.size();
+        size_t edge = 0;
+        double separation = -numeric_limits<double>::max();
+
+        for (size_t i = 0; i < count; i++)
+        {
+            double s = _dot(poly.normals[i], _between(poly.points[i], circ.center));
+            if ( s > circ.radius + PHYSICS_CONTACT_MARGIN ) return false;
+            if ( s > separation )
+            {
+                separation = s;
+                edge = i;
+            }
+        }
+
+        const point_2d &p1 = poly.points[edge], &p2 = poly.points[(edge + 1) % count];
+        point_2d closest;
+        double depth;
+
+        // Check if the circle is past either end of the edge
+        double u1 = _dot(_between(p1, circ.center), _between(p1, p2));
+        double u2 = _dot(_between(p2, circ.center), _between(p2, p1));
+
+        if ( separation > 0 and (u1 <= 0 or u2 <= 0) )
+        {
+            closest = u1 <= 0 ? p1 : p2;
+            vector_2d d = _between(closest, circ.center);
+            double dist = sqrt(_dot(d, d));
+
+            if ( dist > circ.radius + PHYSICS_CONTACT_MARGIN ) return false;
+
+            m.normal = vector_to(d.x / dist, d.y / dist);
+            depth = circ.radius - dist;
+        }
+        else
+        {
+            m.normal = poly.normals[edge];
+            closest = _offset(circ.center, m.normal, -separation);
+            depth = circ.radius - separation;
+        }
+
+        m.count = 1;
+        m.contacts[0].depth = depth;
+        m.contacts[0].point = _midpoint(closest, _offset(circ.center, m.normal, -circ.radius));
+        return true;
+    }
+
+    // The edge of a with the greatest gap to b, and the size of the gap.
+    // Overlapping polygons have a gap below zero on every edge.
+    static double _max_separation(const _physics_part &a, const _physics_part &b, size_t &edge)
+    {
+        double result = -numeric_limits<double>::max();
+
+        for (size_t i = 0; i < a.points.size(); i++)
+        {
+            double separation = numeric_limits<double>::max();
+            for (const point_2d &pt : b.points)
+            {
+                separation = MIN(separation, _dot(a.normals[i], _between(a.points[i], pt)));
+            }
+
+            if ( separation > result )
+            {
+                result = separation;
+                edge = i;
+            }
+        }
+
+        return result;
+    }
+
+    // Clip the segment to the side of the line where dot(n, pt) <= offset,
+    // returning the number of points left
+    static int _clip_segment(point_2d result[2], const point_2d segment[2], const vector_2d &n, double offset)
+    {
+        int count = 0;
+        double d0 = n.x * segment[0].x + n.y * segment[0].y - offset;
+        double d1 = n.x * segment[1].x + n.y * segment[1].y - offset;
+
+        if ( d0 <= 0 ) result[count++] = segment[0];
+        if ( d1 <= 0 ) result[count++] = segment[1];
+
+        if ( d0 * d1 < 0 )
+        {
+            double t = d0 / (d0 - d1);
+            result[count++] = point_at(segment[0].x + t * (segment[1].x - segment[0].x), segment[0].y + t * (segment[1].y - segment[0].y));
+        }
+
+        return count;
+    }
+
+    // Contacts between two polygons. The edge with the least overlap is the
+    // reference edge, and the edge of the other polygon facing it is clipped
+    // to the sides of the reference edge to find up to two contact points.
+    static bool _collide_polygons(const _physics_part &a, const _physics_part &b, _physics_manifold &m)
+    {
+        size_t edge_a = 0, edge_b = 0;
+
+        double separation_a = _max_separation(a, b, edge_a);
+        if ( separation_a > PHYSICS_CONTACT_MARGIN ) return false;
+
+        double separation_b = _max_separation(b, a, edge_b);
+        if ( separation_b > PHYSICS_CONTACT_MARGIN ) return false;
+
+        const _physics_part *ref = &a, *inc = &b;
+        size_t edge = edge_a;
+        bool flip = false;
+
+        if ( separation_b > separation_a + PHYSICS_EDGE_TOLERANCE )
+        {
+            ref = &b;
+            inc = &a;
+            edge = edge_b;
+            flip = true;
+        }
+
+        vector_2d n = ref->normals[edge];
+
+        // Find the incident edge, facing most against the reference edge
+        size_t inc_edge = 0;
+        double min_dot = numeric_limits<double>::max();
+        for (size_t i = 0; i < inc->normals.size(); i++)
+        {
+            double d = _dot(n, inc->normals[i]);
+            if ( d < min_dot )
+            {
+                min_dot = d;
+                inc_edge = i;
+            }
+        }
+
+        point_2d incident[2] = { inc->points[inc_edge], inc->points[(inc_edge + 1) % inc->points.size()] };
+
+        const point_2d &r1 = ref->points[edge], &r2 = ref->points[(edge + 1) % ref->points.size()];
+        vector_2d t = unit_vector(_between(r1, r2));
+
+        point_2d clip1[2], clip2[2];
+        if ( _clip_segment(clip1, incident, vector_to(-t.x, -t.y), -(t.x * r1.x + t.y * r1.y)) < 2 ) return false;
+        if ( _clip_segment(clip2, clip1, t, t.x * r2.x + t.y * r2.y) < 2 ) return false;
+
+        double front = n.x * r1.x + n.y * r1.y;
+
+        m.count = 0;
+        for (int i = 0; i < 2; i++)
+        {
+            double separation = n.x * clip2[i].x + n.y * clip2[i].y - front;
+            if ( separation <= PHYSICS_CONTACT_MARGIN )
+            {
+                m.contacts[m.count].depth = -separation;
+                m.contacts[m.count].point = _offset(clip2[i], n, -separation / 2);
+                m.count++;
+            }
+        }
+
+        m.normal = flip ? vector_to(-n.x, -n.y) : n;
+        return m.count > 0;
+    }
+
+    static bool _collide_parts(const _physics_part &a, const _physics_part &b, _physics_manifold &m)
+    {
+        if ( a.is_circle and b.is_circle ) return _collide_circles(a, b, m);
+        if ( not a.is_circle and b.is_circle ) return _collide_polygon_circle(a, b, m);
+        if ( a.is_circle )
+        {
+            if ( not _collide_polygon_circle(b, a, m) ) return false;
+            m.normal = vector_to(-m.normal.x, -m.normal.y);
+            return true;
+        }
+        return _collide_polygons(a, b, m);
+    }
+
+    static inline bool _bounds_overlap(const rectangle &r1, const rectangle &r2)
+    {
+        return r1.x <= r2.x + r2.width and r2.x <= r1.x + r1.width and r1.y <= r2.y + r2.height and r2.y <= r1.y + r1.height;
+    }
+
+    // Add the contacts between each part of the two bodies
+    static void _collide_bodies(physics_body a, physics_body b, vector<_physics_manifold> &result)
+    {
+        _physics_manifold m;
+        m.a = a;
+        m.b = b;
+        m.friction = sqrt(a->friction * b->friction);
+        m.restitution = MAX(a->restitution, b->restitution);
+
+        for (size_t i = 0; i < a->world_parts.size(); i++)
+        {
+            const _physics_part &part_a = a->world_parts[i];
+            if ( not _bounds_overlap(part_a.bounds, b->bounds) ) continue;
+
+            for (size_t j = 0; j < b->world_parts.size(); j++)
+            {
+                const _physics_part &part_b = b->world_parts[j];
+                if ( not _bounds_overlap(part_a.bounds, part_b.bounds) ) continue;
+
+                m.part_a = i;
+                m.part_b = j;
+
+                if ( _collide_parts(part_a, part_b, m) )
+                {
+                    for (int i = 0; i < m.count; i++)
+                    {
+                        m.contacts[i].normal_impulse = 0;
+                        m.contacts[i].tangent_impulse = 0;
+                    }
+                    result.push_back(m);
+                }
+            }
+        }
+    }
+
+    // Find the pairs of bodies whose bounds overlap by sorting them along x
+    // and sweeping across, keeping the bodies still in range
+    static vector<pair<physics_body, physics_body>> _physics_candidates(const vector<physics_body> &bodies)
+    {
+        vector<physics_body> sorted = bodies;
+        sort(sorted.begin(), sorted.end(), [] (physics_body a, physics_body b) { return a->bounds.x < b->bounds.x; });
+
+        vector<pair<physics_body, physics_body>> result;
+        vector<physics_body> active;
+
+        for (physics_body body : sorted)
+        {
+            size_t keep = 0;
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                if ( active[i]->bounds.x + active[i]->bounds.width >= body->bounds.x )
+                    active[keep++] = active[i];
+            }
+            active.resize(keep);
+
+            for (physics_body other : active)
+            {
+                // Bodies that do not move cannot push each other
+                if ( other->inv_mass == 0 and body->inv_mass == 0 ) continue;
+                if ( other->bounds.y > body->bounds.y + body->bounds.height or body->bounds.y > other->bounds.y + other->bounds.height ) continue;
+
+                // Keep each pair in the same order every step, so their
+                // contacts can be matched with the last step's
+                if ( other->index < body->index )
+                    result.push_back({ other, body });
+                else
+                    result.push_back({ body, other });
+            }
+
+            active.push_back(body);
+        }
+
+        return result;
+    }
+
+    static inline bool _manifold_before(const _physics_manifold &m1, const _physics_manifold &m2)
+    {
+        if ( m1.a->index != m2.a->index ) return m1.a->index < m2.a->index;
+        if ( m1.b->index != m2.b->index ) return m1.b->index < m2.b->index;
+        if ( m1.part_a != m2.part_a ) return m1.part_a < m2.part_a;
+        return m1.part_b < m2.part_b;
+    }
+
+    // Start each contact with the impulses of the matching contact from the
+    // last step. This lets the solver build on the last step's answer, which
+    // keeps stacks of bodies steady. Both lists are sorted by their bodies
+    // and parts.
+    static void _match_contacts(vector<_physics_manifold> &manifolds, const vector<_physics_manifold> &previous)
+    {
+        size_t p = 0;
+
+        for (_physics_manifold &m : manifolds)
+        {
+            while ( p < previous.size() and _manifold_before(previous[p], m) ) p++;
+            if ( p == previous.size() ) return;
+
+            const _physics_manifold &old = previous[p];
+            if ( _manifold_before(m, old) ) continue;
+
+            for (int i = 0; i < m.count; i++)
+            {
+                for (int j = 0; j < old.count; j++)
+                {
+                    vector_2d d = _between(old.contacts[j].point, m.contacts[i].point);
+                    if ( _dot(d, d) <= PHYSICS_CONTACT_MATCH * PHYSICS_CONTACT_MATCH )
+                    {
+                        m.contacts[i].normal_impulse = old.contacts[j].normal_impulse;
+                        m.contacts[i].tangent_impulse = old.contacts[j].tangent_impulse;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------
+    // Solver
+    //---------------------------------------------------------------------------
+
+    static inline vector_2d _point_velocity(physics_body body, const vector_2d &r)
+    {
+        vector_2d spin = _cross(body->angular_velocity, r);
+        return vector_to(body->velocity.x + spin.x, body->velocity.y + spin.y);
+    }
+
+    // Apply the impulse to b, and the opposite impulse to a. Bodies that do
+    // not move are never written to, as they are shared between islands.
+    static inline void _apply_contact_impulse(_physics_manifold &m, const _physics_contact &c, const vector_2d &impulse)
+    {
+        if ( m.a->inv_mass > 0 )
+        {
+            m.a->velocity.x -= impulse.x * m.a->inv_mass;
+            m.a->velocity.y -= impulse.y * m.a->inv_mass;
+            m.a->angular_velocity -= m.a->inv_inertia * _cross(c.ra, impulse);
+        }
+        if ( m.b->inv_mass > 0 )
+        {
+            m.b->velocity.x += impulse.x * m.b->inv_mass;
+            m.b->velocity.y += impulse.y * m.b->inv_mass;
+            m.b->angular_velocity += m.b->inv_inertia * _cross(c.rb, impulse);
+        }
+    }
+
+    static inline vector_2d _relative_velocity(const _physics_manifold &m, const _physics_contact &c)
+    {
+        vector_2d va = _point_velocity(m.a, c.ra), vb = _point_velocity(m.b, c.rb);
+        return vector_to(vb.x - va.x, vb.y - va.y);
+    }
+
+    static void _prepare_manifold(_physics_manifold &m, double dt)
+    {
+        vector_2d n = m.normal, t = vector_to(-n.y, n.x);
+        physics_body a = m.a, b = m.b;
+
+        for (int i = 0; i < m.count; i++)
+        {
+            _physics_contact &c = m.contacts[i];
+
+            c.ra = _between(a->position, c.point);
+            c.rb = _between(b->position, c.point);
+
+            double rna = _cross(c.ra, n), rnb = _cross(c.rb, n);
+            double kn = a->inv_mass + b->inv_mass + a->inv_inertia * rna * rna + b->inv_inertia * rnb * rnb;
+            c.normal_mass = kn > 0 ? 1 / kn : 0;
+
+            double rta = _cross(c.ra, t), rtb = _cross(c.rb, t);
+            double kt = a->inv_mass + b->inv_mass + a->inv_inertia * rta * rta + b->inv_inertia * rtb * rtb;
+            c.tangent_mass = kt > 0 ? 1 / kt : 0;
+
+            // Let bodies that are not yet touching close the gap, push
+            // overlapping bodies apart, and bounce them if they hit fast enough
+            if ( c.depth < 0 )
+                c.bias = c.depth / dt;
+            else
+                c.bias = PHYSICS_BAUMGARTE / dt * MAX(0.0, c.depth - PHYSICS_SLOP);
+
+            double vn = _dot(_relative_velocity(m, c), n);
+            if ( vn < -PHYSICS_BOUNCE_THRESHOLD )
+                c.bias = MAX(c.bias, -m.restitution * vn);
+        }
+    }
+
+    // Apply last step's impulses, so a resting contact starts from where it
+    // finished rather than from nothing
+    static void _warm_start_manifold(_physics_manifold &m)
+    {
+        vector_2d n = m.normal, t = vector_to(-n.y, n.x);
+
+        for (int i = 0; i < m.count; i++)
+        {
+            const _physics_contact &c = m.contacts[i];
+            _apply_contact_impulse(m, c, vector_to(n.x * c.normal_impulse + t.x * c.tangent_impulse, n.y * c.normal_impulse + t.y * c.tangent_impulse));
+        }
+    }
+
+    static void _solve_manifold(_physics_manifold &m)
+    {
+        vector_2d n = m.normal, t = vector_to(-n.y, n.x);
+
+        for (int i = 0; i < m.count; i++)
+        {
+            _physics_contact &c = m.contacts[i];
+
+            // Friction, limited by how hard the bodies are pressed together
+            double vt = _dot(_relative_velocity(m, c), t);
+            double max_friction = m.friction * c.normal_impulse;
+            double old_impulse = c.tangent_impulse;
+            c.tangent_impulse = MAX(-max_friction, MIN(old_impulse - vt * c.tangent_mass, max_friction));
+
+            double lambda = c.tangent_impulse - old_impulse;
+            _apply_contact_impulse(m, c, vector_to(t.x * lambda, t.y * lambda));
+
+            // Stop the bodies moving into each other, but never pull them
+            double vn = _dot(_relative_velocity(m, c), n);
+            old_impulse = c.normal_impulse;
+            c.normal_impulse = MAX(old_impulse + c.normal_mass * (c.bias - vn), 0.0);
+
+            lambda = c.normal_impulse - old_impulse;
+            _apply_contact_impulse(m, c, vector_to(n.x * lambda, n.y * lambda));
+        }
+    }
+
+    // Group the contacts into islands of bodies that touch, through bodies
+    // that move. Each island can then be solved on its own thread.
+    static vector<vector<int>> _physics_islands(const vector<physics_body> &bodies, const vector<_physics_manifold> &manifolds)
+    {
+        vector<int> parent(bodies.size());
+        iota(parent.begin(), parent.end(), 0);
+
+        auto find = [&] (int idx)
+        {
+            while ( parent[idx] != idx )
+            {
+                parent[idx] = parent[parent[idx]];
+                idx = parent[idx];
+            }
+            return idx;
+        };
+
+        for (const _physics_manifold &m : manifolds)
+        {
+            if ( m.a->inv_mass > 0 and m.b->inv_mass > 0 )
+                parent[find(m.a->index)] = find(m.b->index);
+        }
+
+        vector<int> island_of(bodies.size(), -1);
+        vector<vector<int>> result;
+
+        for (size_t i = 0; i < manifolds.size(); i++)
+        {
+            const _physics_manifold &m = manifolds[i];
+            int root = find(m.a->inv_mass > 0 ? m.a->index : m.b->index);
+
+            if ( island_of[root] < 0 )
+            {
+                island_of[root] = result.size();
+                result.push_back({});
+            }
+
+            result[island_of[root]].push_back(i);
+        }
+
+        return result;
+    }
+
+    //---------------------------------------------------------------------------
+    // Stepping the world
+    //---------------------------------------------------------------------------
+
+    static void _step_physics_world(physics_world world)
+    {
+        vector<physics_body> &bodies = world->bodies;
+        double dt = world->timestep;
+
+        for (size_t i = 0; i < bodies.size(); i++)
+        {
+            physics_body body = bodies[i];
+            body->index = i;
+
+            if ( body->inv_mass > 0 )
+            {
+                body->velocity.x += (world->gravity.x + body->force.x * body->inv_mass) * dt;
+                body->velocity.y += (world->gravity.y + body->force.y * body->inv_mass) * dt;
+            }
+            body->force = vector_to(0, 0);
+
+            _update_world_shape(body);
+        }
+
+        // Find the contacts, spreading the pairs over threads when there are
+        // lots of them
+        vector<pair<physics_body, physics_body>> candidates = _physics_candidates(bodies);
+
+        int pair_count = candidates.size();
+        int parts = parallel_part_count(pair_count, PHYSICS_PAIRS_PER_THREAD);
+        vector<vector<_physics_manifold>> part_manifolds(parts);
+
+        parallel_for(pair_count, parts, [&] (int part, int start, int end)
+        {
+            for (int i = start; i < end; i++)
+            {
+                _collide_bodies(candidates[i].first, candidates[i].second, part_manifolds[part]);
+            }
+        });
+
+        vector<_physics_manifold> &manifolds = world->manifolds;
+        vector<_physics_manifold> previous;
+        previous.swap(manifolds);
+
+        for (vector<_physics_manifold> &part : part_manifolds)
+        {
+            manifolds.insert(manifolds.end(), part.begin(), part.end());
+        }
+
+        sort(manifolds.begin(), manifolds.end(), _manifold_before);
+        _match_contacts(manifolds, previous);
+
+        // Solve each island, with the islands spread over threads
+        vector<vector<int>> islands = _physics_islands(bodies, manifolds);
+
+        int island_count = islands.size();
+        parts = MIN(parallel_part_count(manifolds.size(), PHYSICS_CONTACTS_PER_THREAD), MAX(island_count, 1));
+
+        parallel_for(island_count, parts, [&] (int /*part*/, int start, int end)
+        {
+            for (int i = start; i < end; i++)
+            {
+                for (int idx : islands[i]) _prepare_manifold(manifolds[idx], dt);
+                for (int idx : islands[i]) _warm_start_manifold(manifolds[idx]);
+
+                for (int iteration = 0; iteration < world->iterations; iteration++)
+                {
+                    for (int idx : islands[i]) _solve_manifold(manifolds[idx]);
+                }
+            }
+        });
+
+        for (physics_body body : bodies)
+        {
+            body->position.x += body->velocity.x * dt;
+            body->position.y += body->velocity.y * dt;
+            body->angle += body->angular_velocity * dt;
+        }
+    }
+
+    // Pick up any changes the program has made to the sprites since the last
+    // update
+    static void _read_sprite(physics_body body)
+    {
+        sprite s = body->owner;
+
+        body->position = sprite_anchor_position(s);
+        body->angle = deg_to_rad(sprite_rotation(s));
+
+        if ( sprite_collision_bitmap(s) != body->shape_bitmap or sprite_current_cell(s) != body->shape_cell or sprite_collision_kind(s) != body->shape_kind )
+        {
+            _build_sprite_shape(body);
+            _set_body_mass(body, body->mass);
+        }
+
+        if ( sprite_mass(s) != body->mass )
+            _set_body_mass(body, sprite_mass(s));
+    }
+
+    static void _write_sprite(physics_body body)
+    {
+        point_2d anchor = sprite_anchor_point(body->owner);
+
+        sprite_set_position(body->owner, point_at(body->position.x - anchor.x, body->position.y - anchor.y));
+        sprite_set_rotation(body->owner, rad_to_deg(body->angle));
+    }
+
+    void update_physics_world(physics_world world, float seconds)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to update invalid physics world";
+            return;
+        }
+
+        for (physics_body body : world->bodies)
+        {
+            if ( body->owner ) _read_sprite(body);
+        }
+
+        world->remaining_time += seconds;
+
+        int steps = 0;
+        while ( world->remaining_time >= world->timestep and steps < PHYSICS_MAX_STEPS )
+        {
+            _step_physics_world(world);
+            world->remaining_time -= world->timestep;
+            steps++;
+        }
+
+        // Drop the time the world could not keep up with
+        if ( world->remaining_time >= world->timestep )
+            world->remaining_time = fmod(world->remaining_time, world->timestep);
+
+        for (physics_body body : world->bodies)
+        {
+            if ( body->owner ) _write_sprite(body);
+        }
+    }
+
+    //---------------------------------------------------------------------------
+    // Worlds
+    //---------------------------------------------------------------------------
+
+    // Free the bodies that follow a sprite when that sprite is freed
+    static void _physics_free_notifier(void *resource)
+    {
+        for (auto &entry : _physics_worlds)
+        {
+            vector<physics_body> to_free;
+            for (physics_body body : entry.second->bodies)
+            {
+                if ( body->owner == resource ) to_free.push_back(body);
+            }
+
+            for (physics_body body : to_free)
+            {
+                free_physics_body(body);
+            }
+        }
+    }
+
+    physics_world create_physics_world(const string &name)
+    {
+        static bool notifier_registered = false;
+
+        if ( has_physics_world(name) ) return physics_world_named(name);
+
+        if ( not notifier_registered )
+        {
+            register_free_notifier(_physics_free_notifier);
+            notifier_registered = true;
+        }
+
+        physics_world result = new _physics_world_data();
+        result->id = PHYSICS_WORLD_PTR;
+        result->name = name;
+        result->gravity = vector_to(0, 0);
+        result->timestep = 1.0f / 60.0f;
+        result->remaining_time = 0;
+        result->iterations = 10;
+
+        _physics_worlds[to_lower(name)] = result;
+        return result;
+    }
+
+    void free_physics_world(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Trying to free physics world with invalid pointer";
+            return;
+        }
+
+        while ( not world->bodies.empty() )
+        {
+            free_physics_body(world->bodies.back());
+        }
+
+        notify_of_free(world);
+
+        _physics_worlds.erase(to_lower(world->name));
+
+        world->id = NONE_PTR;
+        delete world;
+    }
+
+    void free_all_physics_worlds()
+    {
+        FREE_ALL_FROM_MAP(_physics_worlds, PHYSICS_WORLD_PTR, free_physics_world);
+    }
+
+    bool has_physics_world(const string &name)
+    {
+        return _physics_worlds.count(to_lower(name)) > 0;
+    }
+
+    physics_world physics_world_named(const string &name)
+    {
+        if ( not has_physics_world(name) ) return nullptr;
+
+        return _physics_worlds[to_lower(name)];
+    }
+
+    vector_2d physics_world_gravity(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get gravity of invalid physics world";
+            return vector_to(0, 0);
+        }
+
+        return world->gravity;
+    }
+
+    void physics_world_set_gravity(physics_world world, const vector_2d &value)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set gravity of invalid physics world";
+            return;
+        }
+
+        world->gravity = value;
+    }
+
+    float physics_world_timestep(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get timestep of invalid physics world";
+            return 0;
+        }
+
+        return world->timestep;
+    }
+
+    void physics_world_set_timestep(physics_world world, float value)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set timestep of invalid physics world";
+            return;
+        }
+
+        if ( value <= 0 )
+        {
+            LOG(WARNING) << "Physics world timestep must be greater than 0";
+            return;
+        }
+
+        world->timestep = value;
+    }
+
+    int physics_world_iterations(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get iterations of invalid physics world";
+            return 0;
+        }
+
+        return world->iterations;
+    }
+
+    void physics_world_set_iterations(physics_world world, int value)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set iterations of invalid physics world";
+            return;
+        }
+
+        world->iterations = MAX(value, 1);
+    }
+
+    int physics_world_body_count(physics_world world)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get body count of invalid physics world";
+            return 0;
+        }
+
+        return world->bodies.size();
+    }
+
+    //---------------------------------------------------------------------------
+    // Bodies
+    //---------------------------------------------------------------------------
+
+    static physics_body _create_physics_body(physics_world world, const point_2d &position)
+    {
+        physics_body result = new _physics_body_data();
+        result->id = PHYSICS_BODY_PTR;
+        result->world = world;
+        result->owner = nullptr;
+        result->shape_bitmap = nullptr;
+        result->shape_cell = -1;
+        result->shape_kind = AABB_COLLISIONS;
+        result->position = position;
+        result->angle = 0;
+        result->velocity = vector_to(0, 0);
+        result->angular_velocity = 0;
+        result->force = vector_to(0, 0);
+        result->unit_inertia = 0;
+        result->restitution = 0.2f;
+        result->friction = 0.4f;
+        result->index = 0;
+
+        world->bodies.push_back(result);
+        return result;
+    }
+
+    physics_body create_physics_body(physics_world world, sprite s)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to create physics body in invalid physics world";
+            return nullptr;
+        }
+
+        if ( not s )
+        {
+            LOG(WARNING) << "Attempting to create physics body for invalid sprite";
+            return nullptr;
+        }
+
+        physics_body result = _create_physics_body(world, sprite_anchor_position(s));
+        result->owner = s;
+        result->angle = deg_to_rad(sprite_rotation(s));
+
+        _build_sprite_shape(result);
+        _set_body_mass(result, sprite_mass(s));
+
+        return result;
+    }
+
+    physics_body create_physics_body(physics_world world, const circle &c, float mass)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to create physics body in invalid physics world";
+            return nullptr;
+        }
+
+        physics_body result = _create_physics_body(world, c.center);
+        result->parts.push_back(_circle_part(point_at(0, 0), c.radius));
+        result->unit_inertia = _unit_inertia(result->parts);
+        _set_body_mass(result, mass);
+
+        return result;
+    }
+
+    physics_body create_physics_body(physics_world world, const rectangle &rect, float mass)
+    {
+        if ( INVALID_PTR(world, PHYSICS_WORLD_PTR) )
+        {
+            LOG(WARNING) << "Attempting to create physics body in invalid physics world";
+            return nullptr;
+        }
+
+        physics_body result = _create_physics_body(world, rectangle_center(rect));
+
+        float w = abs(rect.width) / 2, h = abs(rect.height) / 2;
+        _physics_part part;
+        if ( _polygon_part({ point_at(-w, -h), point_at(w, -h), point_at(w, h), point_at(-w, h) }, part) )
+            result->parts.push_back(part);
+
+        result->unit_inertia = _unit_inertia(result->parts);
+        _set_body_mass(result, mass);
+
+        return result;
+    }
+
+    void free_physics_body(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Trying to free physics body with invalid pointer";
+            return;
+        }
+
+        notify_of_free(body);
+
+        vector<physics_body> &bodies = body->world->bodies;
+        bodies.erase(remove(bodies.begin(), bodies.end(), body), bodies.end());
+
+        vector<_physics_manifold> &manifolds = body->world->manifolds;
+        manifolds.erase(remove_if(manifolds.begin(), manifolds.end(), [body] (const _physics_manifold &m) { return m.a == body or m.b == body; }), manifolds.end());
+
+        body->id = NONE_PTR;
+        delete body;
+    }
+
+    sprite physics_body_sprite(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get sprite of invalid physics body";
+            return nullptr;
+        }
+
+        return body->owner;
+    }
+
+    point_2d physics_body_position(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get position of invalid physics body";
+            return point_at(0, 0);
+        }
+
+        return body->position;
+    }
+
+    void physics_body_set_position(physics_body body, const point_2d &value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set position of invalid physics body";
+            return;
+        }
+
+        body->position = value;
+        if ( body->owner ) _write_sprite(body);
+    }
+
+    float physics_body_rotation(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get rotation of invalid physics body";
+            return 0;
+        }
+
+        return rad_to_deg(body->angle);
+    }
+
+    void physics_body_set_rotation(physics_body body, float value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set rotation of invalid physics body";
+            return;
+        }
+
+        body->angle = deg_to_rad(value);
+        if ( body->owner ) _write_sprite(body);
+    }
+
+    vector_2d physics_body_velocity(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get velocity of invalid physics body";
+            return vector_to(0, 0);
+        }
+
+        return body->velocity;
+    }
+
+    void physics_body_set_velocity(physics_body body, const vector_2d &value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set velocity of invalid physics body";
+            return;
+        }
+
+        body->velocity = value;
+    }
+
+    float physics_body_angular_velocity(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get angular velocity of invalid physics body";
+            return 0;
+        }
+
+        return rad_to_deg(body->angular_velocity);
+    }
+
+    void physics_body_set_angular_velocity(physics_body body, float value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set angular velocity of invalid physics body";
+            return;
+        }
+
+        body->angular_velocity = deg_to_rad(value);
+    }
+
+    float physics_body_mass(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get mass of invalid physics body";
+            return 0;
+        }
+
+        return body->mass;
+    }
+
+    void physics_body_set_mass(physics_body body, float value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set mass of invalid physics body";
+            return;
+        }
+
+        _set_body_mass(body, value);
+        if ( body->owner ) sprite_set_mass(body->owner, body->mass);
+    }
+
+    float physics_body_restitution(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get restitution of invalid physics body";
+            return 0;
+        }
+
+        return body->restitution;
+    }
+
+    void physics_body_set_restitution(physics_body body, float value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set restitution of invalid physics body";
+            return;
+        }
+
+        body->restitution = MAX(0.0f, MIN(value, 1.0f));
+    }
+
+    float physics_body_friction(physics_body body)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to get friction of invalid physics body";
+            return 0;
+        }
+
+        return body->friction;
+    }
+
+    void physics_body_set_friction(physics_body body, float value)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set friction of invalid physics body";
+            return;
+        }
+
+        body->friction = MAX(0.0f, value);
+    }
+
+    void physics_body_apply_force(physics_body body, const vector_2d &force)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to apply force to invalid physics body";
+            return;
+        }
+
+        body->force.x += force.x;
+        body->force.y += force.y;
+    }
+
+    void physics_body_apply_impulse(physics_body body, const vector_2d &impulse, const point_2d &pt)
+    {
+        if ( INVALID_PTR(body, PHYSICS_BODY_PTR) )
+        {
+            LOG(WARNING) << "Attempting to apply impulse to invalid physics body";
+            return;
+        }
+
+        body->velocity.x += impulse.x * body->inv_mass;
+        body->velocity.y += impulse.y * body->inv_mass;
+        body->angular_velocity += body->inv_inertia * _cross(_between(body->position, pt), impulse);
+    }
+}
@@ -12,5 +12,420 @@
 #include "matrix_2d.h"
 #include "vector_2d.h"
 #include "collisions.h"
+#include "sprites.h"
 
+#include <string>
+using namespace std;
+namespace splashkit_lib
+{
+    /**
+     * A physics world moves a group of bodies, bouncing them off each other
+     * as they collide. The world is updated at a fixed timestep, so the
+     * results do not depend on how fast the game is running.
+     *
+     * @attribute class physics_world
+     */
+    typedef struct _physics_world_data *physics_world;
+
+    /**
+     * A physics body is a solid shape within a physics world. Bodies can
+     * follow a sprite, using its collision shape, or be a standalone circle
+     * or rectangle. Bodies with a mass of 0 are static, and are never moved
+     * by the world.
+     *
+     * @attribute class physics_body
+     */
+    typedef struct _physics_body_data *physics_body;
+
+    /**
+     * Create a new physics world, with no gravity. The world steps 60 times
+     * a second, solving its contacts 10 times each step.
+     *
+     * @param name  The name of the world for resource tracking
+     * @returns     A new physics world.
+     *
+     * @attribute class physics_world
+     * @attribute constructor true
+     */
+    physics_world create_physics_world(const string &name);
+
+    /**
+     * Free the physics world, and all of the bodies within it. Sprites
+     * attached to the bodies are not freed.
+     *
+     * @param world The world to free
+     *
+     * @attribute class physics_world
+     * @attribute destructor true
+     */
+    void free_physics_world(physics_world world);
+
+    /**
+     * Free all of the physics worlds that have been created.
+     *
+     * @attribute static physics_worlds
+     * @attribute method release_all
+     */
+    void free_all_physics_worlds();
+
+    /**
+     * Checks if SplashKit has a physics world with the indicated name.
+     *
+     * @param name  The name of the world
+     * @returns     True if a world with that name has been created
+     *
+     * @attribute static physics_worlds
+     * @attribute method has_physics_world
+     */
+    bool has_physics_world(const string &name);
+
+    /**
+     * Get the physics world created with the indicated name.
+     *
+     * @param name  The name of the world to fetch
+     * @returns     The world, or nullptr if there is no world with that name
+     *
+     * @attribute static physics_worlds
+     * @attribute method get_named
+     */
+    physics_world physics_world_named(const string &name);
+
+    /**
+     * Advance the world by the time that has passed. The world moves in
+     * fixed steps, keeping any time left over for the next update. At most
+     * 5 steps are taken in one update, so the world slows down rather than
+     * falling further behind when the game cannot keep up.
+     *
+     * @param world     The world to update
+     * @param seconds   The time that has passed, in seconds
+     *
+     * @attribute class physics_world
+     * @attribute method update
+     */
+    void update_physics_world(physics_world world, float seconds);
+
+    /**
+     * Returns the acceleration applied to all moving bodies in the world.
+     *
+     * @param world The world
+     * @returns     The gravity of the world, in pixels per second per second
+     *
+     * @attribute class physics_world
+     * @attribute getter gravity
+     */
+    vector_2d physics_world_gravity(physics_world world);
+
+    /**
+     * Set the acceleration applied to all moving bodies in the world.
+     *
+     * @param world The world to change
+     * @param value The new gravity, in pixels per second per second
+     *
+     * @attribute class physics_world
+     * @attribute setter gravity
+     */
+    void physics_world_set_gravity(physics_world world, const vector_2d &value);
+
+    /**
+     * Returns the length of each step the world takes.
+     *
+     * @param world The world
+     * @returns     The time of each step, in seconds
+     *
+     * @attribute class physics_world
+     * @attribute getter timestep
+     */
+    float physics_world_timestep(physics_world world);
+
+    /**
+     * Set the length of each step the world takes. Shorter steps are more
+     * accurate, but take more time to calculate.
+     *
+     * @param world The world to change
+     * @param value The time of each step, in seconds
+     *
+     * @attribute class physics_world
+     * @attribute setter timestep
+     */
+    void physics_world_set_timestep(physics_world world, float value);
+
+    /**
+     * Returns the number of times the contacts are solved each step.
+     *
+     * @param world The world
+     * @returns     The number of solver iterations
+     *
+     * @attribute class physics_world
+     * @attribute getter iterations
+     */
+    int physics_world_iterations(physics_world world);
+
+    /**
+     * Set the number of times the contacts are solved each step. More
+     * iterations make stacks of bodies more stable, at the cost of time.
+     *
+     * @param world The world to change
+     * @param value The number of solver iterations
+     *
+     * @attribute class physics_world
+     * @attribute setter iterations
+     */
+    void physics_world_set_iterations(physics_world world, int value);
+
+    /**
+     * Returns the number of bodies in the world.
+     *
+     * @param world The world
+     * @returns     The number of bodies
+     *
+     * @attribute class physics_world
+     * @attribute getter body_count
+     */
+    int physics_world_body_count(physics_world world);
+
+    /**
+     * Create a body that follows the sprite. The body uses the sprite's
+     * collision shape: a box for `AABB_COLLISIONS` and polygons around the
+     * pixels of its collision bitmap otherwise. The body takes its mass from
+     * `sprite_mass`, and turns around the sprite's anchor point. Updating the
+     * world moves and rotates the sprite, so the sprite should not also be
+     * moved with `update_sprite`.
+     *
+     * @param world The world to add the body to
+     * @param s     The sprite for the body to follow
+     * @returns     A new physics body.
+     *
+     * @attribute class physics_body
+     * @attribute constructor true
+     */
+    physics_body create_physics_body(physics_world world, sprite s);
+
+    /**
+     * Create a circular body.
+     *
+     * @param world The world to add the body to
+     * @param c     The area of the body
+     * @param mass  The mass of the body, or 0 for a body that does not move
+     * @returns     A new physics body.
+     *
+     * @attribute suffix from_circle
+     */
+    physics_body create_physics_body(physics_world world, const circle &c, float mass);
+
+    /**
+     * Create a rectangular body.
+     *
+     * @param world The world to add the body to
+     * @param rect  The area of the body
+     * @param mass  The mass of the body, or 0 for a body that does not move
+     * @returns     A new physics body.
+     *
+     * @attribute suffix from_rectangle
+     */
+    physics_body create_physics_body(physics_world world, const rectangle &rect, float mass);
+
+    /**
+     * Remove the body from its world, and free it.
+     *
+     * @param body The body to free
+     *
+     * @attribute class physics_body
+     * @attribute destructor true
+     */
+    void free_physics_body(physics_body body);
+
+    /**
+     * Returns the sprite that the body follows.
+     *
+     * @param body  The body
+     * @returns     The sprite, or nullptr for a standalone body
+     *
+     * @attribute class physics_body
+     * @attribute getter sprite
+     */
+    sprite physics_body_sprite(physics_body body);
+
+    /**
+     * Returns the location of the body. This is the centre of circles and
+     * rectangles, and the anchor point of sprites.
+     *
+     * @param body  The body
+     * @returns     The location of the body
+     *
+     * @attribute class physics_body
+     * @attribute getter position
+     */
+    point_2d physics_body_position(physics_body body);
+
+    /**
+     * Move the body to a new location.
+     *
+     * @param body  The body to move
+     * @param value The new location of the body
+     *
+     * @attribute class physics_body
+     * @attribute setter position
+     */
+    void physics_body_set_position(physics_body body, const point_2d &value);
+
+    /**
+     * Returns the rotation of the body.
+     *
+     * @param body  The body
+     * @returns     The rotation, in degrees
+     *
+     * @attribute class physics_body
+     * @attribute getter rotation
+     */
+    float physics_body_rotation(physics_body body);
+
+    /**
+     * Set the rotation of the body.
+     *
+     * @param body  The body to change
+     * @param value The new rotation, in degrees
+     *
+     * @attribute class physics_body
+     * @attribute setter rotation
+     */
+    void physics_body_set_rotation(physics_body body, float value);
+
+    /**
+     * Returns the velocity of the body.
+     *
+     * @param body  The body
+     * @returns     The velocity, in pixels per second
+     *
+     * @attribute class physics_body
+     * @attribute getter velocity
+     */
+    vector_2d physics_body_velocity(physics_body body);
+
+    /**
+     * Set the velocity of the body.
+     *
+     * @param body  The body to change
+     * @param value The new velocity, in pixels per second
+     *
+     * @attribute class physics_body
+     * @attribute setter velocity
+     */
+    void physics_body_set_velocity(physics_body body, const vector_2d &value);
+
+    /**
+     * Returns how fast the body is turning.
+     *
+     * @param body  The body
+     * @returns     The angular velocity, in degrees per second
+     *
+     * @attribute class physics_body
+     * @attribute getter angular_velocity
+     */
+    float physics_body_angular_velocity(physics_body body);
+
+    /**
+     * Set how fast the body is turning.
+     *
+     * @param body  The body to change
+     * @param value The new angular velocity, in degrees per second
+     *
+     * @attribute class physics_body
+     * @attribute setter angular_velocity
+     */
+    void physics_body_set_angular_velocity(physics_body body, float value);
+
+    /**
+     * Returns the mass of the body. Bodies with a mass of 0 do not move.
+     *
+     * @param body  The body
+     * @returns     The mass of the body
+     *
+     * @attribute class physics_body
+     * @attribute getter mass
+     */
+    float physics_body_mass(physics_body body);
+
+    /**
+     * Set the mass of the body. Setting the mass to 0 stops the body moving.
+     *
+     * @param body  The body to change
+     * @param value The new mass of the body
+     *
+     * @attribute class physics_body
+     * @attribute setter mass
+     */
+    void physics_body_set_mass(physics_body body, float value);
+
+    /**
+     * Returns how bouncy the body is, from 0 where it does not bounce, to 1
+     * where it bounces back at the speed it hit.
+     *
+     * @param body  The body
+     * @returns     The restitution of the body
+     *
+     * @attribute class physics_body
+     * @attribute getter restitution
+     */
+    float physics_body_restitution(physics_body body);
+
+    /**
+     * Set how bouncy the body is. The bounciest of two bodies is used when
+     * they collide.
+     *
+     * @param body  The body to change
+     * @param value The restitution of the body, from 0 to 1
+     *
+     * @attribute class physics_body
+     * @attribute setter restitution
+     */
+    void physics_body_set_restitution(physics_body body, float value);
+
+    /**
+     * Returns how much the body resists sliding against other bodies.
+     *
+     * @param body  The body
+     * @returns     The friction of the body
+     *
+     * @attribute class physics_body
+     * @attribute getter friction
+     */
+    float physics_body_friction(physics_body body);
+
+    /**
+     * Set how much the body resists sliding against other bodies. Two
+     * bodies sliding against each other use the geometric mean of their
+     * friction.
+     *
+     * @param body  The body to change
+     * @param value The friction of the body, 0 or more
+     *
+     * @attribute class physics_body
+     * @attribute setter friction
+     */
+    void physics_body_set_friction(physics_body body, float value);
+
+    /**
+     * Push the body through its centre during the next step.
+     *
+     * @param body  The body to push
+     * @param force The force to apply
+     *
+     * @attribute class physics_body
+     * @attribute method apply_force
+     */
+    void physics_body_apply_force(physics_body body, const vector_2d &force);
+
+    /**
+     * Immediately change the velocity of the body, as if it was hit at the
+     * indicated point. Hitting away from the centre also makes it spin.
+     *
+     * @param body      The body to hit
+     * @param impulse   The impulse to apply
+     * @param pt        The point in the world where the body is hit
+     *
+     * @attribute class physics_body
+     * @attribute method apply_impulse
+     */
+    void physics_body_apply_impulse(physics_body body, const vector_2d &impulse, const point_2d &pt);
+}
 #endif /* physics_hpp */
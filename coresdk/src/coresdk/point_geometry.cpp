@@ -15,6 +15,7 @@
 #include "geometry.h"
 
 #include "utility_functions.h"
+#include "simd_utils.h"
 
 #include <cmath>
 
@@ -117,6 +118,69 @@ namespace splashkit_lib
         else return true;
     }
 
+    void points_in_rectangle(const vector<point_2d> &pts, const rectangle &rect, vector<uint64_t> &result)
+    {
+        size_t count = pts.size();
+        size_t i = 0;
+        float left = rectangle_left(rect), right = rectangle_right(rect);
+        float top = rectangle_top(rect), bottom = rectangle_bottom(rect);
+
+        clear_bitmask(result, count);
+
+        const float *src = reinterpret_cast<const float *>(pts.data());
+
+        // Each point is checked as an (x, y) pair against (left, top) and
+        // (right, bottom); it is inside when both lanes pass.
+#if defined(SK_SIMD_AVX)
+        __m256 lo = _mm256_setr_ps(left, top, left, top, left, top, left, top);
+        __m256 hi = _mm256_setr_ps(right, bottom, right, bottom, right, bottom, right, bottom);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 p = _mm256_loadu_ps(src + i * 2);
+            int in = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(p, lo, _CMP_GE_OQ), _mm256_cmp_ps(p, hi, _CMP_LE_OQ)));
+
+            uint64_t bits = 0;
+            for (int j = 0; j < 4; j++)
+            {
+                if ( ((in >> (j * 2)) & 3) == 3 ) bits |= 1ULL << j;
+            }
+            set_bitmask_bits(result, i, bits);
+        }
+#elif defined(SK_SIMD_SSE2)
+        __m128 lo = _mm_setr_ps(left, top, left, top);
+        __m128 hi = _mm_setr_ps(right, bottom, right, bottom);
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128 p = _mm_loadu_ps(src + i * 2);
+            int in = _mm_movemask_ps(_mm_and_ps(_mm_cmpge_ps(p, lo), _mm_cmple_ps(p, hi)));
+
+            set_bitmask_bits(result, i, ((in & 3) == 3 ? 1 : 0) | ((in >> 2) == 3 ? 2 : 0));
+        }
+#elif defined(SK_SIMD_NEON)
+        const float lo_values[4] = { left, top, left, top };
+        const float hi_values[4] = { right, bottom, right, bottom };
+        float32x4_t lo = vld1q_f32(lo_values), hi = vld1q_f32(hi_values);
+
+        for (; i + 2 <= count; i += 2)
+        {
+            float32x4_t p = vld1q_f32(src + i * 2);
+            uint32x4_t in = vandq_u32(vcgeq_f32(p, lo), vcleq_f32(p, hi));
+
+            uint64_t bits = 0;
+            if ( vgetq_lane_u32(in, 0) and vgetq_lane_u32(in, 1) ) bits |= 1;
+            if ( vgetq_lane_u32(in, 2) and vgetq_lane_u32(in, 3) ) bits |= 2;
+            set_bitmask_bits(result, i, bits);
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            if ( point_in_rectangle(pts[i], rect) ) set_bitmask_bits(result, i, 1);
+        }
+    }
+
     bool point_in_quad(const point_2d &pt, const quad &q)
     {
         return
@@ -134,6 +198,67 @@ namespace splashkit_lib
         return point_point_distance(c.center, pt) <= abs(c.radius);
     }
 
+    void points_in_circle(const vector<point_2d> &pts, const circle &c, vector<uint64_t> &result)
+    {
+        size_t count = pts.size();
+        size_t i = 0;
+        float cx = c.center.x, cy = c.center.y;
+        float r2 = c.radius * c.radius;
+
+        clear_bitmask(result, count);
+
+        const float *src = reinterpret_cast<const float *>(pts.data());
+
+        // Square each (dx, dy) pair, then add each lane to its neighbour so
+        // the even lanes hold the squared distance of each point.
+#if defined(SK_SIMD_AVX)
+        __m256 centre = _mm256_setr_ps(cx, cy, cx, cy, cx, cy, cx, cy);
+        __m256 radius = _mm256_set1_ps(r2);
+
+        for (; i + 4 <= count; i += 4)
+        {
+            __m256 d = _mm256_sub_ps(_mm256_loadu_ps(src + i * 2), centre);
+            __m256 sq = _mm256_mul_ps(d, d);
+            __m256 dist = _mm256_add_ps(sq, _mm256_permute_ps(sq, _MM_SHUFFLE(2, 3, 0, 1)));
+            int in = _mm256_movemask_ps(_mm256_cmp_ps(dist, radius, _CMP_LE_OQ));
+
+            set_bitmask_bits(result, i, (in & 1) | ((in >> 1) & 2) | ((in >> 2) & 4) | ((in >> 3) & 8));
+        }
+#elif defined(SK_SIMD_SSE2)
+        __m128 centre = _mm_setr_ps(cx, cy, cx, cy);
+        __m128 radius = _mm_set1_ps(r2);
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m128 d = _mm_sub_ps(_mm_loadu_ps(src + i * 2), centre);
+            __m128 sq = _mm_mul_ps(d, d);
+            __m128 dist = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+            int in = _mm_movemask_ps(_mm_cmple_ps(dist, radius));
+
+            set_bitmask_bits(result, i, (in & 1) | ((in >> 1) & 2));
+        }
+#elif defined(SK_SIMD_NEON)
+        const float centre_values[4] = { cx, cy, cx, cy };
+        float32x4_t centre = vld1q_f32(centre_values);
+
+        for (; i + 2 <= count; i += 2)
+        {
+            float32x4_t d = vsubq_f32(vld1q_f32(src + i * 2), centre);
+            float32x4_t sq = vmulq_f32(d, d);
+            float32x4_t dist = vaddq_f32(sq, vrev64q_f32(sq));
+            uint32x4_t in = vcleq_f32(dist, vdupq_n_f32(r2));
+
+            set_bitmask_bits(result, i, (vgetq_lane_u32(in, 0) ? 1 : 0) | (vgetq_lane_u32(in, 2) ? 2 : 0));
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            float dx = pts[i].x - cx, dy = pts[i].y - cy;
+            if ( dx * dx + dy * dy <= r2 ) set_bitmask_bits(result, i, 1);
+        }
+    }
+
     bool point_on_line(const point_2d &pt, const line &l)
     {
         return point_on_line(pt, l, SMALL);
@@ -9,6 +9,7 @@
 #include "geometry.h"
 #include "matrix_2d.h"
 #include "vector_2d.h"
+#include "utility_functions.h"
 
 namespace splashkit_lib
 {
@@ -77,14 +78,44 @@ namespace splashkit_lib
         return result;
     }
 
+    // Get the points of the quad in order around its edge, returning false
+    // if the quad is not convex.
+    static bool _quad_outline(const quad &q, point_2d result[4])
+    {
+        result[0] = q.points[0];
+        result[1] = q.points[1];
+        result[2] = q.points[3];
+        result[3] = q.points[2];
+
+        bool positive = false, negative = false;
+        for (int i = 0; i < 4; i++)
+        {
+            const point_2d &a = result[i], &b = result[(i + 1) % 4], &c = result[(i + 2) % 4];
+            double turn = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+
+            if ( turn > 0 ) positive = true;
+            if ( turn < 0 ) negative = true;
+        }
+
+        return not (positive and negative);
+    }
+
     bool quads_intersect(const quad &q1, const quad &q2)
     {
-        vector<triangle> q1_triangles = triangles_from(q1);
-        vector<triangle> q2_triangles = triangles_from(q2);
+        point_2d pts1[4], pts2[4];
 
-        for (triangle t1 : q1_triangles)
+        if ( _quad_outline(q1, pts1) and _quad_outline(q2, pts2) )
         {
-            for (triangle t2 : q2_triangles)
+            return convex_polygons_intersect(pts1, 4, pts2, 4);
+        }
+
+        // Check the triangles of concave quads
+        triangle q1_triangles[2] = { triangle_from(q1.points[0], q1.points[1], q1.points[2]), triangle_from(q1.points[2], q1.points[3], q1.points[1]) };
+        triangle q2_triangles[2] = { triangle_from(q2.points[0], q2.points[1], q2.points[2]), triangle_from(q2.points[2], q2.points[3], q2.points[1]) };
+
+        for (const triangle &t1 : q1_triangles)
+        {
+            for (const triangle &t2 : q2_triangles)
             {
                 if ( triangles_intersect(t1, t2) )
                 {
@@ -96,4 +127,9 @@ namespace splashkit_lib
         return false;
     }
 
+    bool quad_rectangle_intersect(const quad &q, const rectangle &rect)
+    {
+        return quads_intersect(q, quad_from(rect));
+    }
+
 }
\ No newline at end of file
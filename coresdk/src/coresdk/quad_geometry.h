@@ -87,6 +87,15 @@ namespace splashkit_lib
      */
     bool quads_intersect(const quad &q1, const quad &q2);
 
+    /**
+     * Returns true if the quad and rectangle intersect.
+     *
+     * @param  q    The quad
+     * @param  rect The rectangle
+     * @return      True if the quad and rectangle intersect.
+     */
+    bool quad_rectangle_intersect(const quad &q, const rectangle &rect);
+
     /**
      * Returns the two triangles that make up a quad in a vector.
      *
@@ -9,6 +9,7 @@
 // Include class header
 #include "rectangle_geometry.h"
 #include "utility_functions.h"
+#include "simd_utils.h"
 
 #include <sstream>
 #include <cmath>
@@ -138,6 +139,85 @@ namespace splashkit_lib
         return (abs(intersect.width) + abs(intersect.height)) != 0;
     }
 
+    void rectangles_intersect(const vector<rectangle> &rects, const rectangle &rect, vector<uint64_t> &result)
+    {
+        static_assert(sizeof(rectangle) == 4 * sizeof(float), "rectangles must be packed x, y, width, height");
+
+        size_t count = rects.size();
+        size_t i = 0;
+        float left = rectangle_left(rect), right = rectangle_right(rect);
+        float top = rectangle_top(rect), bottom = rectangle_bottom(rect);
+
+        clear_bitmask(result, count);
+
+        const float *src = reinterpret_cast<const float *>(rects.data());
+
+        // Each rectangle is loaded as (x, y, w, h). Its (left, top) and
+        // (right, bottom) are the min and max of (x, y) and (x + w, y + h),
+        // which are clipped against rect. They intersect when the clipped
+        // area is not inverted, and is more than a single point.
+#if defined(SK_SIMD_AVX)
+        __m256 lo = _mm256_setr_ps(left, top, 0, 0, left, top, 0, 0);
+        __m256 hi = _mm256_setr_ps(right, bottom, 0, 0, right, bottom, 0, 0);
+
+        for (; i + 2 <= count; i += 2)
+        {
+            __m256 r = _mm256_loadu_ps(src + i * 4);
+            __m256 far = _mm256_add_ps(r, _mm256_permute_ps(r, _MM_SHUFFLE(3, 2, 3, 2)));
+            __m256 l = _mm256_max_ps(_mm256_min_ps(r, far), lo);
+            __m256 h = _mm256_min_ps(_mm256_max_ps(r, far), hi);
+
+            int ge = _mm256_movemask_ps(_mm256_cmp_ps(h, l, _CMP_GE_OQ));
+            int gt = _mm256_movemask_ps(_mm256_cmp_ps(h, l, _CMP_GT_OQ));
+
+            uint64_t bits = 0;
+            if ( (ge & 0x03) == 0x03 and (gt & 0x03) ) bits |= 1;
+            if ( (ge & 0x30) == 0x30 and (gt & 0x30) ) bits |= 2;
+            set_bitmask_bits(result, i, bits);
+        }
+#elif defined(SK_SIMD_SSE2)
+        __m128 lo = _mm_setr_ps(left, top, 0, 0);
+        __m128 hi = _mm_setr_ps(right, bottom, 0, 0);
+
+        for (; i < count; i++)
+        {
+            __m128 r = _mm_loadu_ps(src + i * 4);
+            __m128 far = _mm_add_ps(r, _mm_movehl_ps(r, r));
+            __m128 l = _mm_max_ps(_mm_min_ps(r, far), lo);
+            __m128 h = _mm_min_ps(_mm_max_ps(r, far), hi);
+
+            int ge = _mm_movemask_ps(_mm_cmpge_ps(h, l));
+            int gt = _mm_movemask_ps(_mm_cmpgt_ps(h, l));
+
+            if ( (ge & 0x03) == 0x03 and (gt & 0x03) ) set_bitmask_bits(result, i, 1);
+        }
+#elif defined(SK_SIMD_NEON)
+        const float lo_values[2] = { left, top };
+        const float hi_values[2] = { right, bottom };
+        float32x2_t lo = vld1_f32(lo_values), hi = vld1_f32(hi_values);
+
+        for (; i < count; i++)
+        {
+            float32x4_t r = vld1q_f32(src + i * 4);
+            float32x2_t xy = vget_low_f32(r);
+            float32x2_t far = vadd_f32(xy, vget_high_f32(r));
+            float32x2_t l = vmax_f32(vmin_f32(xy, far), lo);
+            float32x2_t h = vmin_f32(vmax_f32(xy, far), hi);
+
+            uint32x2_t ge = vcge_f32(h, l);
+            uint32x2_t gt = vcgt_f32(h, l);
+
+            if ( vget_lane_u32(ge, 0) and vget_lane_u32(ge, 1) and (vget_lane_u32(gt, 0) or vget_lane_u32(gt, 1)) )
+                set_bitmask_bits(result, i, 1);
+        }
+#endif
+
+        for (; i < count; i++)
+        {
+            if ( rectangles_intersect(rects[i], rect) ) set_bitmask_bits(result, i, 1);
+        }
+    }
+
     float rectangle_top(const rectangle &rect)
     {
         if ( rect.height >= 0) return rect.y;
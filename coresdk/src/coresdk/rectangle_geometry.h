@@ -11,6 +11,8 @@
 
 #include "types.h"
 #include <string>
+#include <vector>
+#include <cstdint>
 
 using namespace std;
 namespace splashkit_lib
@@ -106,6 +108,19 @@ namespace splashkit_lib
      */
     bool rectangles_intersect(const rectangle &rect1, const rectangle &rect2);
 
+    /**
+     * Tests each of the rectangles in `rects` against `rect`, setting bit i
+     * of the bitmask in `result` when `rects[i]` intersects `rect`. Bit i is
+     * bit `i & 63` of `result[i >> 6]`. This gives the same answers as
+     * `rectangles_intersect`, but checks several rectangles at a time so it
+     * is much faster for large arrays.
+     *
+     * @param rects     The rectangles to test
+     * @param rect      The rectangle to check them against
+     * @param result    The bitmask to store the results in
+     */
+    void rectangles_intersect(const vector<rectangle> &rects, const rectangle &rect, vector<uint64_t> &result);
+
     /**
      * The top of the rectangle.
      *
@@ -13,12 +13,19 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 namespace splashkit_lib
 {
     static map<string, sound_effect> _sound_effects;
 
+    // Sound effects waiting to be played at the next flush
+    static vector<queued_sound> _queued_sounds;
+    static int _queued_sound_limit = 4;
+    static bool _queued_sound_volume_summing = false;
+
     struct _sound_data
     {
         pointer_identifier id;
@@ -58,13 +65,11 @@ namespace splashkit_lib
         return effect->filename;
     }
 
-    sound_effect load_sound_effect(const string &name, const string &filename)
+    _sound_data *prepare_sound_effect(const string &name, const string &filename, const char *data, size_t size)
     {
-        if (has_sound_effect(name)) return sound_effect_named(name);
-
         string file_path = filename;
 
-        if ( ! file_exists(file_path) )
+        if ( ! data and ! file_exists(file_path) )
         {
             file_path = path_to_resource(filename, SOUND_RESOURCE);
 
@@ -75,12 +80,15 @@ namespace splashkit_lib
             }
         }
 
-        sound_effect result = new _sound_data();
+        _sound_data *result = new _sound_data();
 
         result->id = AUDIO_PTR;
         result->filename = file_path;
         result->name = name;
-        result->effect = sk_load_sound_data(file_path, SGSD_SOUND_EFFECT);
+        if ( data )
+            result->effect = sk_load_sound_data_from_memory(data, size, SGSD_SOUND_EFFECT);
+        else
+            result->effect = sk_load_sound_data(file_path, SGSD_SOUND_EFFECT);
 
         // Unable to load sound effect
         if ( ! result->effect._data )
@@ -91,16 +99,42 @@ namespace splashkit_lib
             return nullptr;
         }
 
-        _sound_effects[name] = result;
         return result;
     }
 
+    sound_effect finish_sound_effect(_sound_data *prepared)
+    {
+        if ( not prepared ) return nullptr;
+
+        // Another sound effect may have taken the name while this one was loading
+        if ( has_sound_effect(prepared->name) )
+        {
+            sound_effect existing = _sound_effects[prepared->name];
+            sk_close_sound_data(&prepared->effect);
+            prepared->id = NONE_PTR;
+            delete prepared;
+            return existing;
+        }
+
+        _sound_effects[prepared->name] = prepared;
+        return prepared;
+    }
+
+    sound_effect load_sound_effect(const string &name, const string &filename)
+    {
+        if (has_sound_effect(name)) return sound_effect_named(name);
+
+        return finish_sound_effect(prepare_sound_effect(name, filename));
+    }
+
     void free_sound_effect(sound_effect effect)
     {
         if ( VALID_PTR(effect, AUDIO_PTR) )
         {
             notify_of_free(effect);
 
+            _queued_sounds.erase(remove_if(_queued_sounds.begin(), _queued_sounds.end(), [effect] (const queued_sound &q) { return q.effect == effect; }), _queued_sounds.end());
+
             _sound_effects.erase(effect->name);
             sk_close_sound_data(&effect->effect);
             effect->id = NONE_PTR;  // ensure future use of this pointer will fail...
@@ -209,4 +243,73 @@ namespace splashkit_lib
     {
         sk_fade_all_sound_effects_out(ms);
     }
+
+    void queue_sound_effect(sound_effect effect, float volume)
+    {
+        if ( INVALID_PTR(effect, AUDIO_PTR) )
+        {
+            LOG(WARNING) << "Queue Sound Effect called, but no valid sound effect supplied";
+            return;
+        }
+
+        add_queued_sound(_queued_sounds, effect, volume, _queued_sound_volume_summing);
+    }
+
+    // See utility_functions.h
+    void add_queued_sound(vector<queued_sound> &queue, _sound_data *effect, float volume, bool summing)
+    {
+        // Only a handful of different effects are queued each frame, so a
+        // search is quicker than a map
+        for (queued_sound &queued : queue)
+        {
+            if ( queued.effect == effect )
+            {
+                if ( summing )
+                    queued.volume = MIN(1.0f, queued.volume + volume);
+                else if ( volume > queued.volume )
+                    queued.volume = volume;
+                return;
+            }
+        }
+
+        queue.push_back({effect, volume});
+    }
+
+    void flush_queued_sound_effects()
+    {
+        if ( _queued_sounds.empty() ) return;
+
+        if ( audio_ready() )
+        {
+            for (const queued_sound &queued : _queued_sounds)
+            {
+                if ( _queued_sound_limit > 0 and sk_sound_instances_playing(&queued.effect->effect) >= _queued_sound_limit )
+                    continue;
+
+                play_sound_effect(queued.effect, 1, queued.volume);
+            }
+        }
+
+        _queued_sounds.clear();
+    }
+
+    int queued_sound_effect_limit()
+    {
+        return _queued_sound_limit;
+    }
+
+    void set_queued_sound_effect_limit(int max_instances)
+    {
+        _queued_sound_limit = max_instances;
+    }
+
+    bool queued_sound_effect_volume_summing()
+    {
+        return _queued_sound_volume_summing;
+    }
+
+    void set_queued_sound_effect_volume_summing(bool value)
+    {
+        _queued_sound_volume_summing = value;
+    }
 }
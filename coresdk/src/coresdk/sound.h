@@ -299,6 +299,64 @@ namespace splashkit_lib
      * @param ms The number of milliseconds to fade out all sound effects.
      */
     void fade_all_sound_effects_out(int ms);
+
+    /**
+     * Queue a `sound_effect` to be played when queued sounds are next
+     * flushed. An effect queued several times before a flush is only played
+     * once, using the loudest volume it was queued with, or the sum of the
+     * volumes if volume summing is on. Animations queue the sounds of the
+     * frames they enter, and the queue is flushed by `update_all_sprites`,
+     * `refresh_screen` and `refresh_window`.
+     *
+     * @param effect      The `sound_effect` to queue.
+     * @param volume      The volume to play the effect at, from 0 to 1.
+     *
+     * @attribute class   sound_effect
+     * @attribute method  queue
+     * @attribute self    effect
+     */
+    void queue_sound_effect(sound_effect effect, float volume);
+
+    /**
+     * Play the queued `sound_effect`s, and empty the queue. Effects that
+     * already have as many copies playing as the queued sound limit are
+     * not played.
+     */
+    void flush_queued_sound_effects();
+
+    /**
+     * Returns the most copies of a queued `sound_effect` that can play at
+     * once.
+     *
+     * @returns The limit on copies of each effect, or 0 for no limit.
+     */
+    int queued_sound_effect_limit();
+
+    /**
+     * Set the most copies of a queued `sound_effect` that can play at once.
+     * This stops a crowd of sprites entering the same frame from using up
+     * every channel. The limit starts at 4.
+     *
+     * @param max_instances The limit on copies of each effect, or 0 for no limit.
+     */
+    void set_queued_sound_effect_limit(int max_instances);
+
+    /**
+     * Returns if the volumes of a `sound_effect` queued several times are
+     * added together.
+     *
+     * @returns True if queued volumes are summed.
+     */
+    bool queued_sound_effect_volume_summing();
+
+    /**
+     * Set if the volumes of a `sound_effect` queued several times are added
+     * together, so a crowd sounds louder than one sprite. The summed volume
+     * is limited to 1. When this is off, the loudest volume is used.
+     *
+     * @param value True to sum queued volumes.
+     */
+    void set_queued_sound_effect_volume_summing(bool value);
 }
 
 #endif /* sound_h */
@@ -7,10 +7,12 @@
 //
 
 #include "animations.h"
+#include "audio.h"
 #include "backend_types.h"
 #include "camera.h"
 #include "collisions.h"
 #include "geometry.h"
+#include "graphics_driver.h"
 #include "images.h"
 #include "mouse_input.h"
 #include "sprites.h"
@@ -43,6 +45,24 @@ namespace splashkit_lib
 #define ROTATION_KEY    "rotation"
 #define MASS_KEY        "mass"
 
+    // Cell used for the draw data of sprites without an animation. These draw
+    // the whole layer bitmap, rather than a cell.
+#define NO_ANIMATION_CELL -2
+
+    extern window _current_window;
+
+    //
+    // Drawing details for a visible layer, cached so that draw_sprite can pass
+    // these straight to the graphics driver.
+    //
+    struct _sprite_layer_draw_data
+    {
+        bitmap      bmp;            // The layer's bitmap
+        float       src_data[4];    // The part of the bitmap to draw (for the current cell)
+        unsigned int cell_version;  // The bitmap's cell version when src_data was read
+        vector_2d   offset;         // Offset from the sprite position to draw the layer
+    };
+
     struct _sprite_data
     {
         pointer_identifier  id;
@@ -77,8 +97,23 @@ namespace splashkit_lib
 
         bool                announced_animation_end; // Used to avoid multiple announcements of an end of an animation
 
+        vector<_sprite_layer_draw_data> draw_layers; // Cached drawing details for the visible layers
+        float               draw_angle;         // Cached rotation used when drawing
+        float               draw_centre_x;      // Cached rotation centre, relative to the bitmap centre
+        float               draw_centre_y;
+        float               draw_scale;         // Cached scale used when drawing
+        int                 draw_cell;          // The cell the cached draw data was prepared for
+        unsigned int        draw_centre_version; // Cell version of the first layer when the centre was read
+        bool                draw_data_valid;    // Set to false when changes require draw data to be rebuilt
+
         vector<sprite_event_handler *> evts;    // The call backs listening for sprite events
 
+        sprite              parent;             // The sprite this is attached to (or nullptr)
+        vector<sprite>      children;           // The sprites attached to this sprite
+        vector_2d           local_offset;       // Offset from the parent, in the parent's sprite coordinates
+        float               local_rotation;     // Rotation relative to the parent
+        float               local_scale;        // Scale relative to the parent
+
         vector<sprite>      &pack;              // Points the the SpritePack that contains this sprite
 
         _sprite_data() : pack( current_pack() )
@@ -115,6 +150,68 @@ namespace splashkit_lib
         }
     }
 
+    //-----------------------------------------------------------------------------
+    // Click dispatch
+    //-----------------------------------------------------------------------------
+
+    // In mouse input
+    unsigned int _mouse_process_events_count();
+
+    //
+    // The sprite clicked in a pack is resolved once per call to process_events,
+    // rather than having each sprite test the mouse as it is updated.
+    //
+    struct _sprite_click_data
+    {
+        unsigned int    frame;  // The process events count when this was resolved
+        vector<sprite>  *pack;  // The pack that was searched
+        sprite          target; // The topmost sprite under the click (or nullptr)
+    };
+
+    static _sprite_click_data _sprite_click = { 0, nullptr, nullptr };
+
+    bool _sprite_click_hit(sprite s, const point_2d &pt)
+    {
+        // Cheap bounding box reject before any pixel level test
+        if ( not point_in_rectangle(pt, sprite_collision_rectangle(s)) ) return false;
+
+        if ( s->collision_kind == AABB_COLLISIONS ) return true;
+
+        return sprite_point_collision(s, pt);
+    }
+
+    //
+    // Returns the sprite in the pack that was clicked this frame. Sprites are
+    // drawn in pack order, so the search runs backward to find the topmost.
+    // The mouse is moved into game coordinates, where sprites are positioned.
+    //
+    sprite _clicked_sprite_in(vector<sprite> &pack)
+    {
+        unsigned int frame = _mouse_process_events_count();
+
+        if ( _sprite_click.frame == frame and _sprite_click.pack == &pack )
+            return _sprite_click.target;
+
+        _sprite_click.frame = frame;
+        _sprite_click.pack = &pack;
+        _sprite_click.target = nullptr;
+
+        if ( not mouse_clicked(LEFT_BUTTON) ) return nullptr;
+
+        point_2d pt = to_world(mouse_position());
+
+        for (auto it = pack.rbegin(); it != pack.rend(); ++it)
+        {
+            if ( _sprite_click_hit(*it, pt) )
+            {
+                _sprite_click.target = *it;
+                break;
+            }
+        }
+
+        return _sprite_click.target;
+    }
+
     //-----------------------------------------------------------------------------
     // Vector stuff...
     //-----------------------------------------------------------------------------
@@ -210,6 +307,15 @@ namespace splashkit_lib
         result->collision_kind           = PIXEL_COLLISIONS;
         result->collision_bitmap         = layer;
 
+        // Drawing details are prepared on the first draw
+        result->draw_data_valid = false;
+
+        // Sprites start without a parent
+        result->parent = nullptr;
+        result->local_offset = vector_to(0,0);
+        result->local_rotation = 0;
+        result->local_scale = 1;
+
         // Event details
         result->announced_animation_end = false;
         result->is_moving = false;
@@ -268,6 +374,16 @@ namespace splashkit_lib
         //Free buffered rotation image
         s->collision_bitmap = nullptr;
 
+        if ( _sprite_click.target == s )
+            _sprite_click.target = nullptr;
+
+        // Detach from the sprite hierarchy
+        sprite_set_parent(s, nullptr);
+        while ( s->children.size() > 0 )
+        {
+            sprite_set_parent(s->children.back(), nullptr);
+        }
+
         if( ( not erase_from_vector(s->pack, s) ) )
         {
             LOG(WARNING) << "Error removing sprite from sprite pack!";
@@ -325,6 +441,7 @@ namespace splashkit_lib
         int result = static_cast<int>(s->layers.size() - 1);
         s->layer_names[layer_names] = result;
         s->layer_offsets.push_back(vector_to(0,0));
+        s->draw_data_valid = false;
 
         return result;
     }
@@ -421,6 +538,7 @@ namespace splashkit_lib
 
         //Extend layers and add index
         s->visible_layers.push_back(id);
+        s->draw_data_valid = false;
 
         return static_cast<int>(s->visible_layers.size() - 1);
     }
@@ -439,6 +557,7 @@ namespace splashkit_lib
             return;
 
         erase_from_vector(s->visible_layers, id);
+        s->draw_data_valid = false;
     }
 
     void sprite_toggle_layer_visible(sprite s, const string &name)
@@ -520,6 +639,7 @@ namespace splashkit_lib
         if ( not sprite_has_layer(s, idx) )
             return;
         s->layer_offsets[idx] = value;
+        s->draw_data_valid = false;
     }
 
     int sprite_visible_index_of_layer(sprite s, const string &name)
@@ -548,6 +668,7 @@ namespace splashkit_lib
 
         if ( visible_layer < s->visible_layers.size() - 1 )
             move_range(s->visible_layers, sprite_visible_index_of_layer(s, visible_layer), 1, s->visible_layers.size() - 1 );
+        s->draw_data_valid = false;
     }
 
     void sprite_send_layer_backward(sprite s, int visible_layer)
@@ -556,6 +677,7 @@ namespace splashkit_lib
 
         if ( visible_layer < s->visible_layers.size() - 1 )
             swap(s->visible_layers[visible_layer], s->visible_layers[visible_layer + 1]);
+        s->draw_data_valid = false;
     }
 
     void sprite_bring_layer_forward(sprite s, int visible_layer)
@@ -564,6 +686,7 @@ namespace splashkit_lib
 
         if ( visible_layer > 0 )
             swap(s->visible_layers[visible_layer], s->visible_layers[visible_layer - 1]);
+        s->draw_data_valid = false;
     }
 
     void sprite_bring_layer_to_front(sprite s, int visible_layer)
@@ -572,6 +695,7 @@ namespace splashkit_lib
 
         if ( visible_layer > 0 )
             move_range(s->visible_layers, sprite_visible_index_of_layer(s, visible_layer), 1, 0 );
+        s->draw_data_valid = false;
     }
 
     rectangle sprite_layer_rectangle(sprite s, const string &name)
@@ -826,19 +950,30 @@ namespace splashkit_lib
         update_sprite(s, pct, true);
     }
 
+    void _place_sprite_child(sprite child, const matrix_2d &parent_location, float parent_rotation, float parent_scale);
+    void _update_sprite_children(sprite s, const matrix_2d &location);
+
+    // Set while update_all_sprites is updating each sprite, as it positions
+    // the whole sprite hierarchy once all of the sprites have moved
+    static bool _updating_all_sprites = false;
+
     void update_sprite(sprite s, float pct, bool with_sound)
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
             move_sprite(s, pct);
-            update_sprite_animation(s, pct, with_sound);
 
-            //   if mouse_clicked(LEFT_BUTTON) and circle_circle_collision(sprite_collision_circle(s), circle_at(mouse_x(), mouse_y(), 17))
-            //   {
-            //     sprite_raise_event(s, sprite_touched_event);
-            //   }
+            if ( not _updating_all_sprites )
+            {
+                // Place this sprite relative to its parent, and its children relative to it
+                if ( s->parent )
+                    _place_sprite_child(s, sprite_location_matrix(s->parent), sprite_rotation(s->parent), sprite_scale(s->parent));
+                else if ( s->children.size() > 0 )
+                    _update_sprite_children(s, sprite_location_matrix(s));
+            }
+            update_sprite_animation(s, pct, with_sound);
 
-            if ( mouse_clicked(LEFT_BUTTON) and circles_intersect(sprite_collision_circle(s), circle_at(mouse_x(), mouse_y(), 1)))
+            if ( _clicked_sprite_in(s->pack) == s )
             {
                 sprite_raise_event(s, SPRITE_CLICKED_EVENT);
             }
@@ -865,6 +1000,122 @@ namespace splashkit_lib
         draw_sprite(s, offset.x, offset.y);
     }
 
+    //
+    // Rebuild the cached drawing details for the sprite's visible layers.
+    //
+    void _sprite_prepare_draw_data(sprite s, int cell)
+    {
+        s->draw_angle = s->values[ROTATION_KEY];
+        s->draw_scale = s->values[SCALE_KEY];
+
+        if ( s->draw_angle != 0 )
+        {
+            s->draw_centre_x = s->anchor_point.x - sprite_layer_width(s, 0) / 2.0f;
+            s->draw_centre_y = s->anchor_point.y - sprite_layer_height(s, 0) / 2.0f;
+        }
+        else
+        {
+            s->draw_centre_x = 0;
+            s->draw_centre_y = 0;
+        }
+
+        s->draw_centre_version = sprite_has_layer(s, 0) and VALID_PTR(s->layers[0], BITMAP_PTR) ? s->layers[0]->cell_version : 0;
+
+        s->draw_layers.resize(s->visible_layers.size());
+
+        for (int i = 0; i < s->visible_layers.size(); i++)
+        {
+            int idx = s->visible_layers[i];
+            _sprite_layer_draw_data &layer = s->draw_layers[i];
+            rectangle part;
+
+            layer.bmp = s->layers[idx];
+            layer.cell_version = VALID_PTR(layer.bmp, BITMAP_PTR) ? layer.bmp->cell_version : 0;
+
+            if ( cell == NO_ANIMATION_CELL )
+                part = bitmap_rectangle(layer.bmp);
+            else
+                part = bitmap_rectangle_of_cell(layer.bmp, cell);
+
+            layer.src_data[0] = part.x;
+            layer.src_data[1] = part.y;
+            layer.src_data[2] = part.width;
+            layer.src_data[3] = part.height;
+
+            layer.offset = s->layer_offsets[idx];
+
+            if ( s->draw_at_anchor_point )
+            {
+                layer.offset.x -= s->anchor_point.x;
+                layer.offset.y -= s->anchor_point.y;
+            }
+        }
+
+        s->draw_cell = cell;
+        s->draw_data_valid = true;
+    }
+
+    // Is the cached draw data still correct? Besides the sprite's own
+    // changes, the cell details of its bitmaps can be changed at any time.
+    static bool _sprite_draw_data_current(sprite s, int cell)
+    {
+        if ( not s->draw_data_valid or cell != s->draw_cell ) return false;
+
+        if ( sprite_has_layer(s, 0) and VALID_PTR(s->layers[0], BITMAP_PTR) and s->layers[0]->cell_version != s->draw_centre_version ) return false;
+
+        for (const _sprite_layer_draw_data &layer : s->draw_layers)
+        {
+            if ( VALID_PTR(layer.bmp, BITMAP_PTR) and layer.bmp->cell_version != layer.cell_version ) return false;
+        }
+
+        return true;
+    }
+
+    // Make sure the cached draw data is ready for the sprite's current cell
+    static void _sprite_update_draw_data(sprite s)
+    {
+        int cell = NO_ANIMATION_CELL;
+        if ( VALID_PTR(s->animation_info, ANIMATION_PTR) )
+            cell = animation_current_cell(s->animation_info);
+
+        if ( not _sprite_draw_data_current(s, cell) )
+            _sprite_prepare_draw_data(s, cell);
+    }
+
+    // Fill in the destination details passed to the graphics driver for a layer
+    static void _sprite_layer_dst_data(sprite s, const _sprite_layer_draw_data &layer, float x_offset, float y_offset, float dst_data[7])
+    {
+        // Sprites are drawn to the current window, so the camera always applies
+        dst_data[0] = to_screen_x(s->position.x + x_offset + layer.offset.x);
+        dst_data[1] = to_screen_y(s->position.y + y_offset + layer.offset.y);
+        dst_data[2] = s->draw_angle;    // Angle
+        dst_data[3] = s->draw_centre_x; // Centre X
+        dst_data[4] = s->draw_centre_y; // Centre Y
+        dst_data[5] = s->draw_scale;    // Scale X
+        dst_data[6] = s->draw_scale;    // Scale Y
+    }
+
+    vector<float> sprite_draw_details(sprite s, bool rebuild)
+    {
+        vector<float> result;
+
+        if ( INVALID_PTR(s, SPRITE_PTR) ) return result;
+
+        if ( rebuild ) s->draw_data_valid = false;
+        _sprite_update_draw_data(s);
+
+        for (const _sprite_layer_draw_data &layer : s->draw_layers)
+        {
+            float dst_data[7];
+            _sprite_layer_dst_data(s, layer, 0, 0, dst_data);
+
+            result.insert(result.end(), layer.src_data, layer.src_data + 4);
+            result.insert(result.end(), dst_data, dst_data + 7);
+        }
+
+        return result;
+    }
+
     void draw_sprite(sprite s, float x_offset, float y_offset)
     {
         if ( INVALID_PTR(s, SPRITE_PTR) )
@@ -873,38 +1124,23 @@ namespace splashkit_lib
             return;
         }
 
-        float angle = sprite_rotation(s);
-        drawing_options opts;
+        sk_drawing_surface *dest = to_surface_ptr(_current_window);
+        if ( not dest ) return;
 
-        if (angle != 0)
-            opts = option_rotate_bmp( angle,
-                                     s->anchor_point.x - sprite_layer_width(s, 0) / 2.0f,
-                                     s->anchor_point.y  - sprite_layer_height(s, 0) / 2.0f );
-        else
-            opts = option_defaults();
+        _sprite_update_draw_data(s);
 
-        float scale = sprite_scale(s);
-        if (scale != 1)
-            opts = option_scale_bmp( scale, scale, opts );
+        for (_sprite_layer_draw_data &layer : s->draw_layers)
+        {
+            if ( INVALID_PTR(layer.bmp, BITMAP_PTR) )
+            {
+                LOG(WARNING) << "Error trying to draw sprite " << s->name << ": a layer has an invalid bitmap.";
+                continue;
+            }
 
-        opts = option_with_animation( s->animation_info, opts );
+            float dst_data[7];
+            _sprite_layer_dst_data(s, layer, x_offset, y_offset, dst_data);
 
-        int idx;
-        for (int i = 0; i < s->visible_layers.size(); i++)
-        {
-            idx = s->visible_layers[i];
-            if ( s->draw_at_anchor_point )
-                draw_bitmap(
-                            sprite_layer(s, idx),
-                            s->position.x - s->anchor_point.x + x_offset + s->layer_offsets[idx].x,
-                            s->position.y -s->anchor_point.y + y_offset + s->layer_offsets[idx].y,
-                            opts);
-            else
-                draw_bitmap(
-                            sprite_layer(s, idx),
-                            s->position.x + x_offset + s->layer_offsets[idx].x,
-                            s->position.y + y_offset + s->layer_offsets[idx].y,
-                            opts);
+            sk_draw_bitmap(&layer.bmp->image.surface, dest, layer.src_data, 4, dst_data, 7, sk_FLIP_NONE);
         }
     }
 
@@ -934,6 +1170,7 @@ namespace splashkit_lib
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
             s->anchor_point = pt;
+            s->draw_data_valid = false;
         }
         else
         {
@@ -980,8 +1217,24 @@ namespace splashkit_lib
             mvmt = distance;
         }
 
-        s->position.x += pct * mvmt.x;
-        s->position.y += pct * mvmt.y;
+        if ( s->parent )
+        {
+            // Attached sprites move relative to their parent. The local offset
+            // is in the parent's coordinates, so undo the parent's rotation
+            // and scale.
+            float parent_scale = sprite_scale(s->parent);
+            if ( parent_scale != 0 )
+            {
+                vector_2d local = matrix_multiply(rotation_matrix(-sprite_rotation(s->parent)), mvmt);
+                s->local_offset.x += pct * local.x / parent_scale;
+                s->local_offset.y += pct * local.y / parent_scale;
+            }
+        }
+        else
+        {
+            s->position.x += pct * mvmt.x;
+            s->position.y += pct * mvmt.y;
+        }
 
         if ( s->is_moving )
         {
@@ -1241,6 +1494,7 @@ namespace splashkit_lib
     {
         if ( INVALID_PTR(s, SPRITE_PTR) ) return;
         s->draw_at_anchor_point = value;
+        s->draw_data_valid = false;
     }
 
     void sprite_move_to(sprite s, const point_2d &pt, float taking_seconds)
@@ -1285,6 +1539,209 @@ namespace splashkit_lib
         return matrix_multiply(result, scale_matrix(scale));
     }
 
+    //---------------------------------------------------------------------------
+    // Sprite hierarchy
+    //---------------------------------------------------------------------------
+
+    //
+    // Move the sprite so that its anchor point is drawn at the indicated
+    // world location. This is the inverse of how sprite_location_matrix
+    // positions the anchor, which scales the sprite around its center.
+    //
+    void _sprite_place_anchor_at(sprite s, const point_2d &pt)
+    {
+        float scale = sprite_scale(s);
+        float w = sprite_layer_width(s, 0);
+        float h = sprite_layer_height(s, 0);
+
+        s->position.x = pt.x - w / 2.0f - scale * (s->anchor_point.x - w / 2.0f);
+        s->position.y = pt.y - h / 2.0f - scale * (s->anchor_point.y - h / 2.0f);
+    }
+
+    //
+    // Position the children of s, given the matrix that places s in the
+    // world. Each sprite's matrix is calculated once, before its children
+    // are placed, so the whole hierarchy is updated in a single pass.
+    //
+    void _update_sprite_children(sprite s, const matrix_2d &location)
+    {
+        float rotation = sprite_rotation(s);
+        float scale = sprite_scale(s);
+
+        for (sprite child : s->children)
+        {
+            _place_sprite_child(child, location, rotation, scale);
+        }
+    }
+
+    // Place the child using the details of its parent, then place its own
+    // children
+    void _place_sprite_child(sprite child, const matrix_2d &parent_location, float parent_rotation, float parent_scale)
+    {
+        sprite_set_rotation(child, parent_rotation + child->local_rotation);
+        sprite_set_scale(child, parent_scale * child->local_scale);
+
+        point_2d anchor = matrix_multiply(parent_location, point_offset_by(child->anchor_point, child->local_offset));
+        _sprite_place_anchor_at(child, anchor);
+
+        if ( child->children.size() > 0 )
+            _update_sprite_children(child, sprite_location_matrix(child));
+    }
+
+    //
+    // The sprites without a parent that have children attached. These are
+    // kept separately from the sprite packs, as the children of a sprite
+    // need not be in the same pack as it.
+    //
+    static vector<sprite> _root_sprites;
+
+    // Add or remove the sprite from the root sprites, after its parent or
+    // children have changed
+    static void _update_root_sprite(sprite s)
+    {
+        bool is_root = s->parent == nullptr and s->children.size() > 0;
+        bool listed = index_of(_root_sprites, s) >= 0;
+
+        if ( is_root and not listed )
+            _root_sprites.push_back(s);
+        else if ( listed and not is_root )
+            erase_from_vector(_root_sprites, s);
+    }
+
+    void _update_sprite_hierarchy()
+    {
+        for (sprite s : _root_sprites)
+        {
+            _update_sprite_children(s, sprite_location_matrix(s));
+        }
+    }
+
+    bool _sprite_is_ancestor(sprite ancestor, sprite s)
+    {
+        for (sprite current = s; current; current = current->parent)
+        {
+            if ( current == ancestor ) return true;
+        }
+        return false;
+    }
+
+    void sprite_set_parent(sprite s, sprite parent)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to set parent of invalid sprite";
+            return;
+        }
+
+        if ( parent and INVALID_PTR(parent, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to attach sprite " << s->name << " to invalid parent sprite";
+            return;
+        }
+
+        if ( parent and _sprite_is_ancestor(s, parent) )
+        {
+            LOG(WARNING) << "Unable to attach sprite " << s->name << " to " << parent->name << " as this would create a loop";
+            return;
+        }
+
+        if ( s->parent )
+        {
+            sprite old_parent = s->parent;
+            erase_from_vector(old_parent->children, s);
+            s->parent = nullptr;
+            _update_root_sprite(old_parent);
+        }
+
+        if ( not parent )
+        {
+            _update_root_sprite(s);
+            return;
+        }
+
+        // Keep the sprite where it is, relative to its new parent
+        point_2d anchor = matrix_multiply(sprite_location_matrix(s), s->anchor_point);
+        point_2d local = matrix_multiply(matrix_inverse(sprite_location_matrix(parent)), anchor);
+
+        s->local_offset = vector_point_to_point(s->anchor_point, local);
+        s->local_rotation = sprite_rotation(s) - sprite_rotation(parent);
+        s->local_scale = sprite_scale(parent) == 0 ? 1 : sprite_scale(s) / sprite_scale(parent);
+
+        s->parent = parent;
+        parent->children.push_back(s);
+
+        _update_root_sprite(s);
+        _update_root_sprite(parent);
+    }
+
+    sprite sprite_parent(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to use invalid sprite";
+            return nullptr;
+        }
+
+        return s->parent;
+    }
+
+    vector_2d sprite_local_offset(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to use invalid sprite";
+            return vector_to(0,0);
+        }
+
+        return s->local_offset;
+    }
+
+    void sprite_set_local_offset(sprite s, const vector_2d &value)
+    {
+        if ( VALID_PTR(s, SPRITE_PTR) )
+            s->local_offset = value;
+        else
+            LOG(WARNING) << "Attempting to use invalid sprite";
+    }
+
+    float sprite_local_rotation(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to use invalid sprite";
+            return 0;
+        }
+
+        return s->local_rotation;
+    }
+
+    void sprite_set_local_rotation(sprite s, float value)
+    {
+        if ( VALID_PTR(s, SPRITE_PTR) )
+            s->local_rotation = value;
+        else
+            LOG(WARNING) << "Attempting to use invalid sprite";
+    }
+
+    float sprite_local_scale(sprite s)
+    {
+        if ( INVALID_PTR(s, SPRITE_PTR) )
+        {
+            LOG(WARNING) << "Attempting to use invalid sprite";
+            return 0;
+        }
+
+        return s->local_scale;
+    }
+
+    void sprite_set_local_scale(sprite s, float value)
+    {
+        if ( VALID_PTR(s, SPRITE_PTR) )
+            s->local_scale = value;
+        else
+            LOG(WARNING) << "Attempting to use invalid sprite";
+    }
+
     //---------------------------------------------------------------------------
     // Sprite values
     //---------------------------------------------------------------------------
@@ -1337,7 +1794,14 @@ namespace splashkit_lib
                 value = value - trunc(value / 360) * 360;
             }
 
-            s->values[ROTATION_KEY] = value;
+            // Children are set to their parent's rotation on each update, so
+            // only rebuild the draw data when the rotation actually changes
+            float &rotation = s->values[ROTATION_KEY];
+            if ( rotation != value )
+            {
+                rotation = value;
+                s->draw_data_valid = false;
+            }
         }
         else
         {
@@ -1357,7 +1821,12 @@ namespace splashkit_lib
     {
         if ( VALID_PTR(s, SPRITE_PTR) )
         {
-            s->values[SCALE_KEY] = value;
+            float &scale = s->values[SCALE_KEY];
+            if ( scale != value )
+            {
+                scale = value;
+                s->draw_data_valid = false;
+            }
         }
     }
 
@@ -1419,6 +1888,7 @@ namespace splashkit_lib
         }
 
         s->values[name] = val;
+        s->draw_data_valid = false;
     }
 
     //---------------------------------------------------------------------------
@@ -1487,7 +1957,15 @@ namespace splashkit_lib
 
     void update_all_sprites(float pct)
     {
+        _updating_all_sprites = true;
         call_for_all_sprites(&_update_sprite_pct, pct);
+        _updating_all_sprites = false;
+
+        // Place the attached sprites in every pack, now their parents have moved
+        _update_sprite_hierarchy();
+
+        // Play the sounds of the frames the sprites entered, once each
+        flush_queued_sound_effects();
     }
 
     void call_for_all_sprites(sprite_function *fn)
@@ -28,7 +28,12 @@ namespace splashkit_lib
      *  @constant SPRITE_ARRIVED_EVENT   The sprite has arrived at the end of a move
      *  @constant SPRITE_ANIMATION_ENDED_EVENT The Sprite's animation has ended.
      *  @constant SPRITE_TOUCHED_EVENT         The Sprite was touched
-     *  @constant SPRITE_CLICKED_EVENT         The Sprite was touched
+     *  @constant SPRITE_CLICKED_EVENT         The Sprite was clicked. The mouse
+     *                                         is converted to game coordinates,
+     *                                         so the camera is taken into account.
+     *                                         When sprites overlap, only the
+     *                                         topmost sprite in its pack under
+     *                                         the mouse receives this event.
      */
     enum sprite_event_kind
     {
@@ -43,11 +48,15 @@ namespace splashkit_lib
      *
      * @constant PIXEL_COLLISIONS   The sprite will check for collisions with its collision bitmap.
      * @constant AABB_COLLISIONS    The sprite will check for collisions with a bounding box around the sprite.
+     * @constant POLYGON_COLLISIONS The sprite will check for collisions with polygons outlining the pixels
+     *                              of its collision bitmap. These are built from the bitmap once, and
+     *                              are faster than pixel collisions while being close to them in accuracy.
      */
     enum collision_test_kind
     {
         PIXEL_COLLISIONS,
-        AABB_COLLISIONS
+        AABB_COLLISIONS,
+        POLYGON_COLLISIONS
     };
 
     /**
@@ -1268,6 +1277,112 @@ namespace splashkit_lib
      */
     void sprite_set_move_from_anchor_point(sprite s, bool value);
 
+    //---------------------------------------------------------------------------
+    // sprite hierarchy
+    //---------------------------------------------------------------------------
+
+    /**
+     * Attaches a sprite to a parent sprite. Once attached the sprite's position,
+     * rotation, and scale follow the parent, using the sprite's local offset,
+     * rotation, and scale. These are set from the sprite's current location so
+     * that it does not move when attached. Each time `update_all_sprites` is
+     * called, all attached sprites are positioned once every sprite in the
+     * current pack has moved. This includes attached sprites in other packs.
+     * Calling `update_sprite` positions that sprite relative to its parent, and
+     * positions its own children. Pass `nullptr` as the parent to detach the
+     * sprite, leaving it where it is.
+     *
+     * @param s       The sprite to attach.
+     * @param parent  The sprite to attach it to, or `nullptr` to detach it.
+     *
+     * @attribute class sprite
+     * @attribute setter parent
+     */
+    void sprite_set_parent(sprite s, sprite parent);
+
+    /**
+     * Returns the sprite that this sprite is attached to.
+     *
+     * @param s   The sprite to get the details from.
+     * @returns   The parent sprite, or `nullptr` if the sprite is not attached.
+     *
+     * @attribute class sprite
+     * @attribute getter parent
+     */
+    sprite sprite_parent(sprite s);
+
+    /**
+     * Returns the offset of an attached sprite from its parent. This is in the
+     * parent's sprite coordinates, so as if the parent is drawn at 0,0 without
+     * rotation or scaling.
+     *
+     * @param s   The sprite to get the details from.
+     * @returns   The offset of the sprite from its parent.
+     *
+     * @attribute class sprite
+     * @attribute getter local_offset
+     */
+    vector_2d sprite_local_offset(sprite s);
+
+    /**
+     * Sets the offset of an attached sprite from its parent. This is in the
+     * parent's sprite coordinates, so as if the parent is drawn at 0,0 without
+     * rotation or scaling. Moving an attached sprite (for example with its
+     * velocity) changes this offset, so the sprite moves in the direction it
+     * faces whatever the rotation and scale of its parent.
+     *
+     * @param s       The sprite to change.
+     * @param value   The new offset from the parent.
+     *
+     * @attribute class sprite
+     * @attribute setter local_offset
+     */
+    void sprite_set_local_offset(sprite s, const vector_2d &value);
+
+    /**
+     * Returns the rotation of an attached sprite, relative to its parent.
+     *
+     * @param s   The sprite to get the details from.
+     * @returns   The angle of the sprite relative to its parent.
+     *
+     * @attribute class sprite
+     * @attribute getter local_rotation
+     */
+    float sprite_local_rotation(sprite s);
+
+    /**
+     * Sets the rotation of an attached sprite, relative to its parent.
+     *
+     * @param s       The sprite to change.
+     * @param value   The angle of the sprite relative to its parent.
+     *
+     * @attribute class sprite
+     * @attribute setter local_rotation
+     */
+    void sprite_set_local_rotation(sprite s, float value);
+
+    /**
+     * Returns the scale of an attached sprite, relative to its parent.
+     *
+     * @param s   The sprite to get the details from.
+     * @returns   The scale of the sprite relative to its parent.
+     *
+     * @attribute class sprite
+     * @attribute getter local_scale
+     */
+    float sprite_local_scale(sprite s);
+
+    /**
+     * Sets the scale of an attached sprite, relative to its parent.
+     *
+     * @param s       The sprite to change.
+     * @param value   The scale of the sprite relative to its parent.
+     *
+     * @attribute class sprite
+     * @attribute setter local_scale
+     */
+    void sprite_set_local_scale(sprite s, float value);
+
     //---------------------------------------------------------------------------
     // sprite velocity
     //---------------------------------------------------------------------------
@@ -1772,13 +1887,17 @@ namespace splashkit_lib
     void draw_all_sprites();
 
     /**
-     * Update all of the sprites in the current sprite pack.
+     * Update all of the sprites in the current sprite pack. Once the sprites
+     * have moved, all sprites attached to a parent are positioned relative to
+     * it, including those in other sprite packs.
      */
     void update_all_sprites();
 
     /**
      * Update all of the sprites in the current sprite pack, passing in a
-     * percentage value to indicate the percentage to update.
+     * percentage value to indicate the percentage to update. Once the sprites
+     * have moved, all sprites attached to a parent are positioned relative to
+     * it, including those in other sprite packs.
      *
      * @param pct The percentage of the update to apply.
      */
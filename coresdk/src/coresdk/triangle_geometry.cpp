@@ -7,6 +7,7 @@
 //
 
 #include "geometry.h"
+#include "utility_functions.h"
 
 #include <vector>
 using std::vector;
@@ -102,27 +103,69 @@ namespace splashkit_lib
             or point_in_triangle(point_at(r, b), tri);
     }
 
-    bool triangles_intersect(const triangle &t1, const triangle &t2)
+    // Project the points onto the axis, returning the range covered
+    static inline void _project_points(const point_2d *pts, int count, double axis_x, double axis_y, double &min, double &max)
     {
-        // Test if any of the points lie within the other triangle.
-        for (int i = 0; i < 3; i++)
+        min = max = pts[0].x * axis_x + pts[0].y * axis_y;
+
+        for (int i = 1; i < count; i++)
         {
-            if ( point_in_triangle(t1.points[i], t2) || point_in_triangle(t2.points[i], t1) ) return true;
+            double d = pts[i].x * axis_x + pts[i].y * axis_y;
+            if ( d < min ) min = d;
+            if ( d > max ) max = d;
         }
+    }
+
+    // Is there a gap between the points when projected on the axis?
+    static inline bool _separated_on_axis(const point_2d *a, int a_count, const point_2d *b, int b_count, double axis_x, double axis_y)
+    {
+        double min_a, max_a, min_b, max_b;
 
-        vector<line> t1_lines = lines_from(t1);
-        vector<line> t2_lines = lines_from(t2);
+        _project_points(a, a_count, axis_x, axis_y, min_a, max_a);
+        _project_points(b, b_count, axis_x, axis_y, min_b, max_b);
 
-        // Check if any lines intersect (check first two of both, as if they do not intersect then
-        // it cant intersect the third either)
-        for (int i = 0; i < 2; i++)
+        return max_a < min_b or max_b < min_a;
+    }
+
+    // This uses the separating axis test, checking the normals of each edge.
+    // Flat polygons are also checked along their edges and the axes, as they
+    // have no area to give a normal across.
+    bool convex_polygons_intersect(const point_2d *a, int a_count, const point_2d *b, int b_count)
+    {
+        if ( a_count <= 0 or b_count <= 0 ) return false;
+
+        for (int pass = 0; pass < 2; pass++)
         {
-            if ( lines_intersect( t1_lines[i], t2_lines[0] ) || lines_intersect( t1_lines[i], t2_lines[1] ) )
+            const point_2d *pts = pass == 0 ? a : b;
+            int count = pass == 0 ? a_count : b_count;
+            double area = 0;
+
+            for (int i = 0; i < count; i++)
             {
-                return true;
+                const point_2d &p1 = pts[i], &p2 = pts[(i + 1) % count];
+
+                area += p1.x * p2.y - p2.x * p1.y;
+
+                if ( _separated_on_axis(a, a_count, b, b_count, p1.y - p2.y, p2.x - p1.x) ) return false;
+            }
+
+            if ( area == 0 )
+            {
+                if ( _separated_on_axis(a, a_count, b, b_count, 1, 0) or _separated_on_axis(a, a_count, b, b_count, 0, 1) ) return false;
+
+                for (int i = 0; i < count; i++)
+                {
+                    const point_2d &p1 = pts[i], &p2 = pts[(i + 1) % count];
+                    if ( _separated_on_axis(a, a_count, b, b_count, p2.x - p1.x, p2.y - p1.y) ) return false;
+                }
             }
         }
 
-        return false;
+        return true;
+    }
+
+    bool triangles_intersect(const triangle &t1, const triangle &t2)
+    {
+        return convex_polygons_intersect(t1.points, 3, t2.points, 3);
     }
 }
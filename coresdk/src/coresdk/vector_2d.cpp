@@ -229,12 +229,12 @@ namespace splashkit_lib
         return v_out;
     }
 
-    bool line_intersects_lines(const line &l, const vector<line> &lines)
+    bool line_intersects_lines(const line &l, const line *lines, int count)
     {
         int i;
         point_2d pt;
 
-        for (i = 0; i < lines.size(); i++)
+        for (i = 0; i < count; i++)
         {
             if ( line_intersection_point(l, lines[i], pt) and point_on_line(pt, lines[i]) and point_on_line(pt, l))
             {
@@ -244,6 +244,20 @@ namespace splashkit_lib
         return false;
     }
 
+    bool line_intersects_lines(const line &l, const vector<line> &lines)
+    {
+        return line_intersects_lines(l, lines.data(), lines.size());
+    }
+
+    // The lines around a rectangle, in the same order as lines_from
+    static void _lines_from(const rectangle &rect, line result[4])
+    {
+        result[0] = line_from(rect.x, rect.y, rect.x + rect.width, rect.y);
+        result[1] = line_from(rect.x, rect.y, rect.x, rect.y + rect.height);
+        result[2] = line_from(rect.x + rect.width, rect.y, rect.x + rect.width, rect.y + rect.height);
+        result[3] = line_from(rect.x, rect.y + rect.height, rect.x + rect.width, rect.y + rect.height);
+    }
+
     struct double_pt
     {
         point_2d pt_on_circle, pt_on_line;
@@ -252,7 +266,7 @@ namespace splashkit_lib
     //
     // This internal function is used to calculate the vector and determine if a hit has occurred...
     //
-    vector_2d vector_over_lines_from_circle(const circle &c, const vector<line> lines, const vector_2d &velocity, int &max_idx)
+    vector_2d vector_over_lines_from_circle(const circle &c, const line *lines, int line_count, const vector_2d &velocity, int &max_idx)
     {
         point_2d pt_on_line, pt_on_circle;
         point_2d tmp[4], edge;
@@ -284,7 +298,7 @@ namespace splashkit_lib
         for (i = 0; i < 4; i++) tmp[i] = point_at(0,0);
 
         //Search all lines for hit points
-        for (i = 0; i < lines.size(); i++)
+        for (i = 0; i < line_count; i++)
         {
             line_vec = vector_from_line(lines[i]);
             //Get the normal of the line we hit
@@ -355,6 +369,11 @@ namespace splashkit_lib
         return v_out; //vector_to(ceil(v_out.x), ceil(v_out.y));
     }
 
+    vector_2d vector_over_lines_from_circle(const circle &c, const vector<line> &lines, const vector_2d &velocity, int &max_idx)
+    {
+        return vector_over_lines_from_circle(c, lines.data(), lines.size(), velocity, max_idx);
+    }
+
     vector<point_2d> points_from(const rectangle &rect)
     {
         vector<point_2d> result;
@@ -373,12 +392,12 @@ namespace splashkit_lib
         return result;
     }
 
-    vector_2d vector_over_lines_from_lines(const vector<line> &src_lines, const vector<line> &bound_lines, const vector_2d &velocity, int &max_idx)
+    vector_2d vector_over_lines_from_lines(const line *src_lines, int src_count, const line *bound_lines, int bound_count, const vector_2d &velocity, int &max_idx)
     {
         vector_2d ray, v_out;
         int i, j, k;
         float max_dist;
-        vector<point_2d> ln_points, bound_ln_points;
+        point_2d ln_points[2], bound_ln_points[2];
         bool both_did_hit;
 
         // Search from the start_pt for the ray
@@ -430,21 +449,23 @@ namespace splashkit_lib
         //
         //  Search all lines for hit points - cast ray back from line ends and find where these intersect with the bound lines
         //
-        for (i = 0; i < bound_lines.size(); i++)
+        for (i = 0; i < bound_count; i++)
         {
             //WriteLn('Testing bound line: ', LineToString(bound_lines[i]));
-            bound_ln_points = points_from(bound_lines[i]);
+            bound_ln_points[0] = bound_lines[i].start_point;
+            bound_ln_points[1] = bound_lines[i].end_point;
 
             // for all source lines...
-            for (j = 0; j < src_lines.size(); j++)
+            for (j = 0; j < src_count; j++)
             {
                 //WriteLn('Testing src line: ', LineToString(src_lines[j]));
 
                 // Get the points from the srcLine
-                ln_points = points_from(src_lines[j]);
+                ln_points[0] = src_lines[j].start_point;
+                ln_points[1] = src_lines[j].end_point;
                 both_did_hit = true;
 
-                for (k = 0; k < ln_points.size(); k++)
+                for (k = 0; k < 2; k++)
                 {
                     //WriteLn('Point ', k, ' in line is at ', PointToString(ln_points[k]));
                     both_did_hit = ray_from_pt_hit_line(ln_points[k], bound_lines[i], ray) and both_did_hit;
@@ -454,7 +475,7 @@ namespace splashkit_lib
 
                 // Search from the bound line to the source
 
-                for (k = 0; k < bound_ln_points.size(); k++)
+                for (k = 0; k < 2; k++)
                 {
                     ray_from_pt_hit_line(bound_ln_points[k], src_lines[j], velocity);
                 }
@@ -464,10 +485,20 @@ namespace splashkit_lib
         return v_out;
     }
 
+    vector_2d vector_over_lines_from_lines(const vector<line> &src_lines, const vector<line> &bound_lines, const vector_2d &velocity, int &max_idx)
+    {
+        return vector_over_lines_from_lines(src_lines.data(), src_lines.size(), bound_lines.data(), bound_lines.size(), velocity, max_idx);
+    }
+
     vector_2d vector_out_of_rect_from_rect(const rectangle &src, const rectangle &bounds, const vector_2d &velocity)
     {
         int max_idx = 0;
-        return vector_over_lines_from_lines(lines_from(src), lines_from(bounds), velocity, max_idx);
+        line src_lines[4], bound_lines[4];
+
+        _lines_from(src, src_lines);
+        _lines_from(bounds, bound_lines);
+
+        return vector_over_lines_from_lines(src_lines, 4, bound_lines, 4, velocity, max_idx);
     }
     
     vector_2d vector_out_of_circle_from_point(const point_2d &pt, const circle &c, const vector_2d &velocity)
@@ -519,6 +550,10 @@ namespace splashkit_lib
     vector_2d vector_out_of_rect_from_circle(const circle &c, const rectangle &rect, const vector_2d &velocity)
     {
         int max_idx;
-        return vector_over_lines_from_circle(c, lines_from(rect), velocity, max_idx);
+        line rect_lines[4];
+
+        _lines_from(rect, rect_lines);
+
+        return vector_over_lines_from_circle(c, rect_lines, 4, velocity, max_idx);
     }
 }
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "window_manager.h"
 #include "graphics_driver.h"
 #include "resources.h"
+#include "sound.h"
 #include "backend_types.h"
 #include "utility_functions.h"
 #include "input_driver.h"
@@ -111,6 +112,9 @@ namespace splashkit_lib
             return;
         }
 
+        // Play any sounds queued by animations updated this frame
+        flush_queued_sound_effects();
+
         sk_refresh_window(&wind->image.surface);
     }
 
@@ -15,10 +15,51 @@
 #include "input.h"
 
 #include <vector>
+#include <algorithm>
 #include <iostream>
 using namespace std;
 using namespace splashkit_lib;
 
+void test_update_all_animations(animation_script kermit, bitmap frog)
+{
+    vector<animation> frogs, entered, ended;
+
+    // Start each frog part way through, so they are not all in step
+    for (int i = 0; i < 1000; i++)
+    {
+        frogs.push_back(create_animation(kermit, "dance", false));
+        update_animation(frogs.back(), i % 37, false);
+    }
+
+    while( not quit_requested() and frogs.size() > 0 )
+    {
+        process_events();
+
+        clear_screen(COLOR_WHITE);
+
+        // Draw the first frogs in a grid, the rest are just updated
+        for (int i = 0; i < 40 and i < frogs.size(); i++)
+        {
+            draw_bitmap(frog, (i % 8) * 75, (i / 8) * 110, option_with_animation(frogs[i]));
+        }
+
+        update_all_animations(1, entered, ended);
+
+        for (animation anim : ended)
+        {
+            frogs.erase(find(frogs.begin(), frogs.end(), anim));
+            free_animation(anim);
+        }
+
+        refresh_screen();
+    }
+
+    for (animation anim : frogs)
+    {
+        free_animation(anim);
+    }
+}
+
 void run_animation_test()
 {
     vector<string> sequence = { "Walkfront", "WalkLeft", "WalkRight", "WALKBACK", "dance" };
@@ -62,6 +103,8 @@ void run_animation_test()
         if (quit_requested() ) break;
     }
     
+    test_update_all_animations(kermit, frog);
+
     free_animation_script(kermit);
     free_bitmap(frog);
     close_window(window_named("Test Animation"));
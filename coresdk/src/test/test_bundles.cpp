@@ -14,6 +14,10 @@
 #include "images.h"
 #include "timers.h"
 #include "text.h"
+#include "graphics.h"
+#include "input.h"
+#include "color.h"
+#include "rectangle_drawing.h"
 
 #include <iostream>
 using namespace std;
@@ -68,4 +72,35 @@ void run_bundle_test()
     cout << "  Ufo:         " << has_bitmap("ufo") << endl;
     cout << "  Bundle test: " << has_resource_bundle("test") << endl;
     
-}
\ No newline at end of file
+
+    cout << "Loading from an archive:" << endl;
+
+    cout << "  Created:     " << create_resource_archive("test.txt", "test.skpack") << endl;
+    load_resource_bundle("test", "test.skpack");
+    cout << "  Bundle test: " << has_resource_bundle("test") << endl;
+    cout << "  Bitmap:      " << has_bitmap("FrogBmp") << endl;
+    cout << "  Ufo:         " << has_bitmap("ufo") << endl;
+    free_resource_bundle("test");
+
+    cout << "Loading in the background:" << endl;
+
+    window w = open_window("Loading Bundle", 400, 100);
+    load_resource_bundle_async("test", "test.txt");
+
+    while ( resource_bundle_loading("test") and not quit_requested() )
+    {
+        process_events();
+
+        clear_screen(COLOR_WHITE);
+        draw_rectangle(COLOR_BLACK, 50, 40, 300, 20);
+        fill_rectangle(COLOR_GREEN, 50, 40, 300 * resource_bundle_load_progress("test"), 20);
+        refresh_screen(60);
+    }
+
+    cout << "  Bundle test: " << has_resource_bundle("test") << endl;
+    cout << "  Bitmap:      " << has_bitmap("FrogBmp") << endl;
+    cout << "  Ufo:         " << has_bitmap("ufo") << endl;
+
+    free_resource_bundle("test");
+    close_window(w);
+}
@@ -7,9 +7,13 @@
 //
 
 #include <iostream>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
 using namespace std;
 
 #include "geometry.h"
+#include "matrix_2d.h"
 #include "window_manager.h"
 #include "graphics.h"
 #include "input.h"
@@ -127,8 +131,54 @@ void test_rectangle()
     close_window(w1);
 }
 
+// Time how long it takes to run fn count times, in milliseconds
+template <typename fn_type>
+long long time_ms(int count, fn_type fn)
+{
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < count; i++) fn(i);
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+}
+
+void test_transform_speed()
+{
+    const int count = 1000000;
+    volatile float sink = 0;
+
+    cout << "Timing " << count << " calls of each..." << endl;
+
+    use_fast_trigonometry(false);
+    cout << "sine + cosine:           " << time_ms(count, [&] (int i) { sink = sink + sine(i * 0.37f) + cosine(i * 0.37f); }) << "ms" << endl;
+    cout << "rotation_matrix:         " << time_ms(count, [&] (int i) { sink = sink + rotation_matrix(i * 0.37f).elements[0][1]; }) << "ms" << endl;
+
+    use_fast_trigonometry(true);
+    cout << "fast sine + cosine:      " << time_ms(count, [&] (int i) { sink = sink + sine(i * 0.37f) + cosine(i * 0.37f); }) << "ms" << endl;
+    cout << "fast rotation_matrix:    " << time_ms(count, [&] (int i) { sink = sink + rotation_matrix(i * 0.37f).elements[0][1]; }) << "ms" << endl;
+    use_fast_trigonometry(false);
+
+    float max_error = 0;
+    for (int i = 0; i < count; i++)
+    {
+        float deg = i * 0.37f - 180000;
+        max_error = max(max_error, fabs(fast_sine(deg) - sine(deg)));
+        max_error = max(max_error, fabs(fast_cosine(deg) - cosine(deg)));
+    }
+    cout << "Largest fast trig error (should be under 1e-7): " << max_error << endl;
+
+    // Changing the bottom row stops the affine fast path being used
+    matrix_2d affine = matrix_multiply(translation_matrix(10, 20), rotation_matrix(30));
+    matrix_2d general = affine;
+    general.elements[2][2] = 1.0001;
+
+    cout << "affine matrix_multiply:  " << time_ms(count, [&] (int i) { affine.elements[0][2] = i; sink = sink + matrix_multiply(affine, affine).elements[0][2]; }) << "ms" << endl;
+    cout << "general matrix_multiply: " << time_ms(count, [&] (int i) { general.elements[0][2] = i; sink = sink + matrix_multiply(general, general).elements[0][2]; }) << "ms" << endl;
+    cout << "affine matrix_inverse:   " << time_ms(count, [&] (int i) { affine.elements[0][2] = i; sink = sink + matrix_inverse(affine).elements[0][2]; }) << "ms" << endl;
+    cout << "general matrix_inverse:  " << time_ms(count, [&] (int i) { general.elements[0][2] = i; sink = sink + matrix_inverse(general).elements[0][2]; }) << "ms" << endl;
+}
+
 void run_geometry_test()
 {
+    test_transform_speed();
     test_rectangle();
     test_points();
 }
\ No newline at end of file
@@ -37,10 +37,12 @@ void setup_tests()
     add_test("Geometry", run_geometry_test);
     add_test("Graphics", run_graphics_test);
     add_test("Input", run_input_test);
+    add_test("Particles", run_particles_test);
     add_test("Physics", run_physics_test);
     add_test("Resources", run_resources_tests);
     add_test("Shape drawing", run_shape_drawing_test);
     add_test("Sprite tests", run_sprite_test);
+    add_test("Sprite clicks", run_sprite_click_test);
     add_test("Text", run_text_test);
     add_test("Timers", run_timer_test);
     add_test("Windows", run_windows_tests);
@@ -23,8 +23,10 @@ void run_timer_test();
 void run_input_test();
 void run_geometry_test();
 void run_physics_test();
+void run_particles_test();
 void run_web_server_tests();
 void run_sprite_test();
+void run_sprite_click_test();
 void run_bundle_test();
 void run_camera_test();
 void test_cave_escape();
@@ -0,0 +1,66 @@
+//
+//  test_particles.cpp
+//  splashkit
+//
+//  Copyright © 2016 Andrew Cain. All rights reserved.
+//
+
+#include "window_manager.h"
+#include "text.h"
+#include "color.h"
+#include "input.h"
+#include "images.h"
+#include "circle_drawing.h"
+#include "particles.h"
+#include "graphics.h"
+
+using namespace splashkit_lib;
+
+void run_particles_test()
+{
+    window w1 = open_window("Particles Test", 800, 600);
+
+    // A small soft dot to draw each particle with
+    bitmap dot = create_bitmap("particle dot", 8, 8);
+    clear_bitmap(dot, COLOR_TRANSPARENT);
+    fill_circle(COLOR_WHITE, 4, 4, 4, option_draw_to(dot));
+
+    particle_emitter fountain = create_particle_emitter("fountain", dot, 500000);
+    particle_emitter_set_position(fountain, point_at(400, 550));
+    particle_emitter_set_gravity(fountain, vector_to(0, 200));
+    particle_emitter_set_speed(fountain, 200, 400);
+    particle_emitter_set_direction(fountain, 270, 15);
+    particle_emitter_set_life(fountain, 1.5, 2.5);
+    particle_emitter_set_colors(fountain, COLOR_YELLOW, COLOR_ORANGE_RED);
+    particle_emitter_set_rate(fountain, 1000);
+
+    while( not window_close_requested(w1) )
+    {
+        process_events();
+
+        if ( key_typed(UP_KEY) )
+            particle_emitter_set_rate(fountain, particle_emitter_rate(fountain) * 2);
+        if ( key_typed(DOWN_KEY) )
+            particle_emitter_set_rate(fountain, particle_emitter_rate(fountain) / 2);
+        if ( key_typed(T_KEY) )
+            particle_emitter_set_use_threads(fountain, true);
+        if ( mouse_clicked(LEFT_BUTTON) )
+        {
+            particle_emitter_set_position(fountain, mouse_position());
+            emit_particles(fountain, 5000);
+        }
+
+        update_particle_emitter(fountain, 1 / 60.0f);
+
+        clear_screen(COLOR_BLACK);
+        draw_particle_emitter(fountain);
+
+        draw_text("Up/down to change rate, T for threads, click to burst", COLOR_WHITE, 10, 10);
+        draw_text(to_string(particle_emitter_particle_count(fountain)) + " particles", COLOR_WHITE, 10, 20);
+        refresh_screen(60);
+    }
+
+    free_particle_emitter(fountain);
+    free_bitmap(dot);
+    close_window(w1);
+}
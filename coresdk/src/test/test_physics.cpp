@@ -13,6 +13,7 @@ using namespace std;
 #include "input.h"
 #include "physics.h"
 #include "graphics.h"
+#include "text.h"
 
 using namespace splashkit_lib;
 
@@ -79,6 +80,60 @@ void do_test_vector()
     close_window(w1);
 }
 
+void do_test_physics_world()
+{
+    window w1 = open_window("Physics World Test", 600, 600);
+
+    physics_world world = create_physics_world("test world");
+    physics_world_set_gravity(world, vector_to(0, 500));
+
+    // The floor and walls do not move
+    create_physics_body(world, rectangle_from(0, 580, 600, 20), 0);
+    create_physics_body(world, rectangle_from(0, 0, 20, 580), 0);
+    create_physics_body(world, rectangle_from(580, 0, 20, 580), 0);
+
+    vector<physics_body> boxes, balls;
+    for (int i = 0; i < 8; i++)
+        boxes.push_back(create_physics_body(world, rectangle_from(280, 539 - i * 41, 40, 40), 1));
+
+    while( not window_close_requested(w1))
+    {
+        process_events();
+
+        if ( mouse_clicked(LEFT_BUTTON) )
+            boxes.push_back(create_physics_body(world, rectangle_from(mouse_x() - 20, mouse_y() - 20, 40, 40), 1));
+        if ( mouse_clicked(RIGHT_BUTTON) )
+        {
+            physics_body ball = create_physics_body(world, circle_at(mouse_position(), 15), 0.5);
+            physics_body_set_restitution(ball, 0.8);
+            balls.push_back(ball);
+        }
+
+        update_physics_world(world, 1 / 60.0f);
+
+        clear_screen(COLOR_WHITE);
+        fill_rectangle(COLOR_GRAY, 0, 580, 600, 20);
+        fill_rectangle(COLOR_GRAY, 0, 0, 20, 580);
+        fill_rectangle(COLOR_GRAY, 580, 0, 20, 580);
+
+        for (physics_body box : boxes)
+        {
+            point_2d pt = physics_body_position(box);
+            matrix_2d m = matrix_multiply(rotation_matrix(physics_body_rotation(box)), translation_matrix(pt.x, pt.y));
+            draw_quad(COLOR_BLUE, quad_from(rectangle_from(-20, -20, 40, 40), m));
+        }
+        for (physics_body ball : balls)
+            draw_circle(COLOR_RED, circle_at(physics_body_position(ball), 15));
+
+        draw_text("Left click to drop a box, right click to drop a ball", COLOR_BLACK, 30, 10);
+        draw_text(to_string(physics_world_body_count(world)) + " bodies", COLOR_BLACK, 30, 20);
+        refresh_screen(60);
+    }
+
+    free_physics_world(world);
+    close_window(w1);
+}
+
 void run_physics_test()
 {
     matrix_2d matrix = identity_matrix();
@@ -136,4 +191,5 @@ void run_physics_test()
     cout << matrix_to_string(matrix_multiply(matrix, inv_matrix)) << endl;
     
     do_test_vector();
+    do_test_physics_world();
 }
\ No newline at end of file
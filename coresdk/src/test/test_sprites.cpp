@@ -12,6 +12,8 @@
 #include "images.h"
 #include "input.h"
 #include "sprites.h"
+#include "camera.h"
+#include "text.h"
 #include "window_manager.h"
 
 using namespace splashkit_lib;
@@ -143,3 +145,56 @@ void run_sprite_test()
     
     close_all_windows();
 }
+
+static string _last_clicked = "none";
+
+static void _sprite_clicked(sprite s, sprite_event_kind evt)
+{
+    if ( evt == SPRITE_CLICKED_EVENT ) _last_clicked = sprite_name(s);
+}
+
+// Three overlapping sprites with the camera moved away from the origin.
+// Clicking where they overlap should report only the topmost (the last one
+// created), and clicks should match where the sprites are drawn.
+void run_sprite_click_test()
+{
+    open_window("Sprite Clicks", 600, 600);
+
+    bitmap bmp = bitmap_named("rocket_sprt.png");
+    sprite sprts[3];
+
+    for (int i = 0; i < 3; i++)
+    {
+        sprts[i] = create_sprite(bmp);
+        sprite_set_x(sprts[i], 400 + i * bitmap_width(bmp) / 3);
+        sprite_set_y(sprts[i], 350 + i * bitmap_height(bmp) / 3);
+        sprite_call_on_event(sprts[i], _sprite_clicked);
+    }
+
+    set_camera_position(point_at(250, 200));
+
+    while ( not quit_requested() )
+    {
+        process_events();
+
+        if ( key_down(LEFT_KEY) ) move_camera_by(-2, 0);
+        if ( key_down(RIGHT_KEY) ) move_camera_by(2, 0);
+        if ( key_down(UP_KEY) ) move_camera_by(0, -2);
+        if ( key_down(DOWN_KEY) ) move_camera_by(0, 2);
+
+        update_all_sprites();
+
+        clear_screen(COLOR_WHITE);
+        draw_all_sprites();
+
+        draw_text("Click the sprites, arrow keys move the camera", COLOR_BLACK, 10, 10, option_to_screen());
+        draw_text("Clicked: " + _last_clicked + " (expect " + sprite_name(sprts[2]) + " where all overlap)", COLOR_BLACK, 10, 30, option_to_screen());
+
+        refresh_screen();
+    }
+
+    set_camera_position(point_at(0, 0));
+
+    for (int i = 0; i < 3; i++) free_sprite(sprts[i]);
+    close_all_windows();
+}
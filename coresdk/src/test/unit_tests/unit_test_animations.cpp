@@ -0,0 +1,214 @@
+/**
+ * Animation Unit Tests
+ *
+ * Time based updates, which can move an animation through many frames at
+ * once. These use catch_up.txt, where "intro" plays two frames once then
+ * loops over two more, and "once" plays two frames then ends.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+#include <algorithm>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "animations.h"
+#include "resources.h"
+#include "utility_functions.h"
+
+using namespace splashkit_lib;
+
+// Time based updates treat 60 updates as one second
+static float seconds_for(float updates)
+{
+    return updates / 60.0f;
+}
+
+TEST_CASE("animations can catch up by time", "[animations]")
+{
+    animation_script script = load_animation_script("catch_up", "catch_up.txt");
+    REQUIRE(script != nullptr);
+
+    SECTION("catching up through the intro into the loop")
+    {
+        animation anim = create_animation(script, "intro", false);
+
+        // 2 + 3 updates for the intro, two trips around the loop, then one
+        // more frame with half an update left over
+        update_animation_by_time(anim, seconds_for(10.5f), false);
+
+        REQUIRE_FALSE(animation_ended(anim));
+        REQUIRE(animation_current_cell(anim) == 3);
+        REQUIRE(animation_frame_time(anim) == Approx(0.5f).margin(0.001));
+        REQUIRE(animation_entered_frame(anim));
+    }
+
+    SECTION("catching up matches updating one step at a time")
+    {
+        animation stepped = create_animation(script, "intro", false);
+        animation caught_up = create_animation(script, "intro", false);
+
+        for (int i = 0; i < 47; i++)
+            update_animation(stepped, 0.5f, false);
+
+        update_animation_by_time(caught_up, seconds_for(23.5f), false);
+
+        REQUIRE(animation_current_cell(caught_up) == animation_current_cell(stepped));
+        REQUIRE(animation_frame_time(caught_up) == Approx(animation_frame_time(stepped)).margin(0.001));
+    }
+
+    SECTION("skipped frames count the frames passed over")
+    {
+        animation anim = create_animation(script, "intro", false);
+
+        // Within the first frame
+        update_animation_by_time(anim, seconds_for(1.5f), false);
+        REQUIRE_FALSE(animation_entered_frame(anim));
+        REQUIRE(animation_skipped_frames(anim) == 0);
+
+        // Into the next frame, skipping none
+        update_animation_by_time(anim, seconds_for(1), false);
+        REQUIRE(animation_entered_frame(anim));
+        REQUIRE(animation_skipped_frames(anim) == 0);
+
+        // Frames 2, 3, 2, 3 and 2 are entered; only the last is shown
+        update_animation_by_time(anim, seconds_for(7), false);
+        REQUIRE(animation_current_cell(anim) == 2);
+        REQUIRE(animation_skipped_frames(anim) == 4);
+    }
+
+    SECTION("ending on the terminal frame")
+    {
+        animation anim = create_animation(script, "once", false);
+
+        update_animation_by_time(anim, seconds_for(100), false);
+
+        REQUIRE(animation_ended(anim));
+        REQUIRE(animation_current_cell(anim) == 5);
+        REQUIRE(animation_skipped_frames(anim) == 1);
+
+        // Nothing more happens once the animation has ended
+        update_animation_by_time(anim, seconds_for(100), false);
+        REQUIRE(animation_ended(anim));
+        REQUIRE(animation_current_cell(anim) == 5);
+    }
+
+    SECTION("a very long pause stays in the loop")
+    {
+        animation anim = create_animation(script, "intro", false);
+
+        // About 36 billion updates, many more frames than an int can count
+        update_animation_by_time(anim, 6.0e8f, false);
+
+        REQUIRE_FALSE(animation_ended(anim));
+        REQUIRE((animation_current_cell(anim) == 2 or animation_current_cell(anim) == 3));
+        REQUIRE(animation_skipped_frames(anim) == INT_MAX - 1);
+        REQUIRE(animation_frame_time(anim) >= 0);
+        REQUIRE(animation_frame_time(anim) < 1);
+    }
+
+    free_animation_script(script);
+}
+
+// The catch_up script, with the given cell for frame 2. Cells below 10 keep
+// the text the same size.
+static string cache_test_script(int cell)
+{
+    return "SplashKit Animation\n"
+           "f:0,0,2,1\nf:1,1,3,2\nf:2," + to_string(cell) + ",1,3\nf:3,3,1,2\n"
+           "f:4,4,2,5\nf:5,5,2,\n"
+           "i:intro,0\ni:once,4\n";
+}
+
+static void write_file(const string &path, const string &text)
+{
+    ofstream out(path, ios::binary | ios::trunc);
+    out << text;
+}
+
+// The cells shown by each animation in the script over its first updates
+static vector<int> animation_cells(animation_script script)
+{
+    vector<int> result;
+
+    for (int i = 0; i < animation_count(script); i++)
+    {
+        animation anim = create_animation(script, i, false);
+
+        for (int j = 0; j < 12; j++)
+        {
+            result.push_back(animation_current_cell(anim));
+            update_animation(anim, 1, false);
+        }
+
+        free_animation(anim);
+    }
+
+    return result;
+}
+
+TEST_CASE("compiled animation scripts are cached", "[animations]")
+{
+    string folder = path_to_resources(ANIMATION_RESOURCE);
+    string script_path = path_to_resource("cache_test.txt", ANIMATION_RESOURCE);
+    string cache_path = cache_file_for(folder, script_path, ".skanim");
+
+    write_file(script_path, cache_test_script(2));
+    set_animation_cache_path(folder);
+    REQUIRE_FALSE(animation_script_cached("cache_test.txt"));
+
+    // The first load parses the text, and caches the compiled script
+    animation_script parsed = load_animation_script("cache_parsed", "cache_test.txt");
+    REQUIRE(parsed != nullptr);
+    vector<int> parsed_cells = animation_cells(parsed);
+    REQUIRE(animation_script_cached("cache_test.txt"));
+
+    SECTION("loading again reads the same script from the cache")
+    {
+        animation_script cached = load_animation_script("cache_read", "cache_test.txt");
+        REQUIRE(cached != nullptr);
+        REQUIRE(animation_cells(cached) == parsed_cells);
+        REQUIRE(animation_index(cached, "once") == animation_index(parsed, "once"));
+        free_animation_script(cached);
+    }
+
+    SECTION("an edit that keeps the size rebuilds the cache")
+    {
+        write_file(script_path, cache_test_script(7));
+        REQUIRE_FALSE(animation_script_cached("cache_test.txt"));
+
+        animation_script edited = load_animation_script("cache_edited", "cache_test.txt");
+        REQUIRE(edited != nullptr);
+
+        vector<int> edited_cells = animation_cells(edited);
+        REQUIRE(edited_cells != parsed_cells);
+        REQUIRE(find(edited_cells.begin(), edited_cells.end(), 7) != edited_cells.end());
+        REQUIRE(animation_script_cached("cache_test.txt"));
+        free_animation_script(edited);
+    }
+
+    SECTION("a cache too short for its counts is rebuilt")
+    {
+        // Keep the header, which is up to date, and a few bytes more
+        ifstream input(cache_path, ios::binary);
+        string compiled((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+        input.close();
+        write_file(cache_path, compiled.substr(0, 48));
+        REQUIRE_FALSE(animation_script_cached("cache_test.txt"));
+
+        animation_script rebuilt = load_animation_script("cache_rebuilt", "cache_test.txt");
+        REQUIRE(rebuilt != nullptr);
+        REQUIRE(animation_cells(rebuilt) == parsed_cells);
+        REQUIRE(animation_script_cached("cache_test.txt"));
+        free_animation_script(rebuilt);
+    }
+
+    free_animation_script(parsed);
+    set_animation_cache_path("");
+    remove(cache_path.c_str());
+    remove(script_path.c_str());
+}
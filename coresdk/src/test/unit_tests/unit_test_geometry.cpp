@@ -0,0 +1,137 @@
+/**
+ * Geometry Unit Tests
+ *
+ * Intersection tests for quads, rectangles and triangles. Shapes that only
+ * touch along an edge or at a corner intersect.
+ */
+
+#include <vector>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "geometry.h"
+#include "matrix_2d.h"
+#include "utility_functions.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("quads can be tested for intersection", "[geometry]")
+{
+    quad q1 = quad_from(point_at(0, 0), point_at(10, 0), point_at(0, 10), point_at(10, 10));
+
+    SECTION("overlapping quads intersect")
+    {
+        quad q2 = quad_from(point_at(5, 5), point_at(15, 5), point_at(5, 15), point_at(15, 15));
+        REQUIRE(quads_intersect(q1, q2));
+        REQUIRE(quads_intersect(q2, q1));
+    }
+
+    SECTION("separate quads do not intersect")
+    {
+        quad q2 = quad_from(point_at(11, 0), point_at(21, 0), point_at(11, 10), point_at(21, 10));
+        REQUIRE_FALSE(quads_intersect(q1, q2));
+        REQUIRE_FALSE(quads_intersect(q2, q1));
+    }
+
+    SECTION("a diamond near the corner does not intersect")
+    {
+        // The diamond's bounding box overlaps q1, but the diamond does not
+        quad diamond = quad_from(point_at(14, 7), point_at(19, 12), point_at(9, 12), point_at(14, 17));
+        REQUIRE_FALSE(quads_intersect(q1, diamond));
+        REQUIRE_FALSE(quads_intersect(diamond, q1));
+    }
+
+    SECTION("a quad inside another intersects")
+    {
+        quad q2 = quad_from(point_at(2, 2), point_at(4, 2), point_at(2, 4), point_at(4, 4));
+        REQUIRE(quads_intersect(q1, q2));
+        REQUIRE(quads_intersect(q2, q1));
+    }
+}
+
+TEST_CASE("quads can be tested against rectangles", "[geometry]")
+{
+    quad q = quad_from(rectangle_from(0, 0, 10, 10), rotation_matrix(45));
+
+    REQUIRE(quad_rectangle_intersect(q, rectangle_from(-2, 2, 4, 4)));
+    REQUIRE_FALSE(quad_rectangle_intersect(q, rectangle_from(20, 20, 5, 5)));
+
+    // Inside the bounding box of the rotated quad, but outside the quad
+    REQUIRE_FALSE(quad_rectangle_intersect(q, rectangle_from(4, 0, 2, 2)));
+}
+
+TEST_CASE("triangles can be tested for intersection", "[geometry]")
+{
+    triangle t1 = triangle_from(0, 0, 10, 0, 0, 10);
+
+    REQUIRE(triangles_intersect(t1, triangle_from(2, 2, 12, 2, 2, 12)));
+    REQUIRE(triangles_intersect(t1, triangle_from(1, 1, 2, 1, 1, 2)));
+
+    // Beyond the long edge, though within the bounding box
+    REQUIRE_FALSE(triangles_intersect(t1, triangle_from(6, 6, 10, 6, 6, 10)));
+    REQUIRE_FALSE(triangles_intersect(t1, triangle_from(20, 0, 30, 0, 20, 10)));
+}
+
+TEST_CASE("touching shapes intersect", "[geometry]")
+{
+    SECTION("quads sharing an edge")
+    {
+        quad q1 = quad_from(point_at(0, 0), point_at(10, 0), point_at(0, 10), point_at(10, 10));
+        quad q2 = quad_from(point_at(10, 0), point_at(20, 0), point_at(10, 10), point_at(20, 10));
+        REQUIRE(quads_intersect(q1, q2));
+    }
+
+    SECTION("triangles sharing a corner")
+    {
+        REQUIRE(triangles_intersect(triangle_from(0, 0, 10, 0, 0, 10), triangle_from(10, 0, 20, 0, 20, 10)));
+    }
+
+    SECTION("polygons used by collisions follow the same rule")
+    {
+        point_2d a[] = { point_at(0, 0), point_at(10, 0), point_at(10, 10), point_at(0, 10) };
+        point_2d b[] = { point_at(10, 0), point_at(20, 0), point_at(20, 10), point_at(10, 10) };
+        point_2d c[] = { point_at(11, 0), point_at(20, 0), point_at(20, 10), point_at(11, 10) };
+
+        REQUIRE(convex_polygons_intersect(a, 4, b, 4));
+        REQUIRE_FALSE(convex_polygons_intersect(a, 4, c, 4));
+    }
+}
+
+TEST_CASE("degenerate shapes can be tested for intersection", "[geometry]")
+{
+    triangle t1 = triangle_from(0, 0, 10, 0, 0, 10);
+
+    SECTION("flat triangles are treated as lines")
+    {
+        triangle crossing = triangle_from(-5, 5, 5, 5, 15, 5);
+        triangle beside = triangle_from(-5, 20, 5, 20, 15, 20);
+        triangle along_axis = triangle_from(11, -5, 11, 0, 11, 5);
+
+        REQUIRE(triangles_intersect(t1, crossing));
+        REQUIRE_FALSE(triangles_intersect(t1, beside));
+        REQUIRE_FALSE(triangles_intersect(t1, along_axis));
+    }
+
+    SECTION("a triangle collapsed to a point")
+    {
+        REQUIRE(triangles_intersect(t1, triangle_from(2, 2, 2, 2, 2, 2)));
+        REQUIRE_FALSE(triangles_intersect(t1, triangle_from(8, 8, 8, 8, 8, 8)));
+    }
+
+    SECTION("lines that cross diagonally")
+    {
+        triangle l1 = triangle_from(0, 0, 5, 5, 10, 10);
+        triangle l2 = triangle_from(0, 10, 5, 5, 10, 0);
+        triangle l3 = triangle_from(0, 1, 5, 6, 10, 11);
+
+        REQUIRE(triangles_intersect(l1, l2));
+        REQUIRE_FALSE(triangles_intersect(l1, l3));
+    }
+
+    SECTION("empty polygons never intersect")
+    {
+        point_2d a[] = { point_at(0, 0), point_at(10, 0), point_at(0, 10) };
+        REQUIRE_FALSE(convex_polygons_intersect(a, 3, a, 0));
+    }
+}
@@ -0,0 +1,165 @@
+/**
+ * Batch Geometry Unit Tests
+ *
+ * Checks each batch geometry function against the single element version.
+ * The counts used are not multiples of the vector widths, so both the
+ * vector kernels and the scalar tails that finish each batch are covered.
+ */
+
+#include <vector>
+#include <cstdint>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "geometry.h"
+#include "matrix_2d.h"
+
+using namespace splashkit_lib;
+
+// Covers empty batches, the tail alone, whole vectors plus a tail, and tails
+// that cross into a second word of the bitmask
+static const int BATCH_COUNTS[] = { 0, 1, 2, 3, 5, 7, 9, 63, 64, 65, 131 };
+
+static bool bit_set(const vector<uint64_t> &mask, int idx)
+{
+    return (mask[idx >> 6] >> (idx & 63)) & 1;
+}
+
+// Points on a whole number grid, so points on the edge of a shape are
+// exactly on the edge, and are spread either side of the shape
+static vector<point_2d> grid_points(int count)
+{
+    vector<point_2d> result;
+
+    for (int i = 0; i < count; i++)
+        result.push_back(point_at((i * 7) % 31 - 5, (i * 13) % 29 - 5));
+
+    return result;
+}
+
+// Rectangles with positive, negative and zero sizes, some touching the
+// test rectangle along an edge or at a corner
+static vector<rectangle> grid_rectangles(int count)
+{
+    vector<rectangle> result;
+
+    for (int i = 0; i < count; i++)
+        result.push_back(rectangle_from((i * 7) % 31 - 5, (i * 13) % 29 - 5, (i * 5) % 13 - 6, (i * 3) % 11 - 5));
+
+    return result;
+}
+
+TEST_CASE("points_in_rectangle matches point_in_rectangle", "[geometry]")
+{
+    rectangle rects[] = { rectangle_from(0, 0, 10, 8), rectangle_from(15, 12, -10, -8) };
+
+    for (const rectangle &rect : rects)
+    {
+        for (int count : BATCH_COUNTS)
+        {
+            vector<point_2d> pts = grid_points(count);
+            vector<uint64_t> result;
+
+            points_in_rectangle(pts, rect, result);
+
+            CAPTURE(count);
+            REQUIRE(result.size() == static_cast<size_t>((count + 63) / 64));
+
+            for (int i = 0; i < count; i++)
+            {
+                CAPTURE(i);
+                CHECK(bit_set(result, i) == point_in_rectangle(pts[i], rect));
+            }
+        }
+    }
+}
+
+TEST_CASE("points_in_circle matches point_in_circle", "[geometry]")
+{
+    circle c = circle_at(10, 10, 5);
+
+    for (int count : BATCH_COUNTS)
+    {
+        vector<point_2d> pts = grid_points(count);
+        vector<uint64_t> result;
+
+        points_in_circle(pts, c, result);
+
+        CAPTURE(count);
+        REQUIRE(result.size() == static_cast<size_t>((count + 63) / 64));
+
+        for (int i = 0; i < count; i++)
+        {
+            CAPTURE(i);
+            CHECK(bit_set(result, i) == point_in_circle(pts[i], c));
+        }
+    }
+}
+
+TEST_CASE("batch rectangles_intersect matches single rectangles_intersect", "[geometry]")
+{
+    rectangle rects[] = { rectangle_from(0, 0, 10, 8), rectangle_from(15, 12, -10, -8) };
+
+    for (const rectangle &rect : rects)
+    {
+        for (int count : BATCH_COUNTS)
+        {
+            vector<rectangle> tests = grid_rectangles(count);
+            vector<uint64_t> result;
+
+            rectangles_intersect(tests, rect, result);
+
+            CAPTURE(count);
+            REQUIRE(result.size() == static_cast<size_t>((count + 63) / 64));
+
+            for (int i = 0; i < count; i++)
+            {
+                CAPTURE(i);
+                CHECK(bit_set(result, i) == rectangles_intersect(tests[i], rect));
+            }
+        }
+    }
+}
+
+TEST_CASE("batch matrix_multiply matches single point matrix_multiply", "[geometry]")
+{
+    matrix_2d m = matrix_multiply(translation_matrix(3.5, -2.25), matrix_multiply(rotation_matrix(37), scale_matrix(1.5)));
+
+    for (int count : BATCH_COUNTS)
+    {
+        vector<point_2d> pts = grid_points(count);
+        vector<point_2d> result;
+
+        matrix_multiply(m, pts, result);
+
+        CAPTURE(count);
+        REQUIRE(result.size() == pts.size());
+
+        for (int i = 0; i < count; i++)
+        {
+            point_2d expected = matrix_multiply(m, pts[i]);
+
+            CAPTURE(i);
+            CHECK(result[i].x == expected.x);
+            CHECK(result[i].y == expected.y);
+        }
+    }
+
+    SECTION("the points can be transformed in place")
+    {
+        vector<point_2d> pts = grid_points(9);
+        vector<point_2d> original = pts;
+
+        matrix_multiply(m, pts, pts);
+
+        for (int i = 0; i < 9; i++)
+        {
+            point_2d expected = matrix_multiply(m, original[i]);
+
+            CAPTURE(i);
+            CHECK(pts[i].x == expected.x);
+            CHECK(pts[i].y == expected.y);
+        }
+    }
+}
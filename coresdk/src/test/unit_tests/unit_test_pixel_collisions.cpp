@@ -0,0 +1,321 @@
+/**
+ * Pixel Collision Unit Tests
+ *
+ * Checks bitmap_collision against a plain per pixel test, which steps over
+ * every pixel of the smaller bitmap and truncates its position in the other.
+ */
+
+#include <cmath>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "collisions.h"
+#include "graphics.h"
+#include "matrix_2d.h"
+#include "quad_geometry.h"
+#include "backend_types.h"
+#include "utility_functions.h"
+
+using namespace splashkit_lib;
+
+// A bitmap with a scattered pattern of pixels, so that nearby placements
+// give different answers
+static bitmap create_pattern_bitmap(const string &name, int width, int height, unsigned int seed)
+{
+    bitmap result = create_bitmap(name, width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            unsigned int hash = (x * 73856093u) ^ (y * 19349663u) ^ (seed * 83492791u);
+            if ( hash % 13 == 0 )
+                draw_pixel(COLOR_BLACK, x, y, option_draw_to(result));
+        }
+    }
+
+    // Build the collision mask from the drawn pixels
+    result->collision_mask_pending = true;
+    ensure_collision_mask(result);
+
+    return result;
+}
+
+// Step over each pixel of the smaller bitmap, finding the pixel it falls on
+// in the other bitmap by truncating its position. As with bitmap_collision,
+// bitmaps whose areas do not intersect never collide.
+static bool reference_collision(bitmap bmp1, const matrix_2d &matrix1, bitmap bmp2, const matrix_2d &matrix2)
+{
+    if ( not quads_intersect(quad_from(bitmap_cell_rectangle(bmp1), matrix1), quad_from(bitmap_cell_rectangle(bmp2), matrix2)) )
+        return false;
+
+    int w1 = bitmap_width(bmp1), h1 = bitmap_height(bmp1);
+    int w2 = bitmap_width(bmp2), h2 = bitmap_height(bmp2);
+
+    if ( w1 * h1 > w2 * h2 ) return reference_collision(bmp2, matrix2, bmp1, matrix1);
+
+    matrix_2d to_bmp2 = matrix_multiply(matrix1, matrix_inverse(matrix2));
+
+    for (int y = 0; y < h1; y++)
+    {
+        for (int x = 0; x < w1; x++)
+        {
+            point_2d pt = matrix_multiply(to_bmp2, point_at(x, y));
+            int x2 = static_cast<int>(trunc(pt.x));
+            int y2 = static_cast<int>(trunc(pt.y));
+
+            if ( x2 < 0 or x2 >= w2 or y2 < 0 or y2 >= h2 ) continue;
+
+            if ( pixel_drawn_at_point(bmp1, x, y) and pixel_drawn_at_point(bmp2, x2, y2) )
+                return true;
+        }
+    }
+
+    return false;
+}
+
+TEST_CASE("translated pixel collisions match the per pixel test", "[collisions]")
+{
+    bitmap small = create_pattern_bitmap("pixel_small", 12, 9, 1);
+    bitmap large = create_pattern_bitmap("pixel_large", 30, 20, 2);
+
+    SECTION("a pixel just before the other bitmap truncates onto its edge")
+    {
+        bitmap dot = create_bitmap("pixel_dot", 4, 4);
+        bitmap edge = create_bitmap("pixel_edge", 8, 8);
+        draw_pixel(COLOR_BLACK, 2, 2, option_draw_to(dot));
+        draw_pixel(COLOR_BLACK, 0, 0, option_draw_to(edge));
+        dot->collision_mask_pending = true;
+        edge->collision_mask_pending = true;
+
+        // The dot's pixel is at -0.5, -0.5 in edge, which truncates to 0, 0
+        REQUIRE(bitmap_collision(dot, -2.5, -2.5, edge, 0, 0));
+        REQUIRE(bitmap_collision(edge, 0, 0, dot, -2.5, -2.5));
+        REQUIRE_FALSE(bitmap_collision(dot, -3, -3, edge, 0, 0));
+
+        free_bitmap(edge);
+        free_bitmap(dot);
+    }
+
+    SECTION("fractional negative offsets")
+    {
+        for (double oy = -9; oy <= 1; oy += 0.25)
+        {
+            for (double ox = -12; ox <= 1; ox += 0.25)
+            {
+                matrix_2d m1 = translation_matrix(ox + 40, oy + 30);
+                matrix_2d m2 = translation_matrix(40, 30);
+
+                bool expected = reference_collision(small, m1, large, m2);
+                REQUIRE(bitmap_collision(small, 0, m1, large, 0, m2) == expected);
+                REQUIRE(bitmap_collision(large, 0, m2, small, 0, m1) == expected);
+            }
+        }
+    }
+
+    free_bitmap(large);
+    free_bitmap(small);
+}
+
+// A bitmap's matrix when drawn at x, y, rotated and scaled about its centre
+static matrix_2d placed_matrix(bitmap bmp, double x, double y, double angle, double scale)
+{
+    double cx = bitmap_width(bmp) / 2.0, cy = bitmap_height(bmp) / 2.0;
+
+    matrix_2d result = translation_matrix(-cx, -cy);
+    result = matrix_multiply(result, scale_matrix(scale));
+    result = matrix_multiply(result, rotation_matrix(angle));
+    return matrix_multiply(result, translation_matrix(x + cx, y + cy));
+}
+
+// Check bitmap_collision against the per pixel test as bmp1 moves around
+// bmp2, in both orders, counting the placements that collide
+static int require_collisions_match_reference(bitmap bmp1, double angle1, double scale1, bitmap bmp2, double angle2, double scale2)
+{
+    int hits = 0;
+    matrix_2d m2 = placed_matrix(bmp2, 0, 0, angle2, scale2);
+    double range_x = bitmap_width(bmp1) * scale1 + bitmap_width(bmp2) * scale2;
+    double range_y = bitmap_height(bmp1) * scale1 + bitmap_height(bmp2) * scale2;
+
+    for (double y = -range_y; y <= range_y; y += 1.7)
+    {
+        for (double x = -range_x; x <= range_x; x += 1.3)
+        {
+            matrix_2d m1 = placed_matrix(bmp1, x, y, angle1, scale1);
+
+            bool expected = reference_collision(bmp1, m1, bmp2, m2);
+            REQUIRE(bitmap_collision(bmp1, 0, m1, bmp2, 0, m2) == expected);
+            REQUIRE(bitmap_collision(bmp2, 0, m2, bmp1, 0, m1) == expected);
+
+            if ( expected ) hits++;
+        }
+    }
+
+    return hits;
+}
+
+TEST_CASE("rotated and scaled pixel collisions match the per pixel test", "[collisions]")
+{
+    bitmap small = create_pattern_bitmap("pixel_small", 12, 9, 3);
+    bitmap other = create_pattern_bitmap("pixel_other", 20, 15, 4);
+
+    SECTION("rotated")
+    {
+        REQUIRE(require_collisions_match_reference(small, 30, 1, other, 0, 1) > 0);
+        REQUIRE(require_collisions_match_reference(small, 135, 1, other, 250, 1) > 0);
+    }
+
+    SECTION("scaled")
+    {
+        REQUIRE(require_collisions_match_reference(small, 0, 2, other, 0, 1) > 0);
+        REQUIRE(require_collisions_match_reference(small, 0, 1, other, 0, 0.5) > 0);
+    }
+
+    SECTION("rotated and scaled")
+    {
+        REQUIRE(require_collisions_match_reference(small, 45, 1.5, other, 10, 0.75) > 0);
+        REQUIRE(require_collisions_match_reference(small, 300, 0.6, other, 200, 2.5) > 0);
+    }
+
+    free_bitmap(other);
+    free_bitmap(small);
+}
+
+// A bitmap with the pattern drawn only in some 8 by 8 blocks, so that the
+// coarse levels of its collision mask have empty blocks to skip
+static bitmap create_clustered_bitmap(const string &name, int width, int height, unsigned int seed)
+{
+    bitmap result = create_bitmap(name, width, height);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            unsigned int block = ((x / 8) * 73856093u) ^ ((y / 8) * 19349663u) ^ (seed * 83492791u);
+            unsigned int hash = (x * 73856093u) ^ (y * 19349663u) ^ (seed * 83492791u);
+
+            if ( block % 3 == 0 and hash % 7 == 0 )
+                draw_pixel(COLOR_BLACK, x, y, option_draw_to(result));
+        }
+    }
+
+    result->collision_mask_pending = true;
+    ensure_collision_mask(result);
+
+    return result;
+}
+
+TEST_CASE("pixel collisions between large cells match the per pixel test", "[collisions]")
+{
+    // Both are larger than COLLISION_BLOCK_THRESHOLD, so the coarse mask
+    // levels are used to skip blocks
+    bitmap wide = create_clustered_bitmap("pixel_wide", 72, 40, 5);
+    bitmap tall = create_clustered_bitmap("pixel_tall", 36, 66, 6);
+
+    SECTION("rotated")
+    {
+        REQUIRE(require_collisions_match_reference(wide, 20, 1, tall, 0, 1) > 0);
+        REQUIRE(require_collisions_match_reference(wide, 160, 1, tall, 275, 1) > 0);
+    }
+
+    SECTION("scaled")
+    {
+        REQUIRE(require_collisions_match_reference(wide, 0, 0.5, tall, 0, 1) > 0);
+        REQUIRE(require_collisions_match_reference(wide, 0, 1, tall, 0, 1.75) > 0);
+    }
+
+    SECTION("rotated and scaled")
+    {
+        REQUIRE(require_collisions_match_reference(wide, 75, 1.25, tall, 340, 0.8) > 0);
+    }
+
+    free_bitmap(tall);
+    free_bitmap(wide);
+}
+
+// A bitmap with a solid rectangle of pixels, set in from its edges by
+// different amounts so that rotating it also moves the rectangle
+static bitmap create_solid_bitmap(const string &name, int width, int height)
+{
+    bitmap result = create_bitmap(name, width, height);
+
+    for (int y = 1; y < height - 3; y++)
+    {
+        for (int x = 2; x < width - 5; x++)
+        {
+            draw_pixel(COLOR_BLACK, x, y, option_draw_to(result));
+        }
+    }
+
+    result->collision_mask_pending = true;
+    ensure_collision_mask(result);
+
+    return result;
+}
+
+// Pre-rotated masks are resampled, so along the edges of the rotated pixels
+// they can differ from the per pixel test by about a pixel. Compare them
+// only where moving bmp1 by two pixels in any direction leaves the per pixel
+// answer unchanged, and check that both answers were seen.
+static void require_rotated_masks_match_reference(bitmap bmp1, double angle1, bitmap bmp2, double angle2)
+{
+    int hits = 0, misses = 0;
+    matrix_2d m2 = placed_matrix(bmp2, 0, 0, angle2, 1);
+    double range = bitmap_width(bmp1) + bitmap_height(bmp1) + bitmap_width(bmp2) + bitmap_height(bmp2);
+
+    for (double y = -range; y <= range; y += 1.9)
+    {
+        for (double x = -range; x <= range; x += 1.9)
+        {
+            bool expected = reference_collision(bmp1, placed_matrix(bmp1, x, y, angle1, 1), bmp2, m2);
+            bool robust = true;
+
+            for (int i = 0; i < 9 and robust; i++)
+            {
+                if ( i == 4 ) continue;
+
+                matrix_2d moved = placed_matrix(bmp1, x + (i % 3 - 1) * 2, y + (i / 3 - 1) * 2, angle1, 1);
+                robust = reference_collision(bmp1, moved, bmp2, m2) == expected;
+            }
+
+            if ( not robust ) continue;
+
+            matrix_2d m1 = placed_matrix(bmp1, x, y, angle1, 1);
+            REQUIRE(bitmap_collision(bmp1, 0, m1, bmp2, 0, m2) == expected);
+            REQUIRE(bitmap_collision(bmp2, 0, m2, bmp1, 0, m1) == expected);
+
+            if ( expected ) hits++; else misses++;
+        }
+    }
+
+    REQUIRE(hits > 0);
+    REQUIRE(misses > 0);
+}
+
+TEST_CASE("pre-rotated collision masks match the exactly rotated test", "[collisions]")
+{
+    bitmap bar = create_solid_bitmap("pixel_bar", 44, 12);
+    bitmap block = create_solid_bitmap("pixel_block", 20, 26);
+
+    // Masks every 10 degrees, with the angles below on those steps
+    bitmap_set_rotated_collision_masks(bar, 36);
+
+    SECTION("rotated against unrotated")
+    {
+        require_rotated_masks_match_reference(bar, 30, block, 0);
+        require_rotated_masks_match_reference(bar, 250, block, 0);
+    }
+
+    SECTION("both rotated")
+    {
+        bitmap_set_rotated_collision_masks(block, 36);
+
+        require_rotated_masks_match_reference(bar, 130, block, 60);
+        require_rotated_masks_match_reference(bar, 0, block, 320);
+    }
+
+    free_bitmap(block);
+    free_bitmap(bar);
+}
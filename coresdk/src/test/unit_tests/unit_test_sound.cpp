@@ -0,0 +1,55 @@
+/**
+ * Sound Unit Tests
+ *
+ * Checks how queued sound effects are combined before they are played.
+ * The queue only compares effects, so these run without an audio device.
+ */
+
+#include <vector>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "sound.h"
+#include "utility_functions.h"
+
+using namespace splashkit_lib;
+
+TEST_CASE("queued sound effects are combined", "[sound]")
+{
+    // Stand ins for two effects, which are never played
+    int first_effect, second_effect;
+    _sound_data *first = reinterpret_cast<_sound_data *>(&first_effect);
+    _sound_data *second = reinterpret_cast<_sound_data *>(&second_effect);
+
+    vector<queued_sound> queue;
+
+    SECTION("each effect is queued once at its loudest volume")
+    {
+        add_queued_sound(queue, first, 0.3f, false);
+        add_queued_sound(queue, second, 0.5f, false);
+        add_queued_sound(queue, first, 0.8f, false);
+        add_queued_sound(queue, first, 0.4f, false);
+
+        REQUIRE(queue.size() == 2);
+        REQUIRE(queue[0].effect == first);
+        REQUIRE(queue[0].volume == Approx(0.8f));
+        REQUIRE(queue[1].effect == second);
+        REQUIRE(queue[1].volume == Approx(0.5f));
+    }
+
+    SECTION("summed volumes are limited to 1")
+    {
+        add_queued_sound(queue, first, 0.25f, true);
+        add_queued_sound(queue, first, 0.25f, true);
+        add_queued_sound(queue, second, 0.5f, true);
+
+        REQUIRE(queue.size() == 2);
+        REQUIRE(queue[0].volume == Approx(0.5f));
+
+        add_queued_sound(queue, first, 0.75f, true);
+        REQUIRE(queue.size() == 2);
+        REQUIRE(queue[0].volume == Approx(1.0f));
+        REQUIRE(queue[1].volume == Approx(0.5f));
+    }
+}
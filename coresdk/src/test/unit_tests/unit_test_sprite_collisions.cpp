@@ -0,0 +1,105 @@
+/**
+ * Sprite Collision Unit Tests
+ *
+ * Checks that the batch sprite_collisions finds exactly the pairs that
+ * sprite_collision finds when each pair is tested on its own.
+ */
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "sprites.h"
+#include "collisions.h"
+
+using namespace splashkit_lib;
+
+// The pairs as sorted index pairs, so lists can be compared
+static vector<pair<int, int>> sorted_pairs(const vector<sprite_collision_pair> &pairs)
+{
+    vector<pair<int, int>> result;
+
+    for (const sprite_collision_pair &p : pairs)
+        result.push_back(make_pair(p.first, p.second));
+
+    sort(result.begin(), result.end());
+    return result;
+}
+
+// A crowd of overlapping sprites using each kind of collision, some rotated
+// and scaled. There are enough that the batch test uses several threads.
+static vector<sprite> create_crowd(bitmap bmp, int count, float start_x)
+{
+    vector<sprite> result;
+    collision_test_kind kinds[] = { PIXEL_COLLISIONS, AABB_COLLISIONS, POLYGON_COLLISIONS };
+
+    for (int i = 0; i < count; i++)
+    {
+        sprite s = create_sprite(bmp);
+        sprite_set_x(s, start_x + (i % 20) * bitmap_width(bmp) * 0.6f);
+        sprite_set_y(s, (i / 20) * bitmap_height(bmp) * 0.6f);
+        sprite_set_collision_kind(s, kinds[i % 3]);
+
+        if ( i % 4 == 1 ) sprite_set_rotation(s, i * 17 % 360);
+        if ( i % 5 == 2 ) sprite_set_scale(s, 1.5);
+
+        result.push_back(s);
+    }
+
+    return result;
+}
+
+static vector<sprite_collision_pair> pairwise_collisions(const vector<sprite> &first, const vector<sprite> &second, bool same_list)
+{
+    vector<sprite_collision_pair> result;
+
+    for (int i = 0; i < static_cast<int>(first.size()); i++)
+    {
+        for (int j = same_list ? i + 1 : 0; j < static_cast<int>(second.size()); j++)
+        {
+            if ( sprite_collision(first[i], second[j]) )
+                result.push_back({ i, j });
+        }
+    }
+
+    return result;
+}
+
+TEST_CASE("batch sprite collisions match pairwise collisions", "[collisions]")
+{
+    bitmap bmp = load_bitmap("rocket", "rocket_sprt.png");
+    REQUIRE(bmp != nullptr);
+
+    SECTION("within one list")
+    {
+        vector<sprite> sprites = create_crowd(bmp, 300, 0);
+
+        vector<sprite_collision_pair> batch = sprite_collisions(sprites, sprites);
+        vector<sprite_collision_pair> expected = pairwise_collisions(sprites, sprites, true);
+
+        REQUIRE(expected.size() > 0);
+        REQUIRE(sorted_pairs(batch) == sorted_pairs(expected));
+
+        free_all_sprites();
+    }
+
+    SECTION("between two lists")
+    {
+        vector<sprite> first = create_crowd(bmp, 200, 0);
+        vector<sprite> second = create_crowd(bmp, 200, bitmap_width(bmp) * 0.3f);
+
+        vector<sprite_collision_pair> batch = sprite_collisions(first, second);
+        vector<sprite_collision_pair> expected = pairwise_collisions(first, second, false);
+
+        REQUIRE(expected.size() > 0);
+        REQUIRE(sorted_pairs(batch) == sorted_pairs(expected));
+
+        free_all_sprites();
+    }
+
+    free_bitmap(bmp);
+}
@@ -0,0 +1,233 @@
+/**
+ * Sprite Unit Tests
+ *
+ * Checks the drawing details sprites cache between draws.
+ */
+
+#include <vector>
+
+#include "catch.hpp"
+
+#include "types.h"
+#include "images.h"
+#include "sprites.h"
+#include "animations.h"
+#include "utility_functions.h"
+
+using namespace splashkit_lib;
+
+// The cached drawing details, which must have changed since before and must
+// match the details from a fresh rebuild
+static void require_draw_details_rebuilt(sprite s, const vector<float> &before)
+{
+    vector<float> cached = sprite_draw_details(s, false);
+    vector<float> rebuilt = sprite_draw_details(s, true);
+
+    REQUIRE(cached != before);
+    REQUIRE(cached == rebuilt);
+}
+
+TEST_CASE("sprite draw details are rebuilt when the sprite changes", "[sprites]")
+{
+    bitmap bmp = create_bitmap("draw_details", 60, 30);
+    bitmap top = create_bitmap("draw_details_top", 10, 10);
+    sprite s = create_sprite(bmp);
+    sprite_add_layer(s, top, "top");
+
+    vector<float> before = sprite_draw_details(s, false);
+    REQUIRE(before.size() == 11);
+
+    SECTION("rotation")
+    {
+        sprite_set_rotation(s, 45);
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("scale")
+    {
+        sprite_set_scale(s, 2);
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("bitmap cell details")
+    {
+        // The rotation centre depends on the cell size
+        sprite_set_rotation(s, 45);
+        before = sprite_draw_details(s, false);
+
+        bitmap_set_cell_details(bmp, 20, 15, 3, 2, 6);
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("layer visibility")
+    {
+        sprite_show_layer(s, "top");
+        require_draw_details_rebuilt(s, before);
+        REQUIRE(sprite_draw_details(s, false).size() == 22);
+
+        before = sprite_draw_details(s, false);
+        sprite_hide_layer(s, "top");
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("layer offset")
+    {
+        sprite_set_layer_offset(s, 0, vector_to(3, 4));
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("anchor point")
+    {
+        sprite_set_rotation(s, 30);
+        before = sprite_draw_details(s, false);
+
+        sprite_set_anchor_point(s, point_at(5, 5));
+        require_draw_details_rebuilt(s, before);
+    }
+
+    SECTION("animation cell")
+    {
+        animation_script script = load_animation_script("catch_up", "catch_up.txt");
+        REQUIRE(script != nullptr);
+
+        bitmap_set_cell_details(bmp, 20, 15, 3, 2, 6);
+        sprite animated = create_sprite(bmp, script);
+        sprite_start_animation(animated, "intro");
+
+        before = sprite_draw_details(animated, false);
+
+        // The intro's first frame lasts for 2 updates
+        update_sprite_animation(animated);
+        update_sprite_animation(animated);
+        require_draw_details_rebuilt(animated, before);
+
+        free_sprite(animated);
+        free_animation_script(script);
+    }
+
+    free_sprite(s);
+    free_bitmap(top);
+    free_bitmap(bmp);
+}
+
+// Where the sprite's anchor point is in the world
+static point_2d world_anchor(sprite s)
+{
+    return matrix_multiply(sprite_location_matrix(s), sprite_anchor_point(s));
+}
+
+// Where an attached sprite's anchor point should be, given its parent
+static point_2d expected_anchor(sprite child)
+{
+    sprite parent = sprite_parent(child);
+    return matrix_multiply(sprite_location_matrix(parent), point_offset_by(sprite_anchor_point(child), sprite_local_offset(child)));
+}
+
+static void require_same_point(const point_2d &actual, const point_2d &expected)
+{
+    REQUIRE(actual.x == Approx(expected.x).margin(0.01));
+    REQUIRE(actual.y == Approx(expected.y).margin(0.01));
+}
+
+TEST_CASE("sprites can be attached to other sprites", "[sprites]")
+{
+    bitmap body_bmp = create_bitmap("hierarchy_body", 40, 20);
+    bitmap arm_bmp = create_bitmap("hierarchy_arm", 16, 6);
+
+    sprite body = create_sprite(body_bmp);
+    sprite arm = create_sprite(arm_bmp);
+    sprite hand = create_sprite(arm_bmp);
+
+    sprite_set_position(body, point_at(100, 50));
+    sprite_set_position(arm, point_at(130, 60));
+    sprite_set_position(hand, point_at(150, 60));
+
+    SECTION("attaching and detaching keeps the sprite where it is")
+    {
+        point_2d start = world_anchor(arm);
+
+        sprite_set_parent(arm, body);
+        REQUIRE(sprite_parent(arm) == body);
+
+        update_all_sprites();
+        require_same_point(world_anchor(arm), start);
+
+        // Attached sprites follow their parent
+        sprite_set_x(body, 200);
+        update_all_sprites();
+        require_same_point(world_anchor(arm), point_offset_by(start, vector_to(100, 0)));
+
+        point_2d moved = world_anchor(arm);
+        sprite_set_parent(arm, nullptr);
+        REQUIRE(sprite_parent(arm) == nullptr);
+
+        // Once detached, moving the old parent leaves the sprite alone
+        sprite_set_x(body, 300);
+        update_all_sprites();
+        require_same_point(world_anchor(arm), moved);
+    }
+
+    SECTION("children follow a rotated and scaled parent")
+    {
+        sprite_set_parent(arm, body);
+        sprite_set_local_offset(arm, vector_to(25, 4));
+        sprite_set_local_rotation(arm, 15);
+        sprite_set_local_scale(arm, 0.5);
+
+        sprite_set_rotation(body, 30);
+        sprite_set_scale(body, 2);
+        update_all_sprites();
+
+        require_same_point(world_anchor(arm), expected_anchor(arm));
+        REQUIRE(sprite_rotation(arm) == Approx(45));
+        REQUIRE(sprite_scale(arm) == Approx(1));
+
+        // Stays correct as the parent keeps turning
+        sprite_set_rotation(body, 350);
+        update_all_sprites();
+
+        require_same_point(world_anchor(arm), expected_anchor(arm));
+        REQUIRE(sprite_rotation(arm) == Approx(5));
+    }
+
+    SECTION("grandchildren are placed after their parents")
+    {
+        sprite_set_parent(arm, body);
+        sprite_set_parent(hand, arm);
+        sprite_set_local_offset(arm, vector_to(25, 4));
+        sprite_set_local_offset(hand, vector_to(12, 0));
+        sprite_set_local_rotation(hand, 90);
+
+        // A single update places the whole hierarchy
+        sprite_set_rotation(body, 60);
+        sprite_set_position(body, point_at(10, 300));
+        update_all_sprites();
+
+        require_same_point(world_anchor(arm), expected_anchor(arm));
+        require_same_point(world_anchor(hand), expected_anchor(hand));
+        REQUIRE(sprite_rotation(hand) == Approx(150));
+    }
+
+    SECTION("loops are rejected")
+    {
+        sprite_set_parent(arm, body);
+        sprite_set_parent(hand, arm);
+
+        sprite_set_parent(body, hand);
+        REQUIRE(sprite_parent(body) == nullptr);
+
+        sprite_set_parent(arm, arm);
+        REQUIRE(sprite_parent(arm) == body);
+
+        // The hierarchy still works
+        sprite_set_x(body, 0);
+        update_all_sprites();
+        require_same_point(world_anchor(hand), expected_anchor(hand));
+    }
+
+    free_sprite(hand);
+    free_sprite(arm);
+    free_sprite(body);
+    free_bitmap(arm_bmp);
+    free_bitmap(body_bmp);
+}